@@ -1,5 +1,23 @@
 #include "basics.h"
 
+/**********************************************************************************
+*    Constants                                                                   *
+*          defined in "basics.h"
+**********************************************************************************/
+
+const int MAX_LOOPS = 2000; //max. number of loops
+
+const double T                    = 310.15  ; // temperature in Kelvin(37C);K=C+273.15
+const double RT                   = 0.616   ; // Boltzmann gas constant in kcal/mol
+// RT=kT=1.380622*10^(-23)Joule/K *310.15K (37C=273.15K+37K=310.15K)
+
+const double MIN_DOUBLE = -1000000.0;
+const double MAX_DOUBLE =  1000000.0;
+const double DOUBLE_DIFF = 0.00001;
+
+const int MIN_INT = -1000000;
+const int MAX_INT = 1000000;
+
 /**********************************************************
  translates an integerBase to a characterBase (nucleotide)
 **********************************************************/
@@ -64,11 +82,18 @@ int char2int_base(char base)
 int* char2int(char* seq)
 {
    int* num_seq = (int*) malloc(sizeof(int)*strlen(seq));
-   for (int i=0; i<(int)strlen(seq); i++)
-      num_seq[i] = char2int_base(seq[i]);
+   char2int(seq, num_seq);
    return num_seq;
 }
 
+/* the same into the given array */
+void char2int(char* seq, int* num_seq)
+{
+   int len = (int)strlen(seq);
+   for (int i=0; i<len; i++)
+      num_seq[i] = char2int_base(seq[i]);
+}
+
 
 /**********************************************************
  translates the two bases (integer) of a BP to an integer
@@ -189,13 +214,12 @@ int SumVec(int* vec, int size)
 }
 
 /************************************************************
- finds the minimal value in a vector (returns the value and
- its coordinate)
+ finds the minimal value in a vector (min[1] = the value,
+ min[0] = its coordinate)
 ************************************************************/
 
-double* MiniVec(double* vec, int size)
+void MiniVec(double* vec, int size, double* min)
 {
-   double* min = (double*) malloc(sizeof(double)*2);
    min[0] = MAX_DOUBLE; //coord.
    min[1] = MAX_DOUBLE; //value
    for ( int i=0; i<size; i++)
@@ -204,17 +228,31 @@ double* MiniVec(double* vec, int size)
          min[1] = vec[i];
          min[0] = i;
       }
-   return min;
 }
 
 /************************************************************
- finds the maximal value in a vector (returns the value and
- its coordinate)
+ the same for a vector of energies
+************************************************************/
+
+void MiniVec(int* vec, int size, int* min)
+{
+   min[0] = MAX_ENERGY; //coord.
+   min[1] = MAX_ENERGY; //value
+   for ( int i=0; i<size; i++)
+      if (vec[i] < min[1])
+      {
+         min[1] = vec[i];
+         min[0] = i;
+      }
+}
+
+/************************************************************
+ finds the maximal value in a vector (max[1] = the value,
+ max[0] = its coordinate)
 ************************************************************/
 
-double* MaxiVec(double* vec, int size)
+void MaxiVec(double* vec, int size, double* max)
 {
-   double* max = (double*) malloc(sizeof(double)*2);
    max[0] = MIN_INT; //coord.
    max[1] = MIN_INT; //value
    for (int i=0; i<size; i++)
@@ -223,20 +261,18 @@ double* MaxiVec(double* vec, int size)
          max[1] = vec[i];
          max[0] = i;
       }
-   return max;
 }
 
 
 /*************************************************************
  gives a random base (depending on the size of the set of 
- valid bases)
+ valid bases), drawn from the generator rng of the design
 *************************************************************/
 
-int RandomBase(int number)
+int RandomBase(unsigned short* rng, int number)
 {
    double zufall;
-   zufall = rand();
-   zufall /= RAND_MAX;
+   zufall = erand48(rng);
 
    if (number == 4)
    {
@@ -273,11 +309,10 @@ int RandomBase(int number)
 /*************************************************************
  finds a random base pair
 *************************************************************/
-int RandomBasePair()
+int RandomBasePair(unsigned short* rng)
 {
    double zufall;
-   zufall = rand();
-   zufall /= RAND_MAX;
+   zufall = erand48(rng);
 
    if (zufall <= 0.1667)
       return 0;
@@ -298,11 +333,10 @@ int RandomBasePair()
  finds a random base pair depending on constraints
 *************************************************************/
 
-int RandomBasePair(int number)
+int RandomBasePair(unsigned short* rng, int number)
 {
    double zufall;
-   zufall = rand();
-   zufall /= RAND_MAX;
+   zufall = erand48(rng);
    cout << "zufall: " << zufall << endl;
 
    if (number == 6)
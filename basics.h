@@ -16,6 +16,9 @@
 #include <string>
 #include <math.h>
 #include <cstdio>
+#include "context.h"
+#include "loop_index.h"
+#include "fold_engine.h"
 #include "energy.h"
 #include "hairpin_energy.h"
 #include "interior_energy.h"
@@ -30,6 +33,7 @@ extern "C"{
              #include <fold_vars.h>
              #include <utils.h>
              #include <inverse.h>
+             #include <read_epars.h>
           }
 
 using namespace std;
@@ -62,44 +66,6 @@ extern const double DOUBLE_DIFF;
 extern const int MIN_INT;
 extern const int MAX_INT;
 
-/**********************************************************************************
-*                         global variabels (extern)                              *
-**********************************************************************************/
-extern int step;  //is 1 if we are in the initialization step, 2 during the local search (the variable is necessary since constraint mismatches
-                  //are allowed only during the second step, but the functions with allow them (PairPenaly, BasePenalty) are used during the
-                  //initialization as well
-
-extern char* brackets;
-extern int struct_len;
-extern char *ElementStruct; 
-extern int** BP_Order;
-extern int numBP;
-extern int* BP_Pos_Nr;
-extern double** D;    // Dynamic Recursion Matrix
-extern int**** Trace; // Dynamic Traceback Matrix (has 2 dimensions more than D, since in each D-corresponding field the coordinates of all
-                      // predecessor fields have to be stored (two coord. per predecessor) and since there could be more than one predecessors
-                      // 2 more dimensions are needed)
-extern char* iupac_const;
-extern int** seq_constraints;
-extern int max_mis; //max. number of mismatches that are allowed among the constrained position or in an interval
-extern int num_mis; //counter for occuring mismatches
-extern int* mis_vec; //vector where for each position is stored whether a mismatch is allowed or not
-
-extern char* best_char_seq; // designed sequence
-
-extern bool free_bases_set2A; // is true, if free bases have to be set to 'A'
-extern bool free_bases_set2C;
-extern bool free_bases_set2G;
-extern bool free_bases_set2U;
-extern bool random_init;
-
-extern int search_strategy;       // gives the search strategy ( 1 = adaptive walk, 2 = full local search, 3 = stochastic local search)
-extern int neighbour_choice;      // gives the kind of ranking of the neighbors (1 = random, 2 = energy dependent)
-extern int only_mutation_is_step; // gives the information how to count the step done during the stochastic local search
-extern int step_multiplier;       // maximal number of steps during SLS = allowed_steps * length
-extern double p_accept;           // probability to accept worse neighbors during SLS
-
-
 /**********************************************************************************
 *                         Funktionen                                              *
 **********************************************************************************/
@@ -108,6 +74,7 @@ char int2char(int base);
 char* int2char(int* num_seq, int size);
 int char2int_base(char base);
 int* char2int(char* seq);
+void char2int(char* seq, int* num_seq);
 int BP2int(int b1, int b2);
 void BP2_2(int bp, int &base_i, int &base_j);
 
@@ -116,13 +83,14 @@ int Minimum(int a, int b);
 double Minimum(double a, double b);
 int Maximum(int a, int b);
 
-double* MiniVec(double* vec, int size);
-double* MaxiVec(double* vec, int size);
+void MiniVec(double* vec, int size, double* min);
+void MiniVec(int* vec, int size, int* min);
+void MaxiVec(double* vec, int size, double* max);
 int SumVec(int* vec, int size);
 
-int RandomBase(int number);
-int RandomBasePair();
-int RandomBasePair(int number);
+int RandomBase(unsigned short* rng, int number);
+int RandomBasePair(unsigned short* rng);
+int RandomBasePair(unsigned short* rng, int number);
 
 int Valid_IUPAC(char iu);
 int Compare_IUPAC_Base(char iu, int base);
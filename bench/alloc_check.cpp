@@ -0,0 +1,127 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../inforna.h"
+#include "../search.h"
+#include "bench.h"
+
+/*********************************************************
+ the local search has to run without heap allocations
+ once a design is set up: malloc, calloc and realloc of
+ the program (and so of operator new) are replaced by
+ counting versions. Each design does a first repeat,
+ then the heap calls of further runs of the local search
+ (inverse_fold from the initial sequence) are counted,
+ with the native fold (-e 2) and the strategies -S 1/2/3,
+ the energy dependent neighbors (-N 2), the parallel
+ search (-P) and the energy filter (-D).
+
+ Returns 1 if a heap call was counted.
+
+ usage: alloc_check [repeats]
+*********************************************************/
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+
+static volatile int counting = 0;
+static long heap_calls = 0;
+
+extern "C" void* malloc(size_t size)
+{
+   if (counting)
+      __sync_fetch_and_add(&heap_calls, 1);
+   return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t n, size_t size)
+{
+   if (counting)
+      __sync_fetch_and_add(&heap_calls, 1);
+   return __libc_calloc(n, size);
+}
+
+extern "C" void* realloc(void* p, size_t size)
+{
+   if (counting)
+      __sync_fetch_and_add(&heap_calls, 1);
+   return __libc_realloc(p, size);
+}
+
+static const char* targets[] = {
+   "((((((...((((....))))...((((....))))..))))))",
+   "(((((..((((((...)))))).....(((((....)))))..((((...))))...)))))....((((((....))))))"
+};
+
+struct Setting
+{
+   const char* name;
+   int strategy, neighbours, threads;
+   double energy_filter;
+};
+
+static const Setting settings[] = {
+   {"-S 1", 1, 1, 1, -1},
+   {"-S 2", 2, 1, 1, -1},
+   {"-S 3", 3, 1, 1, -1},
+   {"-N 2", 1, 2, 1, -1},
+   {"-P 2", 1, 1, 2, -1},
+   {"-D 1", 1, 1, 1, 1.0}
+};
+
+int main(int argc, char** argv)
+{
+   int repeats = 3, errors = 0;
+   long calls;
+   char* string;
+   InfoRNAOptions opt;
+   InfoRNADesign* design;
+
+   if (argc > 1)
+      repeats = atoi(argv[1]);
+
+   printf("%-8s %6s %11s\n", "setting", "target", "heap calls");
+   for (int s=0; s<NUM_ENTRIES(settings); s++)
+      for (int t=0; t<NUM_ENTRIES(targets); t++)
+      {
+         inforna_default_options(&opt);
+         opt.fold_engine = opt.eval_engine = 2;
+         opt.search_strategy = settings[s].strategy;
+         opt.neighbour_choice = settings[s].neighbours;
+         opt.num_threads = settings[s].threads;
+         opt.energy_filter = settings[s].energy_filter;
+         opt.repeat = 1;
+         opt.seed = 1;
+
+         design = inforna_prepare(targets[t], NULL, NULL, &opt);
+         if (design == NULL)
+         {
+            fprintf(stderr, "rejected target: %s\n", targets[t]);
+            return 1;
+         }
+         inforna_repeat(design);   // sets up the work space of the local search
+         string = (char*) malloc(strlen(targets[t])+1);
+
+         heap_calls = 0;
+         for (int r=0; r<repeats; r++)
+         {
+            strcpy(string, design->ctx->best_char_seq);
+            counting = 1;
+            inverse_fold(design->ctx, string);
+            counting = 0;
+            design->ctx->num_mis = 0;
+         }
+         calls = heap_calls;
+
+         printf("%-8s %6d %11ld\n", settings[s].name, t+1, calls);
+         if (calls > 0)
+            errors++;
+         free(string);
+         inforna_free_design(design);
+      }
+
+   inforna_cleanup();
+   return (errors > 0);
+}
@@ -0,0 +1,30 @@
+#ifndef _BENCH__
+#define _BENCH__
+
+#include <stdlib.h>
+#include <time.h>
+
+/**********************************************************************************
+*  Helpers shared by the programs in bench/: the timer (monotonic clock, in s),   *
+*  the number of entries of a fixed array (targets, lengths, settings) and a      *
+*  random sequence of uniform bases drawn from the generator rng (erand48).       *
+**********************************************************************************/
+
+#define NUM_ENTRIES(array) ((int)(sizeof(array)/sizeof((array)[0])))
+
+static inline double Now()
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static inline void Random_Sequence(unsigned short* rng, char* seq, int len)
+{
+   for (int i=0; i<len; i++)
+      seq[i] = "ACGU"[(int)(erand48(rng)*4)];
+   seq[len] = '\0';
+}
+
+#endif   // _BENCH_
@@ -0,0 +1,83 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../inforna.h"
+#include "bench.h"
+
+/*********************************************************
+ comparison of the folding backends: the same designs
+ (targets x seeds, one mfe run of the local search each)
+ with each backend that is compiled in (with the
+ given threads if the backend is thread-safe, else 1)
+
+ folds/s   = folded candidates of the local search per s
+ designs/s = complete designs (initializing step, local
+             search, folding of the result) per s
+ solved    = designs whose mfe structure is the target
+
+ usage: fold_bench [seeds per target] [threads]
+*********************************************************/
+
+static const char* targets[] = {
+   "((((((...((((....))))...((((....))))..))))))",
+   "(((((..((((((...)))))).....(((((....)))))..((((...))))...)))))....((((((....))))))",
+   "..((((((((....))))..((((((.....))))))...(((((...((((....))))..)))))..((((....))))..))))....",
+   "((((((((....((((((.......))))))...((((((.....))))))....((((((.....))))))..))))))))",
+   ".((((((.((((....)))).((((.........)))).....(((((.......))))).))))))....(((((((....((((.....)))).....)))))))...",
+   "((((.((((......)))).((((......)))).))))...((((.(((((....))))).((((.....)))).((((......)))).)))).((((((....))))))"
+};
+
+int main(int argc, char** argv)
+{
+   int num_targets = NUM_ENTRIES(targets);
+   int seeds = 5, threads = 1, designs, solved;
+   long folds;
+   double start, sec;
+   InfoRNAOptions opt;
+   InfoRNAResult* res;
+
+   if (argc > 1)
+      seeds = atoi(argv[1]);
+   if (argc > 2)
+      threads = atoi(argv[2]);
+
+   printf("%-10s %7s %8s %8s %10s %9s %12s %10s\n", "backend", "threads", "designs", "solved", "folds", "time [s]", "folds/s", "designs/s");
+   for (int engine=1; engine<=inforna_num_fold_engines(); engine++)
+   {
+      if (inforna_fold_engine_name(engine) == NULL)
+         continue;
+
+      inforna_default_options(&opt);
+      opt.fold_engine = engine;
+      opt.num_threads = inforna_fold_engine_thread_safe(engine)? threads : 1;
+      designs = solved = 0;
+      folds = 0;
+      start = Now();
+      for (int t=0; t<num_targets; t++)
+         for (int s=1; s<=seeds; s++)
+         {
+            opt.seed = s;
+            res = inforna_design(targets[t], NULL, NULL, &opt);
+            if (res == NULL)
+            {
+               fprintf(stderr, "rejected target: %s\n", targets[t]);
+               return 1;
+            }
+            designs++;
+            for (int i=0; i<res->num_solutions; i++)
+            {
+               folds += res->solutions[i].evaluations;
+               if (strcmp(res->solutions[i].mfe_structure, targets[t]) == 0)
+                  solved++;
+            }
+            inforna_free_result(res);
+         }
+      sec = Now() - start;
+      printf("%-10s %7d %8d %7.1f%% %10ld %9.2f %12.0f %10.1f\n", inforna_fold_engine_name(engine), opt.num_threads, designs, 100.0*solved/designs,
+             folds, sec, folds/sec, designs/sec);
+   }
+
+   inforna_cleanup();
+   return 0;
+}
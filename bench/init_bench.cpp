@@ -0,0 +1,77 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../inforna.h"
+#include "bench.h"
+
+/*********************************************************
+ benchmark of the initializing step (inforna_prepare) on
+ targets with many stems in one loop:
+
+ external  = k hairpins in the external loop, separated
+             by single bases (one connection of k stems)
+ multiloop = a multiloop with k hairpins, separated by
+             single bases
+ interior  = k hairpins with a 2x2 interior loop in the
+             external loop (the small loops repeat)
+
+ usage: init_bench [max. number of stems]
+*********************************************************/
+
+#define HAIRPIN "((((....))))"
+#define INTERIOR_HAIRPIN "(((..((((.....))))..)))"
+
+static char* Target(int kind, int stems)
+{
+   const char* hairpin = (kind == 2)? INTERIOR_HAIRPIN : HAIRPIN;
+   char* s = (char*) malloc(strlen(hairpin)*stems + 2*stems + 16);
+
+   strcpy(s, kind == 1 ? "(((((" : ".");
+   for (int i=0; i<stems; i++)
+   {
+      if (i > 0 || kind == 1)
+         strcat(s, ".");
+      strcat(s, hairpin);
+   }
+   strcat(s, kind == 1 ? ".)))))" : ".");
+   return s;
+}
+
+int main(int argc, char** argv)
+{
+   const char* kind_name[3] = {"external", "multiloop", "interior"};
+   int stem_nums[] = {5, 10, 20, 30, 40, 60, 80};
+   int max_stems = 80;
+   InfoRNAOptions opt;
+   InfoRNADesign* design;
+   double start, ms;
+   char* target;
+
+   if (argc > 1)
+      max_stems = atoi(argv[1]);
+
+   inforna_default_options(&opt);
+   opt.seed = 1;
+
+   printf("%-10s %6s %7s %10s %12s\n", "loop", "stems", "length", "init [ms]", "energy");
+   for (int kind=0; kind<3; kind++)
+      for (int n=0; n<NUM_ENTRIES(stem_nums) && stem_nums[n]<=max_stems; n++)
+      {
+         target = Target(kind, stem_nums[n]);
+         start = Now();
+         design = inforna_prepare(target, NULL, NULL, &opt);
+         ms = (Now() - start)*1000;
+         if (design == NULL)
+         {
+            fprintf(stderr, "rejected target: %s\n", target);
+            return 1;
+         }
+         printf("%-10s %6d %7d %10.1f %12.2f\n", kind_name[kind], stem_nums[n], (int)strlen(target), ms, design->result.initial_energy);
+         inforna_free_design(design);
+         free(target);
+      }
+
+   inforna_cleanup();
+   return 0;
+}
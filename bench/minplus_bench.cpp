@@ -0,0 +1,122 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../native_fold.h"
+#include "../min_plus.h"
+#include "bench.h"
+
+/*********************************************************
+ min-plus kernels (min_plus.h) of each level the CPU
+ supports against the scalar loop:
+
+ kernel  = ns per call on two ranges of 8 to 2048 ints,
+           the results have to be the ones of the scalar
+           loop
+ scoring = candidate scoring as in the local search: point
+           mutations of a random sequence evaluated by the
+           native fold (native_fold_eval), the energies
+           have to be the same for all kernels
+
+ usage: minplus_bench [length] [candidates]
+*********************************************************/
+
+int main(int argc, char** argv)
+{
+   int sizes[] = {8, 32, 128, 512, 2048};
+   int n = 300, candidates = 200, calls, sum, ref_sum = 0, errors = 0, level, i, k;
+   long e_sum, ref_e_sum = 0;
+   unsigned short rng[3] = {0x330E, 11, 0};
+   double start, ns[MINPLUS_KERNELS], ms, ref_ms = 0;
+   int *a, *b;
+   char *seq, *cand;
+   NativeFold* nf;
+
+   if (argc > 1)
+      n = atoi(argv[1]);
+   if (argc > 2)
+      candidates = atoi(argv[2]);
+
+   a = (int*) malloc(sizeof(int)*2048);
+   b = (int*) malloc(sizeof(int)*2049);
+   for (i=0; i<2048; i++)
+   {
+      a[i] = (int)(erand48(rng)*20000) - 10000;
+      b[i] = (int)(erand48(rng)*20000) - 10000;
+   }
+
+   printf("%7s", "ints");
+   for (level=0; level<MINPLUS_KERNELS; level++)
+      if (MinPlus_Supported(level))
+         printf(" %9s [ns]", MinPlus_Name(level));
+   printf(" %9s\n", "speedup");
+   for (int s=0; s<NUM_ENTRIES(sizes); s++)
+   {
+      calls = 5000000/sizes[s];
+      for (level=0; level<MINPLUS_KERNELS; level++)
+      {
+         if (Select_MinPlus(level) < 0)
+            continue;
+         sum = 0;
+         start = Now();
+         for (k=0; k<calls; k++)
+            sum += Min_Plus(a, b+(k&1), sizes[s], k);   // unaligned every other call
+         ns[level] = (Now() - start)*1e9/calls;
+         if (level == MINPLUS_SCALAR)
+            ref_sum = sum;
+         else if (sum != ref_sum)
+         {
+            errors++;
+            printf("kernel %s differs on %d ints\n", MinPlus_Name(level), sizes[s]);
+         }
+      }
+      printf("%7d", sizes[s]);
+      for (level=0; level<MINPLUS_KERNELS; level++)
+         if (MinPlus_Supported(level))
+            printf(" %14.1f", ns[level]);
+      printf(" %8.2fx\n", ns[MINPLUS_SCALAR]/ns[Select_MinPlus(-1)]);
+   }
+
+   seq = (char*) malloc(n+1);
+   cand = (char*) malloc(n+1);
+   Random_Sequence(rng, seq, n);
+   nf = native_fold_alloc(n, 1);
+
+   printf("\n%-9s %8s %12s %12s %9s\n", "kernel", "length", "candidates", "eval [ms]", "speedup");
+   for (level=0; level<MINPLUS_KERNELS; level++)
+   {
+      if (Select_MinPlus(level) < 0)
+         continue;
+      native_fold_init(nf, seq, NULL, 'F');
+      rng[0] = 0x330E; rng[1] = 13; rng[2] = 0;   // same candidates for each kernel
+      e_sum = 0;
+      start = Now();
+      for (k=0; k<candidates; k++)
+      {
+         strcpy(cand, seq);
+         i = (int)(erand48(rng)*n);
+         cand[i] = "ACGU"[(strchr("ACGU", cand[i]) - "ACGU" + 1 + (int)(erand48(rng)*3)) % 4];
+         e_sum += native_fold_eval(nf, cand, NULL, 'F');
+      }
+      ms = (Now() - start)*1000/candidates;
+      if (level == MINPLUS_SCALAR)
+      {
+         ref_ms = ms;
+         ref_e_sum = e_sum;
+      }
+      else if (e_sum != ref_e_sum)
+      {
+         errors++;
+         printf("energies of kernel %s differ\n", MinPlus_Name(level));
+      }
+      printf("%-9s %8d %12d %12.3f %8.2fx\n", MinPlus_Name(level), n, candidates, ms, ref_ms/ms);
+   }
+
+   Select_MinPlus(-1);
+   native_fold_free(nf);
+   free(seq);
+   free(cand);
+   free(a);
+   free(b);
+   return (errors > 0);
+}
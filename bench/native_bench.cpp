@@ -0,0 +1,106 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../basics.h"
+#include "bench.h"
+
+/*********************************************************
+ regression of the native fold against Vienna's fold on a
+ corpus of random sequences (fixed seed, 20 to 400 bases,
+ uniform and GC-rich): both backends fold each sequence
+ and evaluate the mfe structure of the other one. Vienna
+ runs with -d2 (dangles = 2) as the native fold does.
+ Each sequence gets a line with both mfe, whether the mfe
+ structures are the same and their BP distance.
+
+ energy    = mfe differ by more than 0.01 kcal/mol
+ eval      = energy_of_struct of the other mfe structure
+             differs from the own mfe (degenerate mfe
+             structures are allowed, their energies not)
+ structure = different mfe structures (only counted)
+
+ Returns 1 if an energy or an evaluation differs. It has
+ to pass with the Vienna 1.x build the program is linked
+ with before the native fold is used for the evaluation
+ (-a 2) of the designs.
+
+ usage: native_bench [sequences per length]
+*********************************************************/
+
+static void Random_GC_Sequence(unsigned short* rng, char* seq, int len, double gc)
+{
+   for (int i=0; i<len; i++)
+   {
+      double r = erand48(rng);
+      if (r < gc)
+         seq[i] = (r < gc/2)? 'G' : 'C';
+      else
+         seq[i] = (r < gc+(1-gc)/2)? 'A' : 'U';
+   }
+   seq[len] = '\0';
+}
+
+int main(int argc, char** argv)
+{
+   int lengths[] = {20, 40, 60, 100, 150, 200, 300, 400};
+   int per_length = 10, max_len = 400, n = 0, energy_diff = 0, eval_diff = 0, struct_diff = 0, dist, max_dist = 0;
+   int bad_energy, bad_eval;
+   unsigned short rng[3] = {0x330E, 1, 0};
+   double e_vienna, e_native, time_vienna = 0, time_native = 0, start;
+   char *seq, *s_vienna, *s_native;
+   FoldEngine *vienna, *native;
+
+   if (argc > 1)
+      per_length = atoi(argv[1]);
+
+   dangles = 2;
+   vienna = fold_engine_alloc(FOLD_VIENNA, max_len, 1);
+   native = fold_engine_alloc(FOLD_NATIVE, max_len, 1);
+   fold_backends_params_changed();
+   seq = (char*) malloc(max_len+1);
+   s_vienna = (char*) malloc(max_len+1);
+   s_native = (char*) malloc(max_len+1);
+
+   printf("%4s %6s %9s %9s %6s %6s  %s\n", "nr", "length", "vienna", "native", "struct", "dist", "status");
+   for (int l=0; l<NUM_ENTRIES(lengths); l++)
+      for (int k=0; k<per_length; k++)
+      {
+         Random_GC_Sequence(rng, seq, lengths[l], (k%2 == 0)? 0.5 : 0.7);
+         n++;
+
+         start = Now();
+         e_vienna = fold_engine_fold(vienna, seq, s_vienna, 'F');
+         time_vienna += Now() - start;
+         start = Now();
+         e_native = fold_engine_fold(native, seq, s_native, 'F');
+         time_native += Now() - start;
+
+         bad_energy = (fabs(e_vienna - e_native) > 0.01);
+         bad_eval = ((fabs(fold_engine_energy(native, seq, s_vienna) - e_native) > 0.01) ||
+                     (fabs(fold_engine_energy(vienna, seq, s_native) - e_vienna) > 0.01));
+         dist = fold_engine_distance(native, s_vienna, s_native);
+         energy_diff += bad_energy;
+         eval_diff += bad_eval;
+         if (dist > 0)
+            struct_diff++;
+         if (dist > max_dist)
+            max_dist = dist;
+
+         printf("%4d %6d %9.2f %9.2f %6s %6d  %s\n", n, lengths[l], e_vienna, e_native, (dist == 0)? "same" : "other", dist,
+                bad_energy? "ENERGY" : (bad_eval? "EVAL" : "ok"));
+         if (bad_energy || bad_eval)
+            printf("     %s\n     %s\n     %s\n", seq, s_vienna, s_native);
+      }
+
+   printf("\n%-10s %8s %8s %8s %9s %12s %12s\n", "sequences", "energy", "eval", "struct", "max dist", "vienna [ms]", "native [ms]");
+   printf("%-10d %8d %8d %8d %9d %12.2f %12.2f\n", n, energy_diff, eval_diff, struct_diff, max_dist, time_vienna*1000/n, time_native*1000/n);
+
+   free(seq);
+   free(s_vienna);
+   free(s_native);
+   fold_engine_free(vienna);
+   fold_engine_free(native);
+   fold_backends_cleanup();
+   return ((energy_diff > 0) || (eval_diff > 0));
+}
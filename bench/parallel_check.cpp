@@ -0,0 +1,94 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../inforna.h"
+#include "../context.h"
+#include "bench.h"
+
+/*********************************************************
+ the parallel local search (num_threads, -P) has to give
+ the designs of the serial one, also when it is stopped
+ by an evaluation or step budget (-E, -A) in the middle
+ of a batch of neighbors: each target is designed with
+ 3 repeats (native fold) for each strategy, seed and
+ budget with 1 and with N threads and the solutions are
+ compared. The initializing step breaks ties at random
+ (seeded from the time), so both designs start from the
+ initial sequence of the serial one.
+
+ Returns 1 if a design differs.
+
+ usage: parallel_check [threads]
+*********************************************************/
+
+static const char* targets[] = {
+   "..((((((((....))))..((((...))))..))))..((((....))))...",
+   "(((((..((((((...)))))).....(((((....)))))..((((...))))...)))))....((((((....))))))"
+};
+
+static const long evaluations[] = {3, 11, 24, 50, 0, 0, 0, 20};
+static const long accepted[]    = {0, 0, 0, 0, 2, 5, 9, 4};
+
+static int Same_Result(const InfoRNAResult* a, const InfoRNAResult* b)
+{
+   if (a->num_solutions != b->num_solutions)
+      return 0;
+   for (int i=0; i<a->num_solutions; i++)
+      if ((strcmp(a->solutions[i].sequence, b->solutions[i].sequence) != 0) ||
+          (a->solutions[i].budget_exceeded != b->solutions[i].budget_exceeded))
+         return 0;
+   return 1;
+}
+
+int main(int argc, char** argv)
+{
+   int threads = 4, runs = 0, errors = 0;
+   InfoRNAOptions opt;
+   InfoRNADesign *serial, *parallel;
+
+   if (argc > 1)
+      threads = atoi(argv[1]);
+
+   for (int t=0; t<NUM_ENTRIES(targets); t++)
+      for (int strategy=1; strategy<=3; strategy++)
+         for (long seed=1; seed<=3; seed++)
+            for (int b=0; b<NUM_ENTRIES(evaluations); b++)
+            {
+               inforna_default_options(&opt);
+               opt.fold_engine = opt.eval_engine = 2;
+               opt.search_strategy = strategy;
+               opt.repeat = 3;
+               opt.seed = seed;
+               opt.max_evaluations = evaluations[b];
+               opt.max_accepted = accepted[b];
+
+               serial = inforna_prepare(targets[t], NULL, NULL, &opt);
+               opt.num_threads = threads;
+               parallel = inforna_prepare(targets[t], NULL, NULL, &opt);
+               if ((serial == NULL) || (parallel == NULL))
+               {
+                  fprintf(stderr, "rejected target: %s\n", targets[t]);
+                  return 1;
+               }
+               strcpy(parallel->ctx->best_char_seq, serial->ctx->best_char_seq);
+
+               while (!inforna_done(serial))
+                  inforna_repeat(serial);
+               while (!inforna_done(parallel))
+                  inforna_repeat(parallel);
+
+               runs++;
+               if (!Same_Result(&serial->result, &parallel->result))
+               {
+                  errors++;
+                  printf("differs: %s -S %d seed %ld -E %ld -A %ld\n", targets[t], strategy, seed, evaluations[b], accepted[b]);
+               }
+               inforna_free_design(serial);
+               inforna_free_design(parallel);
+            }
+
+   printf("%d of %d designs with %d threads differ from the serial ones\n", errors, runs, threads);
+   inforna_cleanup();
+   return (errors > 0);
+}
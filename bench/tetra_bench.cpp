@@ -0,0 +1,112 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../basics.h"
+#include "../data/tetra_loops.dat"
+#include "bench.h"
+
+/*********************************************************
+ microbenchmark of the tetraloop boni: the minimization
+ over the 256 assignments of a hairpin of size 4 for all
+ 6 closing BPs (as in BestHairpinLoopEnergy), once with
+ the former lookup (hexamer as a string, compared with
+ each special tetraloop) and once with the table indexed
+ by TETRA_INDEX. Both have to give the same minima.
+
+ usage: tetra_bench [rounds]
+*********************************************************/
+
+// the former lookup
+static int Strcmp_Tetra_Loop_Energy(const char* str)
+{
+   for (int t=0; t<num_tetra_loops; t++)
+      if (strcmp(str, tetra_loop_seqs[t]) == 0)
+         return tetra_loop_boni[t];
+   return 0;
+}
+
+static int Min_Strcmp(int bp_i, int bp_j)
+{
+   char tetra_plus_closing[7];
+   int energy_help, min = MAX_ENERGY;
+
+   tetra_plus_closing[0] = int2char(bp_i);
+   tetra_plus_closing[5] = int2char(bp_j);
+   tetra_plus_closing[6] = '\0';
+   for (int i=0; i<4; i++)
+      for (int j=0; j<4; j++)
+         for (int i2=0; i2<4; i2++)
+            for (int j2=0; j2<4; j2++)
+            {
+               tetra_plus_closing[1] = int2char(i);
+               tetra_plus_closing[2] = int2char(i2);
+               tetra_plus_closing[3] = int2char(j2);
+               tetra_plus_closing[4] = int2char(j);
+               energy_help = Strcmp_Tetra_Loop_Energy(tetra_plus_closing) + mismatch_energies_hairpin[64*bp_i+16*i+4*bp_j+j];
+               if (energy_help < min)
+                  min = energy_help;
+            }
+   return min;
+}
+
+static int Min_Table(int bp_i, int bp_j)
+{
+   int energy_help, min = MAX_ENERGY;
+
+   for (int i=0; i<4; i++)
+      for (int j=0; j<4; j++)
+         for (int i2=0; i2<4; i2++)
+            for (int j2=0; j2<4; j2++)
+            {
+               energy_help = tetra_loop_energy(TETRA_INDEX(bp_i,i,i2,j2,j,bp_j)) + mismatch_energies_hairpin[64*bp_i+16*i+4*bp_j+j];
+               if (energy_help < min)
+                  min = energy_help;
+            }
+   return min;
+}
+
+int main(int argc, char** argv)
+{
+   int rounds = 20000;
+   int bp_i, bp_j;
+   double start, t_strcmp, t_table;
+   long sum_strcmp = 0, sum_table = 0;
+
+   if (argc > 1)
+      rounds = atoi(argv[1]);
+
+   for (int bp=0; bp<6; bp++)
+   {
+      BP2_2(bp, bp_i, bp_j);
+      if (Min_Strcmp(bp_i, bp_j) != Min_Table(bp_i, bp_j))
+      {
+         fprintf(stderr, "different minima for the closing BP %d!\n", bp);
+         return 1;
+      }
+   }
+
+   start = Now();
+   for (int r=0; r<rounds; r++)
+      for (int bp=0; bp<6; bp++)
+      {
+         BP2_2(bp, bp_i, bp_j);
+         sum_strcmp += Min_Strcmp(bp_i, bp_j);
+      }
+   t_strcmp = Now() - start;
+
+   start = Now();
+   for (int r=0; r<rounds; r++)
+      for (int bp=0; bp<6; bp++)
+      {
+         BP2_2(bp, bp_i, bp_j);
+         sum_table += Min_Table(bp_i, bp_j);
+      }
+   t_table = Now() - start;
+
+   printf("size-4 hairpins, %d x 6 closing BPs\n", rounds);
+   printf("   strcmp lookup %8.1f ns per closing BP (%ld)\n", 1e9*t_strcmp/(6.0*rounds), sum_strcmp);
+   printf("   table         %8.1f ns per closing BP (%ld)\n", 1e9*t_table/(6.0*rounds), sum_table);
+   printf("   speedup       %8.1f\n", t_strcmp/t_table);
+   return 0;
+}
@@ -0,0 +1,94 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "../native_fold.h"
+#include "bench.h"
+
+/*********************************************************
+ scaling of the native fold with the number of threads
+ filling the matrices (wavefront of blocks) on random
+ sequences of 500, 2000 and 8000 bases:
+
+ fold = complete fold (native_fold_init)
+ eval = candidate with a point mutation in the middle
+        (native_fold_eval, about a quarter of the cells,
+        but the longest ones)
+ avg  = mean eval of point mutations at 8 positions spread
+        over the sequence (the rollback of the former
+        candidate included)
+ eval/fold = share of a complete fold of both evals
+
+ The threads double up to the number of OpenMP threads.
+ The energies have to be the same for all thread counts.
+
+ usage: wavefront_bench [max. length] [max. threads]
+*********************************************************/
+
+int main(int argc, char** argv)
+{
+   int lengths[] = {500, 2000, 8000};
+   int max_len = 8000, max_threads = omp_get_max_threads();
+   int e_fold, e_eval, ref_fold = 0, ref_eval = 0, errors = 0;
+   unsigned short rng[3] = {0x330E, 7, 0};
+   double start, ms_fold, ms_eval, ms_avg, ref_ms = 0;
+   char *seq, *cand, *pos_cand;
+   NativeFold* nf;
+
+   if (argc > 1)
+      max_len = atoi(argv[1]);
+   if (argc > 2)
+      max_threads = atoi(argv[2]);
+
+   printf("%7s %8s %12s %12s %12s %11s %9s\n", "length", "threads", "fold [ms]", "eval [ms]", "avg [ms]", "eval/fold", "speedup");
+   for (int l=0; l<NUM_ENTRIES(lengths) && lengths[l]<=max_len; l++)
+   {
+      int n = lengths[l];
+      seq = (char*) malloc(n+1);
+      cand = (char*) malloc(n+1);
+      pos_cand = (char*) malloc(n+1);
+      Random_Sequence(rng, seq, n);
+      strcpy(cand, seq);
+      cand[n/2] = (cand[n/2] == 'G')? 'A' : 'G';
+
+      for (int threads=1; threads<=max_threads; threads*=2)
+      {
+         nf = native_fold_alloc(n, threads);
+         start = Now();
+         e_fold = native_fold_init(nf, seq, NULL, 'F');
+         ms_fold = (Now() - start)*1000;
+         start = Now();
+         e_eval = native_fold_eval(nf, cand, NULL, 'F');
+         ms_eval = (Now() - start)*1000;
+         start = Now();
+         for (int k=0; k<8; k++)
+         {
+            int p = (2*k+1)*n/16;
+            strcpy(pos_cand, seq);
+            pos_cand[p] = (pos_cand[p] == 'G')? 'A' : 'G';
+            native_fold_eval(nf, pos_cand, NULL, 'F');
+         }
+         ms_avg = (Now() - start)*1000/8;
+         native_fold_free(nf);
+
+         if (threads == 1)
+         {
+            ref_fold = e_fold;
+            ref_eval = e_eval;
+            ref_ms = ms_fold;
+         }
+         else if ((e_fold != ref_fold) || (e_eval != ref_eval))
+         {
+            errors++;
+            printf("energies differ: %d %d instead of %d %d\n", e_fold, e_eval, ref_fold, ref_eval);
+         }
+         printf("%7d %8d %12.1f %12.1f %12.1f %5.2f %5.2f %9.2f\n", n, threads, ms_fold, ms_eval, ms_avg, ms_eval/ms_fold,
+                ms_avg/ms_fold, ref_ms/ms_fold);
+      }
+      free(seq);
+      free(cand);
+      free(pos_cand);
+   }
+   return (errors > 0);
+}
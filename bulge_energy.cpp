@@ -1,8 +1,8 @@
 #include "bulge_energy.h"
 
-double BulgeEnergy(int size, int bp_i, int bp_j, int bp_before)
+int BulgeEnergy(int size, int bp_i, int bp_j, int bp_before)
 {
-   double energy = 0.0;
+   int energy = 0;
    int base_i_before, base_j_before;
 
    BP2_2(bp_before,base_i_before,base_j_before);
@@ -22,7 +22,7 @@ double BulgeEnergy(int size, int bp_i, int bp_j, int bp_before)
    else
    {
       energy += loop_destabilizing_energies[3*30-2];
-      energy += 1.75*RT*log((double)(size/30.0));
+      energy += LoopExtrapolation(size);
    }
 
    // additional bulge-energy (size 1: stacking, >1: nothing, but term. A-U-penalty:
@@ -32,9 +32,9 @@ double BulgeEnergy(int size, int bp_i, int bp_j, int bp_before)
    else
    {
       if ((bp_before == 0) || (bp_before == 3) || (bp_before == 4) || (bp_before == 5))
-         energy += terminalAU;
+         energy += energy_tables.terminalAU;
       if ((BP2int(bp_i, bp_j) == 0) || (BP2int(bp_i,bp_j) == 3) || (BP2int(bp_i,bp_j) == 4) || (BP2int(bp_i,bp_j) == 5))
-         energy += terminalAU;
+         energy += energy_tables.terminalAU;
    }
    return energy;
 }
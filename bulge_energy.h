@@ -7,6 +7,6 @@
 
 using namespace std;
 
-double BulgeEnergy(int size, int bp_i, int bp_j, int bp_before);
+int BulgeEnergy(int size, int bp_i, int bp_j, int bp_before);
 
 #endif   // _BULGE_ENERGY_
@@ -6,14 +6,14 @@
  make T to U!!
 *********************************************************/
 
-int Check_iu()
+int Check_iu(DesignContext* ctx)
 {
-   for(int i=0; i<(int)strlen(iupac_const); i++)
+   for(int i=0; i<(int)strlen(ctx->iupac_const); i++)
    {
-      iupac_const[i] = toupper(iupac_const[i]);
-      if (iupac_const[i] == 'T')
-         iupac_const[i] = 'U';
-      if  (Valid_IUPAC(iupac_const[i]) == 0)
+      ctx->iupac_const[i] = toupper(ctx->iupac_const[i]);
+      if (ctx->iupac_const[i] == 'T')
+         ctx->iupac_const[i] = 'U';
+      if  (Valid_IUPAC(ctx->iupac_const[i]) == 0)
          return 0;
    }
    return 1;
@@ -26,21 +26,21 @@ int Check_iu()
  fulfilled
 *********************************************************/
 
-int Check_constraints_bp()
+int Check_constraints_bp(DesignContext* ctx)
 {
    int bp_pos_i, bp_pos_j, bp_assign_i, bp_assign_j;
    bool possible;
 
-   for (int bp_pos=0; bp_pos<numBP; bp_pos++)
+   for (int bp_pos=0; bp_pos<ctx->numBP; bp_pos++)
    {
-      bp_pos_i = BP_Order[bp_pos][0];
-      bp_pos_j = BP_Order[bp_pos][1];
+      bp_pos_i = ctx->BP_Order[bp_pos][0];
+      bp_pos_j = ctx->BP_Order[bp_pos][1];
 
       possible = false;
       for (int bp_assign = 0; bp_assign<6; bp_assign++)
       {
          BP2_2(bp_assign, bp_assign_i, bp_assign_j);
-         if (Compare_IUPAC_Base(iupac_const[bp_pos_i],bp_assign_i)+Compare_IUPAC_Base(iupac_const[bp_pos_j],bp_assign_j) == 2)
+         if (Compare_IUPAC_Base(ctx->iupac_const[bp_pos_i],bp_assign_i)+Compare_IUPAC_Base(ctx->iupac_const[bp_pos_j],bp_assign_j) == 2)
          {
             possible = true;
             break;
@@ -48,8 +48,8 @@ int Check_constraints_bp()
       }
       if (possible == false)
       {
-         cerr << "\n" << iupac_const[bp_pos_i] << " and " << iupac_const[bp_pos_j] << " are not compatible!\n\n";
-         exit(1);
+         cerr << "\n" << ctx->iupac_const[bp_pos_i] << " and " << ctx->iupac_const[bp_pos_j] << " are not compatible!\n\n";
+         return 0;
       }
    }
    return 1;
@@ -60,18 +60,34 @@ int Check_constraints_bp()
 /***********************************************************
 translates the IUPAC-Seq (iupac_const) the two dimen. array
 where the constraints are stored, e.g. R becomes: 1010, i.e. 
-A and G are valid, but C and U not
+A and G are valid, but C and U not. Furthermore, the valid
+bases are compiled into the bit masks allowed_mask, e.g. R
+becomes 0101 (bit 0 = A): one for the initializing step and
+one for the local search, where all bases are valid at the
+positions of mis_vec (thus mis_vec has to be set before)
 ***********************************************************/
 
-void getSeqConstraints()
+void getSeqConstraints(DesignContext* ctx)
 {
+   int len = strlen(ctx->iupac_const);
+   unsigned char mask;
+
    //allocate and set
-   seq_constraints = (int**) malloc(sizeof(int*)*strlen(iupac_const));
-   for (int i=0; i<(int)strlen(iupac_const); i++)
+   ctx->seq_constraints = (int**) malloc(sizeof(int*)*len);
+   ctx->allowed_mask[0] = (unsigned char*) malloc(sizeof(unsigned char)*2*len);
+   ctx->allowed_mask[1] = ctx->allowed_mask[0] + len;
+   for (int i=0; i<len; i++)
    {
-      seq_constraints[i] = (int*) malloc(sizeof(int)*4);
+      ctx->seq_constraints[i] = (int*) malloc(sizeof(int)*4);
+      mask = 0;
       for (int j=0; j<4; j++)
-         seq_constraints[i][j] = Compare_IUPAC_Base(iupac_const[i], j);
+      {
+         ctx->seq_constraints[i][j] = Compare_IUPAC_Base(ctx->iupac_const[i], j);
+         if (ctx->seq_constraints[i][j] == 1)
+            mask |= 1 << j;
+      }
+      ctx->allowed_mask[0][i] = mask;
+      ctx->allowed_mask[1][i] = (ctx->mis_vec[i] == 1)? 15 : mask;
    }
 
    //print
@@ -99,86 +115,60 @@ double Sum_MinInt(double sum1, double sum2)
 
 
 /***********************************************************
- tests, whether one of two values is higher than MAX_DOUBLE,
- if so, the sum is set to MAX_DOUBLE as well
+ difference of two energies in kcal/mol, if one of the
+ values is MAX_ENERGY, the difference is set to MIN_INT
+ (used during the calculation of Ediff, is a constellation
+ is penalized, this should be seen in Ediff as well)
 ***********************************************************/
 
-double Sum_MaxDouble(double sum1, double sum2)
+double Sub_MinInt(int sum, int sub)
 {
-   if ((sum1 == MAX_DOUBLE) || (sum2 == MAX_DOUBLE))
-      return MAX_DOUBLE;
+   if ((sum == MAX_ENERGY) || (sub == MAX_ENERGY))
+      return MIN_INT;
    else
-      return sum1+sum2;
+      return (sum-sub)/100.0;
 }
 
 
 /***********************************************************
- tests, whether one of three values is higher than MAX_DOUBLE,
- if so, the sum is set to MAX_DOUBLE as well
+ penalties of A,C,G,U for each mask of allowed bases, and
+ the penalty of a base by its bit in the mask
 ***********************************************************/
 
-double Sum_MaxDouble3(double sum1, double sum2, double sum3)
-{
-   if ((sum1 == MAX_DOUBLE) || (sum2 == MAX_DOUBLE) || (sum3 == MAX_DOUBLE))
-      return MAX_DOUBLE;
-   else
-      return sum1+sum2+sum3;
-}
+#define MASK_PENALTIES(m) { ((m)&1)? 0 : MAX_ENERGY, ((m)&2)? 0 : MAX_ENERGY, ((m)&4)? 0 : MAX_ENERGY, ((m)&8)? 0 : MAX_ENERGY }
 
+static const int mask_penalties[16][4] = {
+   MASK_PENALTIES(0),  MASK_PENALTIES(1),  MASK_PENALTIES(2),  MASK_PENALTIES(3),
+   MASK_PENALTIES(4),  MASK_PENALTIES(5),  MASK_PENALTIES(6),  MASK_PENALTIES(7),
+   MASK_PENALTIES(8),  MASK_PENALTIES(9),  MASK_PENALTIES(10), MASK_PENALTIES(11),
+   MASK_PENALTIES(12), MASK_PENALTIES(13), MASK_PENALTIES(14), MASK_PENALTIES(15)
+};
 
-/***********************************************************
- tests, whether one of four values is higher than MAX_DOUBLE,
- if so, the sum is set to MAX_DOUBLE as well
-***********************************************************/
-
-double Sum_MaxDouble4(double sum1, double sum2, double sum3, double sum4)
-{
-   if ((sum1 == MAX_DOUBLE) || (sum2 == MAX_DOUBLE) || (sum3 == MAX_DOUBLE) || (sum4==MAX_DOUBLE))
-      return MAX_DOUBLE;
-   else
-      return sum1+sum2+sum3+sum4;
-}
+static const int bit_penalty[2] = {MAX_ENERGY, 0};
 
 
 /***********************************************************
- tests, whether one of the values is MIN_INT
- if so, the difference is set to MIN_INT as well
- (used during the calculation of Ediff, is a constellation
- is penalized, this should be seen in Ediff as well)
+ identifies, whether a given base is valid at a given pos.
+ (if necessary, the penalty is given). Constraint mismatches
+ are allowed only in the local search (step 2), the mask of
+ the step is used
 ***********************************************************/
 
-double Sub_MinInt(double sum, double sub)
+int BasePenalty(DesignContext* ctx, int pos, int base_assign)
 {
-   if ((sum == MAX_DOUBLE) || (sub == MAX_DOUBLE))
-      return MIN_INT;
-   else
-      return sum-sub;
+   return mask_penalties[ctx->allowed_mask[ctx->step-1][pos]][base_assign];
 }
 
 
 /***********************************************************
- identifies, whether a given base is valid at a given pos.
- (if necessary, the penalty is given)
+ gives the penalties of all 4 bases at a given pos.
+ (indexed by the base), for the minimizations over the
+ assignments of a loop
 ***********************************************************/
 
-double BasePenalty(int pos, int base_assign)
+const int* BasePenalties(DesignContext* ctx, int pos)
 {
-   if (step == 1)
-   {
-      if (seq_constraints[pos][base_assign] == 1)
-         return 0;
-      else
-         return MAX_DOUBLE;
-   }
-   else
-   {
-      if (seq_constraints[pos][base_assign] == 1)
-         return 0;
-      else if ((seq_constraints[pos][base_assign] == 0) && (mis_vec[pos] == 1))
-         return 0;
-      else
-         return MAX_DOUBLE;
-   }
+   return mask_penalties[ctx->allowed_mask[ctx->step-1][pos]];
 }
 
 
@@ -186,16 +176,15 @@ double BasePenalty(int pos, int base_assign)
  identifies the penalty for a base pair
 ************************************************************/
 
-double PairPenalty(int bp_pos, int bp_i, int bp_j)
+int PairPenalty(DesignContext* ctx, int bp_pos, int bp_i, int bp_j)
 {
-   int pos_i = BP_Order[bp_pos][0];
-   int pos_j = BP_Order[bp_pos][1];
-   return Sum_MaxDouble(BasePenalty(pos_i, bp_i),BasePenalty(pos_j, bp_j));
+   return PairPenalty(ctx, ctx->BP_Order[bp_pos][0], ctx->BP_Order[bp_pos][1], bp_i, bp_j);
 }
 
-double PairPenalty(int pos_i, int pos_j, int bp_i, int bp_j)
+int PairPenalty(DesignContext* ctx, int pos_i, int pos_j, int bp_i, int bp_j)
 {
-   return Sum_MaxDouble(BasePenalty(pos_i, bp_i),BasePenalty(pos_j, bp_j));
+   const unsigned char* mask = ctx->allowed_mask[ctx->step-1];
+   return bit_penalty[(mask[pos_i] >> bp_i) & (mask[pos_j] >> bp_j) & 1];
 }
 
 /*************************************************************
@@ -203,9 +192,9 @@ double PairPenalty(int pos_i, int pos_j, int bp_i, int bp_j)
  (= gives the number of valid bases)
 *************************************************************/
 
-int Sum_SeqConst(int pos_row)
+int Sum_SeqConst(DesignContext* ctx, int pos_row)
 {
-   return seq_constraints[pos_row][0]+seq_constraints[pos_row][1]+seq_constraints[pos_row][2]+seq_constraints[pos_row][3];
+   return ctx->seq_constraints[pos_row][0]+ctx->seq_constraints[pos_row][1]+ctx->seq_constraints[pos_row][2]+ctx->seq_constraints[pos_row][3];
 }
 
 
@@ -215,7 +204,7 @@ int Sum_SeqConst(int pos_row)
  (minds the constraints and free_bases_set2X)
 *************************************************************/
 
-int SetFreeBase(int pos)
+int SetFreeBase(DesignContext* ctx, int pos)
 {
    // if all free bases that give no energy-part are choosen to be set to a fixed base, we have to test the constraints at this positions 
    // nevertheless. If the fixed base is forbidden by the constraints, a base is chosen ramdomly among the other bases
@@ -223,10 +212,10 @@ int SetFreeBase(int pos)
    // generate a vector that gives the base assignments that are allowed (concerning free_bases_set2X and seq_constraints)
    int* free_bases_set2;
    free_bases_set2 = (int*) malloc(sizeof(int)*4);
-   free_bases_set2[0] = Minimum(free_bases_set2A,seq_constraints[pos][0]);
-   free_bases_set2[1] = Minimum(free_bases_set2C,seq_constraints[pos][1]);
-   free_bases_set2[2] = Minimum(free_bases_set2G,seq_constraints[pos][2]);
-   free_bases_set2[3] = Minimum(free_bases_set2U,seq_constraints[pos][3]);
+   free_bases_set2[0] = Minimum(ctx->free_bases_set2A,ctx->seq_constraints[pos][0]);
+   free_bases_set2[1] = Minimum(ctx->free_bases_set2C,ctx->seq_constraints[pos][1]);
+   free_bases_set2[2] = Minimum(ctx->free_bases_set2G,ctx->seq_constraints[pos][2]);
+   free_bases_set2[3] = Minimum(ctx->free_bases_set2U,ctx->seq_constraints[pos][3]);
 
    // If all bases fixed by free_bases_set2X are forbidden by seq_constraints, or if no fixed forces are given (free_bases_set2X = 0 for all X), 
    // this vector consists only of zeros and the "else" is done
@@ -234,7 +223,7 @@ int SetFreeBase(int pos)
 
    if (sum_constraints > 0)
    {
-      int rand_free = RandomBase(sum_constraints) + 1;
+      int rand_free = RandomBase(ctx->rng, sum_constraints) + 1;
       int ones = 0;
       int column = -1;
       while (ones < rand_free)
@@ -248,19 +237,19 @@ int SetFreeBase(int pos)
    }
    else // if no forces because of free_bases_set2X or if all bases fixed by free_bases_set2X are forbidden by seq_constraints
    {
-      int sum = Sum_SeqConst(pos); //number of valid assignments
+      int sum = Sum_SeqConst(ctx, pos); //number of valid assignments
       if (sum == 0)
       {
          cerr << "No valid base at position " << pos << "!\n";
          exit(1);
       }
-      int rand = RandomBase(sum) + 1;  // the rand-th valid base assignment is chosen
+      int rand = RandomBase(ctx->rng, sum) + 1;  // the rand-th valid base assignment is chosen
       int ones = 0;
       int column = -1;
       while (ones < rand)
       {
          column++;
-         if (seq_constraints[pos][column] == 1)
+         if (ctx->seq_constraints[pos][column] == 1)
             ones++;
       }
       //column is the randomly chosen base assignment (0=A, 1=C, 2=G, 3=U)
@@ -269,3 +258,106 @@ int SetFreeBase(int pos)
 }
 
 
+
+/*************************************************************
+ tests, whether a free base at pos may be mutated from
+ base_cur to base_new concerning the allowed mismatches,
+ returns 0 if not; mismatches gives the change of the number
+ of mismatches (used during the local search)
+*************************************************************/
+
+int BaseMismatches(DesignContext* ctx, int pos, int base_cur, int base_new, int &mismatches)
+{
+   mismatches = 0;
+   // if in the current sequence is no mismatch at the considered position
+   if (ctx->seq_constraints[pos][base_cur] == 1)
+   {
+      // if the assignment of the base is forbidden and maximal number of mismatches is reached or the base is located 
+      // outside the mismatch interval, no further testing.
+      if ((ctx->seq_constraints[pos][base_new] == 0) && ((ctx->num_mis >= ctx->max_mis) || (ctx->mis_vec[pos] == 0)))
+         return 0;
+
+      // if the assignment of the base is forbidden, this mismatch should be added
+      // if we are still here, it is clear that the constrained base is located in the mismatch interval. 
+      // thus, it is not necessary to test it again
+      if (ctx->seq_constraints[pos][base_new] == 0)
+         mismatches = 1;
+   }
+   // if in the current sequence the current position is already a mismatch: everything is possible, i.e. it can be mutated
+   // to another mismatch or to a match
+   else
+      if (ctx->seq_constraints[pos][base_new] == 1)
+         mismatches = -1; //current base is a mismatch but the new one not => one mismatch less
+   return 1;
+}
+
+
+/*************************************************************
+ tests, whether the BP (pos_i,pos_j) may be mutated from
+ (cur_i,cur_j) to (bp_i,bp_j) concerning the allowed
+ mismatches, returns 0 if not; mismatches gives the change
+ of the number of mismatches (used during the local search)
+*************************************************************/
+
+int PairMismatches(DesignContext* ctx, int pos_i, int pos_j, int cur_i, int cur_j, int bp_i, int bp_j, int &mismatches)
+{
+   mismatches = 0;
+
+   // first testing whether the mismatches are allowed
+   if (((ctx->mis_vec[pos_i] == 0) && (ctx->seq_constraints[pos_i][bp_i] == 0)) || ((ctx->mis_vec[pos_j] == 0) && (ctx->seq_constraints[pos_j][bp_j] == 0)))
+      return 0;
+
+   // if in the current sequence are no mismatches at the considered positions
+   if ((ctx->seq_constraints[pos_i][cur_i] == 1) && (ctx->seq_constraints[pos_j][cur_j] == 1))
+   {
+      // if the assignment of the bases is forbidden and maximal number of mismatches is reached, no further testing.
+      // (that the mismatches are valid has already been tested)
+      if ((ctx->seq_constraints[pos_i][bp_i] == 0) && (ctx->num_mis >= ctx->max_mis))
+         return 0;
+
+      if ((ctx->seq_constraints[pos_j][bp_j] == 0) && (ctx->num_mis >= ctx->max_mis))
+         return 0;
+
+      // if the assignment of both positions is forbidden and the maximal number of mismatches - 1 is reached, no further testing.
+      if (((ctx->seq_constraints[pos_i][bp_i] == 0) && (ctx->seq_constraints[pos_j][bp_j] == 0)) && (ctx->num_mis >= ctx->max_mis-1))
+         return 0;
+
+      // if the assignment of the base is forbidden, this mismatch should be added
+      // it is clear that the constrained bases are valid for mismatches
+      if (ctx->seq_constraints[pos_i][bp_i] == 0)
+         mismatches++;
+      if (ctx->seq_constraints[pos_j][bp_j] == 0)
+         mismatches++;
+   }
+   // if in the current sequence is already one mismatch at one of the two considered positions
+   else if ((ctx->seq_constraints[pos_i][cur_i] == 1) || (ctx->seq_constraints[pos_j][cur_j] == 1))
+   {
+      // if there are one match and one mismatch currently and after the mutation two matches: allowed but the number of mismatches reduces
+      if ((ctx->seq_constraints[pos_i][bp_i] == 1) && (ctx->seq_constraints[pos_j][bp_j] == 1))
+         mismatches--;
+      // if there are one match and one mismatch currently and after the mutation as well: the number of mismatches remains unchanged
+      // (it is already clear that the mismatches are valid)
+
+      // if there are one match and one mismatch currently and after the mutation two mismatches:
+      // the number of mismatches has to be increased by one and we have to take care of the maximal number 
+      // of allowed mismatches (max_mis)
+      else if ((ctx->seq_constraints[pos_i][bp_i] == 0) && (ctx->seq_constraints[pos_j][bp_j] == 0))
+      {
+         if (ctx->num_mis >= ctx->max_mis)
+            return 0;
+         else
+            mismatches++;
+      }
+   }
+   // if both current positions are already mismatches, : everything is possible, i.e. it can be mutated
+   // to another mismatch or to a match
+   else
+   {
+      //current base is a mismatch but the new one not => one mismatch less
+      if (ctx->seq_constraints[pos_i][bp_i] == 1)
+         mismatches--;
+      if (ctx->seq_constraints[pos_j][bp_j] == 1)
+         mismatches--;
+   }
+   return 1;
+}
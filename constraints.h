@@ -6,20 +6,50 @@
 
 using namespace std;
 
-int Check_iu();
-int Check_constraints_bp();
-void getSeqConstraints();
+int Check_iu(DesignContext* ctx);
+int Check_constraints_bp(DesignContext* ctx);
+void getSeqConstraints(DesignContext* ctx);
+
+// energies of the initializing step are integers in dcal/mol (10 cal/mol, as in Vienna), MAX_ENERGY
+// is the energy of an assignment that is not valid (e.g. forbidden by the constraints)
+#define MAX_ENERGY 100000000
+
+/***********************************************************
+ sums of energies, if one of the values is MAX_ENERGY, the
+ sum is MAX_ENERGY as well. Finite energies are far below
+ MAX_ENERGY/2, thus no value has to be tested: each sum
+ that reaches MAX_ENERGY/2 is set to MAX_ENERGY
+***********************************************************/
+
+inline int Sum_MaxEnergy(int sum1, int sum2)
+{
+   int sum = sum1+sum2;
+   return (sum < MAX_ENERGY/2)? sum : MAX_ENERGY;
+}
+
+inline int Sum_MaxEnergy3(int sum1, int sum2, int sum3)
+{
+   int sum = sum1+sum2+sum3;
+   return (sum < MAX_ENERGY/2)? sum : MAX_ENERGY;
+}
+
+inline int Sum_MaxEnergy4(int sum1, int sum2, int sum3, int sum4)
+{
+   int sum = sum1+sum2+sum3+sum4;
+   return (sum < MAX_ENERGY/2)? sum : MAX_ENERGY;
+}
 
 double Sum_MinInt(double sum1, double sum2);
-double Sum_MaxDouble(double sum1, double sum2);
-double Sum_MaxDouble3(double sum1, double sum2, double sum3);
-double Sum_MaxDouble4(double sum1, double sum2, double sum3, double sum4);
-double Sub_MinInt(double sum, double sub);
-
-double BasePenalty(int pos, int base_assign);
-double PairPenalty(int bp_pos, int bp_i, int bp_j);
-double PairPenalty(int pos_i, int pos_j, int bp_i, int bp_j);
-int Sum_SeqConst(int pos_row);
-int SetFreeBase(int pos);
+double Sub_MinInt(int sum, int sub);
+
+int BasePenalty(DesignContext* ctx, int pos, int base_assign);
+const int* BasePenalties(DesignContext* ctx, int pos);
+int PairPenalty(DesignContext* ctx, int bp_pos, int bp_i, int bp_j);
+int PairPenalty(DesignContext* ctx, int pos_i, int pos_j, int bp_i, int bp_j);
+int Sum_SeqConst(DesignContext* ctx, int pos_row);
+int SetFreeBase(DesignContext* ctx, int pos);
+
+int BaseMismatches(DesignContext* ctx, int pos, int base_cur, int base_new, int &mismatches);
+int PairMismatches(DesignContext* ctx, int pos_i, int pos_j, int cur_i, int cur_j, int bp_i, int bp_j, int &mismatches);
 
 #endif   // _CONSTRAINTS_
@@ -0,0 +1,168 @@
+
+#include "context.h"
+#include "basics.h"
+
+/*********************************************************
+ creates a design context with the default options,
+ the structure and the constraints are set by the caller
+*********************************************************/
+
+DesignContext* NewDesignContext()
+{
+   DesignContext* ctx = (DesignContext*) malloc(sizeof(DesignContext));
+   if (ctx == NULL)
+   {
+      cerr << "Not enough memory for the design context!\n";
+      exit(1);
+   }
+
+   ctx->free_bases_set2A = 0;
+   ctx->free_bases_set2C = 0;
+   ctx->free_bases_set2G = 0;
+   ctx->free_bases_set2U = 0;
+   ctx->random_init = 0;
+   ctx->search_strategy = 1;
+   ctx->neighbour_choice = 1;
+   ctx->only_mutation_is_step = 0;
+   ctx->step_multiplier = 10;
+   ctx->p_accept = 0.1;
+   ctx->fold_engine = 1;
+   ctx->num_threads = 1;
+   ctx->fold_threads = 1;
+   ctx->deadline = 3600;
+   ctx->max_evaluations = 0;
+   ctx->max_accepted = 0;
+   ctx->energy_filter = -1;
+
+   ctx->step = 1;
+   ctx->brackets = NULL;
+   ctx->struct_len = 0;
+   ctx->BP_Order = NULL;
+   ctx->numBP = 0;
+   ctx->BP_Pos_Nr = NULL;
+   ctx->loops = NULL;
+
+   ctx->D = NULL;
+   ctx->Trace_Start = NULL;
+   ctx->Trace = NULL;
+   ctx->best_char_seq = NULL;
+
+   ctx->iupac_const = NULL;
+   ctx->seq_constraints = NULL;
+   ctx->allowed_mask[0] = NULL;
+   ctx->allowed_mask[1] = NULL;
+   ctx->max_mis = -1;
+   ctx->num_mis = 0;
+   ctx->mis_vec = NULL;
+
+   ctx->BP_Precursors = NULL;
+   ctx->BP_Successors = NULL;
+   ctx->Ediff = NULL;
+   ctx->av_Ediff = NULL;
+   ctx->max_Ediff = NULL;
+   ctx->Ediff_seq = NULL;
+   ctx->Ediff_valid = NULL;
+   ctx->Ediff_mark = NULL;
+   ctx->Ediff_rank = NULL;
+   ctx->Enclosing = NULL;
+   ctx->Loop_Start = NULL;
+   ctx->Loop_Members = NULL;
+   ctx->time_out = 0;
+   ctx->start_time = 0;
+   ctx->evaluations = 0;
+   ctx->accepted = 0;
+   ctx->filtered = 0;
+   ctx->fold_type = 0;
+   ctx->backtrack_type = 'F';
+   ctx->cost2 = 0;
+   ctx->engines = NULL;
+   ctx->folder = NULL;
+   ctx->rng = xsubi;
+   ctx->scratch = NULL;
+   ctx->scratch_size = 0;
+   ctx->scratch_used = 0;
+
+   return ctx;
+}
+
+/*********************************************************
+ frees the arrays of the design, the structure (brackets)
+ and the IUPAC constraints belong to the caller
+*********************************************************/
+
+void FreeDesignContext(DesignContext* ctx)
+{
+   int i;
+
+   free(ctx->D);   // incl. Trace_Start and Trace
+
+   if (ctx->BP_Order != NULL)
+   {
+      for (i=0; i<ctx->numBP+1; i++)
+         free(ctx->BP_Order[i]);
+      free(ctx->BP_Order);
+   }
+
+   if (ctx->seq_constraints != NULL)
+   {
+      for (i=0; i<ctx->struct_len; i++)
+         free(ctx->seq_constraints[i]);
+      free(ctx->seq_constraints);
+   }
+   free(ctx->allowed_mask[0]);
+
+   if (ctx->Ediff != NULL)
+   {
+      for (i=0; i<ctx->struct_len; i++)
+         free(ctx->Ediff[i]);
+      free(ctx->Ediff);
+   }
+
+   free(ctx->av_Ediff);
+   free(ctx->max_Ediff);
+   free(ctx->Ediff_seq);
+   free(ctx->Ediff_valid);
+   free(ctx->Ediff_mark);
+   free(ctx->Ediff_rank);
+   free(ctx->Enclosing);
+   free(ctx->Loop_Start);
+   free(ctx->Loop_Members);
+   free(ctx->BP_Pos_Nr);
+   Free_LoopIndex(ctx->loops);
+   free(ctx->BP_Precursors);
+   free(ctx->BP_Successors);
+   free(ctx->best_char_seq);
+   free(ctx->mis_vec);
+   free(ctx->scratch);
+   if (ctx->engines != NULL)   // kept by the local search for the next repeat
+   {
+      for (i=0; i<ctx->num_threads; i++)
+         fold_engine_free(ctx->engines[i]);
+      free(ctx->engines);
+   }
+   fold_engine_free(ctx->folder);
+   free(ctx);
+}
+
+/*********************************************************
+ takes a block of size bytes from the scratch arena, it
+ is given back by Scratch_Release
+*********************************************************/
+
+void* Scratch_Alloc(DesignContext* ctx, size_t size)
+{
+   size_t start = SCRATCH_BYTES(ctx->scratch_used);
+
+   if (start + size > ctx->scratch_size)
+   {
+      cerr << "The scratch arena of the design is too small!\n";
+      exit(1);
+   }
+   ctx->scratch_used = start + size;
+   return ctx->scratch + start;
+}
+
+void Scratch_Release(DesignContext* ctx, size_t mark)
+{
+   ctx->scratch_used = mark;
+}
@@ -0,0 +1,118 @@
+#ifndef _CONTEXT__
+#define _CONTEXT__
+
+#include <stdlib.h>
+
+using namespace std;
+
+struct FoldEngine;
+struct LoopIndex;
+
+struct PosEnergy {
+   int pos;
+   double energy;
+};
+
+#define SCRATCH_ALIGN 16
+// bytes of the scratch arena taken by a block of size bytes
+#define SCRATCH_BYTES(size) (((size_t)(size) + SCRATCH_ALIGN-1) & ~(size_t)(SCRATCH_ALIGN-1))
+
+/**********************************************************************************
+*  All state of the design of one structure. It is created by NewDesignContext,  *
+*  filled by main (options, structure, constraints) and passed to all functions  *
+*  of the initializing step and of the local search, so that several designs     *
+*  can run in one process.                                                       *
+**********************************************************************************/
+
+struct DesignContext
+{
+   // options
+   bool free_bases_set2A;      // is true, if free bases have to be set to 'A'
+   bool free_bases_set2C;
+   bool free_bases_set2G;
+   bool free_bases_set2U;
+   bool random_init;           // true, if the initializing sequence should be designed with random and not optimal
+   int search_strategy;        // gives the search strategy ( 1 = adaptive walk, 2 = full local search, 3 = stochastic local search)
+   int neighbour_choice;       // gives the kind of ranking of the neighbors (1 = random, 2 = energy dependent)
+   int only_mutation_is_step;  // gives the information how to count the step done during the stochastic local search
+   int step_multiplier;        // maximal number of steps during SLS = step_multiplier * length
+   double p_accept;            // probability to accept worse neighbors during SLS
+   int fold_engine;            // backend folding the candidates during the local search (FoldBackendId, fold_engine.h)
+   int num_threads;            // number of threads that fold the neighbors during the local search in parallel
+   int fold_threads;           // number of threads that fold one sequence (wavefront of the native fold)
+   double deadline;            // max. running time of one run of the local search in seconds (0 = no limit)
+   long max_evaluations;       // max. number of folded candidates per run of the local search (0 = no limit)
+   long max_accepted;          // max. number of accepted steps per run of the local search (0 = no limit)
+   double energy_filter;       // candidates that raise the energy of the target structure by more than this (kcal/mol)
+                               // are not folded (< 0 = all candidates are folded)
+
+   // structure
+   int step;                   // is 1 if we are in the initialization step, 2 during the local search (constraint mismatches
+                               // are allowed only during the second step, but PairPenalty, BasePenalty are used in both)
+   char* brackets;             // structure given in bracket notation
+   int struct_len;             // size of the structure
+   int** BP_Order;             // order of the base pairs (BPs) in which they are examined
+   int numBP;                  // number of base pairs
+   int* BP_Pos_Nr;             // vector in which for each pos. in brackets the pos. in BP_Order is stored
+   LoopIndex* loops;           // loop decomposition of the structure (types, enclosed BPs, connections), see loop_index.h
+
+   // initializing step
+   int (*D)[6];                // dynamic recursion matrix, a row of the 6 BP assignments for each BP (+ external loop)
+   int* Trace_Start;           // dynamic traceback: for each BP the best assignments of its predecessors (the enclosed BPs
+   signed char* Trace;         // of its loop), Trace[Trace_Start[i]..Trace_Start[i+1]-1] for BP i (see TraceAssign),
+                               // -1 = no predecessor. D, Trace_Start and Trace are one block (alloc_Recursion)
+   char* best_char_seq;        // designed sequence
+
+   // constraints
+   char* iupac_const;          // sequence constraints in IUPAC Code. If not given by the user, iupac_const is set to NNNNNN....
+   int** seq_constraints;      // IUPAC constraints translated in boolean constraint (0 = base not allowed, 1 = allowed)
+   unsigned char* allowed_mask[2]; // allowed bases of each pos. as bit mask (bit b = base b) during the initializing step
+                               // ([0]) and the local search ([1] = [0]+struct_len, mismatches allowed by mis_vec)
+   int max_mis;                // max. number of mismatches that are allowed among the constrained position or in an interval
+   int num_mis;                // counter for occuring mismatches
+   int* mis_vec;               // vector where for each position is stored whether a mismatch is allowed or not
+
+   // local search
+   int* BP_Precursors;         // precursor for each BP (ML,EL have more than one, this is not stored here, instead set to -1)
+   int* BP_Successors;         // successor for each BP
+   double** Ediff;             // energy diffence that arises if a free base or a BP is changed
+   double* av_Ediff;           // average energy difference if a free base or a BP is changed
+   double* max_Ediff;          // maximal energy difference if a free base or a BP is changed
+   char* Ediff_seq;            // whole sequence Ediff refers to, only the rows of the loops where it changes are recomputed
+   bool* Ediff_valid;          // is true, if the row of a pos. in Ediff and av_Ediff refers to Ediff_seq
+   bool* Ediff_mark;           // candidate positions during the ranking
+   PosEnergy* Ediff_rank;      // candidate positions during the ranking, sorted by av_Ediff
+   int* Enclosing;             // opening pos. of the innermost BP enclosing a pos. (struct_len = external loop)
+   int* Loop_Start;            // rows of Ediff in a loop (identified by the opening pos. of its closing BP):
+   int* Loop_Members;          // Loop_Members[Loop_Start[l]..Loop_Start[l+1]-1]
+   int time_out;               // if a budget (deadline, evaluations, accepted steps) is exceeded: set to 1
+   double start_time;          // start of the current run of the local search (monotonic clock, seconds)
+   long evaluations;           // folded candidates during the current run
+   long accepted;              // accepted steps during the current run
+   long filtered;              // candidates deferred by the energy filter and not folded later during the current run
+   int fold_type;              // 0 = mfe, 1 = partition function
+   char backtrack_type;        // part of the structure that is folded ('F', 'C' or 'M'), given to Vienna's fold
+   double cost2;               // energy difference to the target, set by the cost functions
+   FoldEngine** engines;       // folding of the local search, one instance per thread (backend fold_engine), kept for all repeats
+   FoldEngine* folder;         // folding of the initial and the designed sequences (backend InfoRNAOptions.eval_engine)
+   unsigned short* rng;        // state of the random generator of the local search (erand48), Vienna's xsubi by default
+
+   // work space
+   char* scratch;              // arena of the work space of the local search, it is
+   size_t scratch_size;        // allocated once per design (alloc_Scratch) and used as a stack: Scratch_Alloc takes
+   size_t scratch_used;        // the next block, Scratch_Release(ctx, mark) gives back all blocks after mark = scratch_used
+};
+
+// best assignment of the predecessor vg of BP bp (vg-th enclosed BP, see LoopIndex) if bp is assigned to bp_assign
+inline signed char& TraceAssign(DesignContext* ctx, int bp, int bp_assign, int vg)
+{
+   return ctx->Trace[ctx->Trace_Start[bp] + 6*vg + bp_assign];
+}
+
+DesignContext* NewDesignContext();
+void FreeDesignContext(DesignContext* ctx);
+
+void* Scratch_Alloc(DesignContext* ctx, size_t size);
+void Scratch_Release(DesignContext* ctx, size_t mark);
+
+#endif   // _CONTEXT_
@@ -1,39 +1,119 @@
 #include "energy.h"
 
+EnergyTables energy_tables;
+EnthalpyTables energy_enthalpies;
+int energy_enthalpies_set = 0;
+double energy_temperature = 37.0;
+
+// the parameters of ./data (Turner 1999), only read by Set_Default_Energies
+namespace data_par
+{
+   #include "./data/stacking_energies.dat"
+   #include "./data/interior_loop_1_1_energies.dat"
+   #include "./data/interior_loop_1_2_energies.dat"
+   #include "./data/interior_loop_2_2_energies.dat"
+   #include "./data/loop_destabilizing_energies.dat"
+   #include "./data/single_base_stacking_energies.dat"
+   #include "./data/terminal_mismatch_hairpin.dat"
+   #include "./data/terminal_mismatch_interior.dat"
+   #include "./data/tetra_loops.dat"
+}
+
 /******************************************************
-tests, whether the end of a stack (stem) is reached
+sets the energy tables to the parameters of ./data,
+done when the program is loaded
 ******************************************************/
 
-bool StackEnd(int bp_pos)
+static bool Set_Default_Energies()
 {
-   bool end = false;
-   // if there exists a next BP
-   if (bp_pos+1 < numBP)
+   EnergyTables* E = &energy_tables;
+   const char* s;
+
+   memcpy(E->stacking_energies, data_par::stacking_energies, sizeof(E->stacking_energies));
+   memcpy(E->interior_loop_1_1_energy, data_par::interior_loop_1_1_energy, sizeof(E->interior_loop_1_1_energy));
+   memcpy(E->interior_loop_1_2_energy, data_par::interior_loop_1_2_energy, sizeof(E->interior_loop_1_2_energy));
+   memcpy(E->interior_loop_2_2_energy, data_par::interior_loop_2_2_energy, sizeof(E->interior_loop_2_2_energy));
+   memcpy(E->single_base_stacking_energy, data_par::single_base_stacking_energy, sizeof(E->single_base_stacking_energy));
+   memcpy(E->mismatch_energies_hairpin, data_par::mismatch_energies_hairpin, sizeof(E->mismatch_energies_hairpin));
+   memcpy(E->mismatch_energies_interior, data_par::mismatch_energies_interior, sizeof(E->mismatch_energies_interior));
+   memcpy(E->loop_destabilizing_energies, data_par::loop_destabilizing_energies, sizeof(E->loop_destabilizing_energies));
+
+   // boni of the tetraloops for all 4^6 hexamers (closing BP included)
+   memset(E->tetra_loop_table, 0, sizeof(E->tetra_loop_table));
+   for (int t=0; t<data_par::num_tetra_loops; t++)
    {
-      // if y(i+1) < x(i) or if (x(i+1),y(i+1)) closing BP of a ML
-      if ((BP_Order[bp_pos+1][1] < BP_Order[bp_pos][0]) || (BP_Order[bp_pos+1][3] != 0))
-         end = true;
+      s = data_par::tetra_loop_seqs[t];
+      E->tetra_loop_table[TETRA_INDEX(char2int_base(s[0]), char2int_base(s[1]), char2int_base(s[2]),
+                                      char2int_base(s[3]), char2int_base(s[4]), char2int_base(s[5]))] = data_par::tetra_loop_boni[t];
    }
-   else //if it is the last BP, it is the last BP in the stem as well
-      end = true;
 
-   return end;
+   E->terminalAU = 50;
+   E->ML_closing = 340;
+   E->ML_intern = 40;
+   E->ML_base = 0;
+   E->ninio = 50;
+   E->max_ninio = 300;
+   E->lxc = 100*1.75*RT;
+   return true;
 }
 
+bool energy_tables_set = Set_Default_Energies();
 
 /******************************************************
-A-U penalty at the end of a stem,
+loop destabilizing energy of a loop larger than 30 in
+addition to the one of size 30: lxc*ln(size/30) with
+lxc = 1.75*RT by default, truncated to dcal/mol as in
+Vienna
+******************************************************/
+
+int LoopExtrapolation(int size)
+{
+   return (int)(energy_tables.lxc*log((double)(size/30.0)));
+}
 
-HERE: test, whether the end of a stem is reached and if
-the BP is assigned to A-U or U-A or G-U or U-G,
-if so, then return: 0.5 otherwise: 0
+
+/******************************************************
+rescales the tables of 37 C to the given temperature
+as Vienna does: dG(T) = dH - (dH - dG(37))*T/T(37),
+entries without enthalpy are pure entropies, forbidden
+entries (MAX_ENERGY) stay forbidden
 ******************************************************/
 
-double Zero_or_StemEndAU(int bp_pos, int bp_assign)
+static inline int Scale(int dG, int dH, double tempf)
+{
+   if ((dG >= MAX_ENERGY) || (dH >= MAX_ENERGY))
+      return dG;
+   return (int)(dH - (dH - dG)*tempf);
+}
+
+static void Scale_Table(int* dG, const int* dH, int size, double tempf)
 {
-   if ((StackEnd(bp_pos)) && ((bp_assign==0) || (bp_assign==3) || (bp_assign==4) || (bp_assign==5)))
-      return terminalAU;
-   else
-      return 0.0;
+   for (int i=0; i<size; i++)
+      dG[i] = Scale(dG[i], (dH == NULL)? 0 : dH[i], tempf);
 }
 
+void Scale_Energies(double celsius)
+{
+   EnergyTables* E = &energy_tables;
+   const EnthalpyTables* H = &energy_enthalpies;
+   double tempf = (celsius+273.15)/(37.0+273.15);
+
+   Scale_Table(E->stacking_energies, H->stacking_energies, 256, tempf);
+   Scale_Table(E->mismatch_energies_hairpin, H->mismatch_energies_hairpin, 256, tempf);
+   Scale_Table(E->mismatch_energies_interior, H->mismatch_energies_interior, 256, tempf);
+   Scale_Table(E->single_base_stacking_energy, H->single_base_stacking_energy, 128, tempf);
+   Scale_Table(E->interior_loop_1_1_energy, H->interior_loop_1_1_energy, 576, tempf);
+   Scale_Table(E->interior_loop_1_2_energy, H->interior_loop_1_2_energy, 2304, tempf);
+   Scale_Table(E->interior_loop_2_2_energy, H->interior_loop_2_2_energy, 9216, tempf);
+   Scale_Table(E->tetra_loop_table, H->tetra_loop_table, 4096, tempf);
+   Scale_Table(E->loop_destabilizing_energies, NULL, 90, tempf);
+
+   E->terminalAU = Scale(E->terminalAU, H->terminalAU, tempf);
+   E->ML_closing = Scale(E->ML_closing, H->ML_closing, tempf);
+   E->ML_intern = Scale(E->ML_intern, H->ML_intern, tempf);
+   E->ML_base = Scale(E->ML_base, H->ML_base, tempf);
+   E->ninio = Scale(E->ninio, H->ninio, tempf);
+   E->lxc *= tempf;
+
+   energy_temperature = celsius;
+}
@@ -5,22 +5,94 @@
 #include "basics.h"
 #include "constraints.h"
 
-#include "./data/stacking_energies.dat"
-#include "./data/interior_loop_1_1_energies.dat"
-#include "./data/interior_loop_1_2_energies.dat"
-#include "./data/interior_loop_2_2_energies.dat"
-#include "./data/loop_destabilizing_energies.dat"
-#include "./data/single_base_stacking_energies.dat"
-#include "./data/terminal_mismatch_hairpin.dat"
-#include "./data/terminal_mismatch_interior.dat"
-
 using namespace std;
 
-const double terminalAU = 0.5;
-const double Ctriloop = 1.4;
-const double Gtriloop = -2.2;
+/**********************************************************************************
+*  The energy parameters (dcal/mol) in one block aligned to the cache lines, each *
+*  table in the index order of the loop energy functions (see ./data). The block  *
+*  holds the tables of ./data when the program is loaded, Load_Parameter_File     *
+*  (par_file.h) replaces them by the ones of a Vienna parameter file.             *
+**********************************************************************************/
+
+struct EnergyTables
+{
+   int interior_loop_2_2_energy[9216];
+   int tetra_loop_table[4096];          // boni of the tetraloops, indexed by TETRA_INDEX
+   int interior_loop_1_2_energy[2304];
+   int interior_loop_1_1_energy[576];
+   int stacking_energies[256];
+   int mismatch_energies_hairpin[256];
+   int mismatch_energies_interior[256];
+   int single_base_stacking_energy[128];
+   int loop_destabilizing_energies[90]; // 3 per loop size 1..30 (interior, bulge, hairpin)
+   int terminalAU;
+   int ML_closing;                      // multiloop: closing penalty,
+   int ML_intern;                       // penalty per stem
+   int ML_base;                         // and per free base
+   int ninio;                           // asymmetry of interior loops: ninio per base,
+   int max_ninio;                       // at most max_ninio
+   double lxc;                          // extrapolation of loops larger than 30
+} __attribute__((aligned(64)));
+
+extern EnergyTables energy_tables;
+
+/**********************************************************************************
+*  Enthalpies of the parameters with the same index order, only used to rescale   *
+*  the tables to another temperature (Scale_Energies). Loop sizes, lxc and        *
+*  max_ninio have no enthalpy, they are scaled as pure entropies (as in Vienna).  *
+**********************************************************************************/
+
+struct EnthalpyTables
+{
+   int interior_loop_2_2_energy[9216];
+   int tetra_loop_table[4096];
+   int interior_loop_1_2_energy[2304];
+   int interior_loop_1_1_energy[576];
+   int stacking_energies[256];
+   int mismatch_energies_hairpin[256];
+   int mismatch_energies_interior[256];
+   int single_base_stacking_energy[128];
+   int terminalAU;
+   int ML_closing;
+   int ML_intern;
+   int ML_base;
+   int ninio;
+};
+
+extern EnthalpyTables energy_enthalpies;
+extern int energy_enthalpies_set;   // 1, if energy_enthalpies holds the enthalpies of the current parameters
+extern double energy_temperature;   // temperature of energy_tables (C), 37 until Scale_Energies
+
+// the tables under their former names
+const int* const stacking_energies = energy_tables.stacking_energies;
+const int* const interior_loop_1_1_energy = energy_tables.interior_loop_1_1_energy;
+const int* const interior_loop_1_2_energy = energy_tables.interior_loop_1_2_energy;
+const int* const interior_loop_2_2_energy = energy_tables.interior_loop_2_2_energy;
+const int* const loop_destabilizing_energies = energy_tables.loop_destabilizing_energies;
+const int* const single_base_stacking_energy = energy_tables.single_base_stacking_energy;
+const int* const mismatch_energies_hairpin = energy_tables.mismatch_energies_hairpin;
+const int* const mismatch_energies_interior = energy_tables.mismatch_energies_interior;
+const int* const tetra_loop_table = energy_tables.tetra_loop_table;
+
+const int Ctriloop = 140;
+const int Gtriloop = -220;
+
+// tests, whether the end of a stack (stem) is reached
+inline bool StackEnd(DesignContext* ctx, int bp_pos)
+{
+   return ctx->loops->stem_end[bp_pos];
+}
+
+// A-U penalty at the end of a stem (A-U, U-A, G-U or U-G)
+inline int Zero_or_StemEndAU(DesignContext* ctx, int bp_pos, int bp_assign)
+{
+   if ((ctx->loops->stem_end[bp_pos]) && ((bp_assign==0) || (bp_assign==3) || (bp_assign==4) || (bp_assign==5)))
+      return energy_tables.terminalAU;
+   else
+      return 0;
+}
 
-bool StackEnd(int bp_pos);
-double Zero_or_StemEndAU(int bp_pos, int bp_assign);
+int LoopExtrapolation(int size);
+void Scale_Energies(double celsius);
 
 #endif   // _ENERGY_
@@ -0,0 +1,347 @@
+
+#include "fold_engine.h"
+#include "basics.h"
+#include "native_fold.h"
+
+/**********************************************************************************
+*  Vienna 1.x: the matrices and parameters are globals, all calls are serialized  *
+*  and the instances share the matrices (allocated for the longest sequence)      *
+**********************************************************************************/
+
+static int fold_len = 0;   // length the matrices of Vienna's fold are allocated for
+
+static void* vienna_alloc(int max_len, int threads)
+{
+   #pragma omp critical(vienna)
+   {
+      if (max_len > fold_len)
+      {
+         if (fold_len > 0)
+            free_arrays();
+         initialize_fold(max_len);
+         fold_len = max_len;
+      }
+   }
+   return NULL;
+}
+
+static void vienna_free(void* state)
+{
+   // the matrices are kept for the next design (vienna_cleanup)
+}
+
+static double vienna_fold(void* state, const char* seq, char* structure, char backtrack)
+{
+   double energy;
+
+   #pragma omp critical(vienna)
+   {
+      backtrack_type = backtrack;
+      energy = fold((char*) seq, structure);
+   }
+   return energy;
+}
+
+static void vienna_accept(void* state, const char* seq)
+{
+}
+
+static double vienna_energy_of_struct(void* state, const char* seq, const char* structure)
+{
+   double energy;
+
+   #pragma omp critical(vienna)
+   energy = energy_of_struct((char*) seq, (char*) structure);
+   return energy;
+}
+
+static int vienna_bp_distance(void* state, const char* str1, const char* str2)
+{
+   int distance;
+
+   #pragma omp critical(vienna)
+   distance = bp_distance((char*) str1, (char*) str2);
+   return distance;
+}
+
+// the matrices of pf_fold and its scaling factor are set up by the caller (init_pf_fold)
+static double vienna_pf_fold(void* state, const char* seq, char* structure)
+{
+   double energy;
+
+   #pragma omp critical(vienna)
+   energy = pf_fold((char*) seq, structure);
+   return energy;
+}
+
+static void vienna_params_changed()
+{
+   #pragma omp critical(vienna)
+   {
+      if (fold_len > 0)
+         update_fold_params();
+   }
+}
+
+static void vienna_cleanup()
+{
+   #pragma omp critical(vienna)
+   {
+      if (fold_len > 0)
+         free_arrays();
+      fold_len = 0;
+   }
+}
+
+static const FoldBackend vienna_backend =
+{
+   "vienna", false, false,
+   vienna_alloc, vienna_free, vienna_fold, vienna_fold, vienna_accept,
+   vienna_energy_of_struct, vienna_bp_distance, vienna_pf_fold,
+   vienna_params_changed, vienna_cleanup
+};
+
+
+/**********************************************************************************
+*  native incremental fold, reentrant: each instance has its own matrices         *
+**********************************************************************************/
+
+static void* native_alloc(int max_len, int threads)
+{
+   return native_fold_alloc(max_len, threads);
+}
+
+static void native_free(void* state)
+{
+   native_fold_free((NativeFold*) state);
+}
+
+static double native_fold(void* state, const char* seq, char* structure, char backtrack)
+{
+   return native_fold_init((NativeFold*) state, seq, structure, backtrack)/100.;
+}
+
+static double native_eval(void* state, const char* seq, char* structure, char backtrack)
+{
+   return native_fold_eval((NativeFold*) state, seq, structure, backtrack)/100.;
+}
+
+static void native_accept(void* state, const char* seq)
+{
+   native_fold_accept((NativeFold*) state, seq);
+}
+
+static double native_energy(void* state, const char* seq, const char* structure)
+{
+   return native_energy_of_struct((NativeFold*) state, seq, structure)/100.;
+}
+
+static int native_distance(void* state, const char* str1, const char* str2)
+{
+   return native_bp_distance((NativeFold*) state, str1, str2);
+}
+
+static void native_cleanup()
+{
+}
+
+static const FoldBackend native_backend =
+{
+   "native", true, true,
+   native_alloc, native_free, native_fold, native_eval, native_accept,
+   native_energy, native_distance, NULL,
+   native_fold_params_changed, native_cleanup
+};
+
+
+#ifdef INFORNA_VIENNA2
+
+/**********************************************************************************
+*  Vienna 2.x (make VIENNA_VERSION=2, 2.4 or newer): each instance keeps a fold   *
+*  compound for its last sequence, each other candidate gets a new one (writing  *
+*  a candidate into the compound in place would have to update all the data      *
+*  Vienna derives from the sequence, that isn't verified against a 2.x build).   *
+*  The model (temperature, dangles, parameters) is taken from Vienna's globals   *
+*  when the compound is made.                                                    *
+**********************************************************************************/
+
+extern "C" {
+   #include <ViennaRNA/fold_compound.h>
+   #include <ViennaRNA/model.h>
+   #include <ViennaRNA/mfe.h>
+   #include <ViennaRNA/part_func.h>
+   #include <ViennaRNA/eval.h>
+   #include <ViennaRNA/params/basic.h>
+   #include <ViennaRNA/utils/structures.h>
+}
+
+struct Vienna2Fold
+{
+   vrna_fold_compound_t* fc;   // NULL before the first sequence
+   vrna_md_t md;
+   unsigned int options;       // VRNA_OPTION_MFE, VRNA_OPTION_PF
+   int generation;             // vienna2_generation the compound was made for
+};
+
+static int vienna2_generation = 0;   // incremented when the parameters change
+
+static void* vienna2_alloc(int max_len, int threads)
+{
+   Vienna2Fold* v = (Vienna2Fold*) calloc(1, sizeof(Vienna2Fold));
+
+   if (v == NULL)
+   {
+      cerr << "Not enough memory for the folding!\n";
+      exit(1);
+   }
+   return v;
+}
+
+static void vienna2_free(void* state)
+{
+   Vienna2Fold* v = (Vienna2Fold*) state;
+
+   if (v->fc != NULL)
+      vrna_fold_compound_free(v->fc);
+   free(v);
+}
+
+// new compound for seq
+static void vienna2_compound(Vienna2Fold* v, const char* seq, unsigned int options)
+{
+   #pragma omp critical(vienna)
+   {
+      set_model_details(&v->md);
+      v->generation = vienna2_generation;
+   }
+   v->options = options;
+   if (v->fc != NULL)
+      vrna_fold_compound_free(v->fc);
+   v->fc = vrna_fold_compound(seq, &v->md, options);
+}
+
+// makes seq the sequence of the compound, the compound is kept only for the same sequence
+// (e.g. the energy of a structure after the fold) with the same parameters and dangles
+static void vienna2_sequence(Vienna2Fold* v, const char* seq, unsigned int options)
+{
+   if ((v->fc != NULL) && (v->generation == vienna2_generation) && (v->md.dangles == dangles) &&
+       ((options & ~v->options) == 0) && (strcmp(v->fc->sequence, seq) == 0))
+      return;
+   vienna2_compound(v, seq, options | v->options);
+}
+
+static double vienna2_fold(void* state, const char* seq, char* structure, char backtrack)
+{
+   Vienna2Fold* v = (Vienna2Fold*) state;
+
+   vienna2_sequence(v, seq, VRNA_OPTION_MFE);
+   v->fc->params->model_details.backtrack_type = backtrack;
+   return vrna_mfe(v->fc, structure);
+}
+
+static void vienna2_accept(void* state, const char* seq)
+{
+}
+
+static double vienna2_energy_of_struct(void* state, const char* seq, const char* structure)
+{
+   Vienna2Fold* v = (Vienna2Fold*) state;
+
+   vienna2_sequence(v, seq, VRNA_OPTION_MFE);
+   return vrna_eval_structure(v->fc, structure);
+}
+
+static int vienna2_bp_distance(void* state, const char* str1, const char* str2)
+{
+   return vrna_bp_distance(str1, str2);
+}
+
+// the scaling factor is taken from the mfe of the candidate
+static double vienna2_pf_fold(void* state, const char* seq, char* structure)
+{
+   Vienna2Fold* v = (Vienna2Fold*) state;
+   double mfe;
+
+   vienna2_sequence(v, seq, VRNA_OPTION_MFE | VRNA_OPTION_PF);
+   v->fc->params->model_details.backtrack_type = 'F';
+   mfe = vrna_mfe(v->fc, NULL);
+   vrna_exp_params_rescale(v->fc, &mfe);
+   return vrna_pf(v->fc, structure);
+}
+
+static void vienna2_params_changed()
+{
+   #pragma omp critical(vienna)
+   vienna2_generation++;
+}
+
+static void vienna2_cleanup()
+{
+}
+
+static const FoldBackend vienna2_backend =
+{
+   "vienna2", true, false,
+   vienna2_alloc, vienna2_free, vienna2_fold, vienna2_fold, vienna2_accept,
+   vienna2_energy_of_struct, vienna2_bp_distance, vienna2_pf_fold,
+   vienna2_params_changed, vienna2_cleanup
+};
+
+#endif
+
+
+/*********************************************************/
+
+#ifdef INFORNA_VIENNA2
+static const FoldBackend* backends[FOLD_BACKENDS+1] = { NULL, &vienna_backend, &native_backend, &vienna2_backend };
+#else
+static const FoldBackend* backends[FOLD_BACKENDS+1] = { NULL, &vienna_backend, &native_backend, NULL };
+#endif
+
+const FoldBackend* fold_backend(int id)
+{
+   if ((id < 1) || (id > FOLD_BACKENDS))
+      return NULL;
+   return backends[id];
+}
+
+
+FoldEngine* fold_engine_alloc(int backend, int max_len, int threads)
+{
+   FoldEngine* fe = (FoldEngine*) malloc(sizeof(FoldEngine));
+
+   if (fe == NULL)
+   {
+      cerr << "Not enough memory for the folding!\n";
+      exit(1);
+   }
+   fe->backend = fold_backend(backend);
+   fe->max_len = max_len;
+   fe->state = fe->backend->alloc(max_len, threads);
+   return fe;
+}
+
+
+void fold_engine_free(FoldEngine* fe)
+{
+   if (fe == NULL)
+      return;
+   fe->backend->free(fe->state);
+   free(fe);
+}
+
+
+void fold_backends_params_changed()
+{
+   for (int id=1; id<=FOLD_BACKENDS; id++)
+      if (backends[id] != NULL)
+         backends[id]->params_changed();
+}
+
+
+void fold_backends_cleanup()
+{
+   for (int id=1; id<=FOLD_BACKENDS; id++)
+      if (backends[id] != NULL)
+         backends[id]->cleanup();
+}
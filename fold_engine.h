@@ -0,0 +1,92 @@
+#ifndef _FOLD_ENGINE__
+#define _FOLD_ENGINE__
+
+#include <stdlib.h>
+
+using namespace std;
+
+/**********************************************************************************
+*  Folding backends of the local search and of the evaluation of the designed    *
+*  sequences. A backend is a table of functions, each FoldEngine is one instance *
+*  with its own state (matrices), the search keeps one per thread. Energies are  *
+*  given in kcal/mol.                                                             *
+*  fold folds a sequence completely, eval a candidate that differs from the last *
+*  folded or accepted sequence of the instance in a few positions (incremental   *
+*  backends only recompute what depends on them, the others fold it completely). *
+**********************************************************************************/
+
+enum FoldBackendId
+{
+   FOLD_VIENNA = 1,     // fold() of the Vienna package 1.x (default)
+   FOLD_NATIVE = 2,     // native incremental fold (native_fold.h)
+   FOLD_VIENNA2 = 3,    // fold compounds of the Vienna package 2.x (only with INFORNA_VIENNA2)
+   FOLD_BACKENDS = 3    // highest id
+};
+
+struct FoldBackend
+{
+   const char* name;
+   bool thread_safe;    // instances may fold at the same time (else the calls are serialized)
+   bool incremental;    // eval reuses the matrices of the current sequence (set by fold and accept)
+
+   void* (*alloc)(int max_len, int threads);   // threads folding one sequence (if the backend can)
+   void (*free)(void* state);
+   double (*fold)(void* state, const char* seq, char* structure, char backtrack);
+   double (*eval)(void* state, const char* seq, char* structure, char backtrack);
+   void (*accept)(void* state, const char* seq);
+   double (*energy_of_struct)(void* state, const char* seq, const char* structure);
+   int (*bp_distance)(void* state, const char* str1, const char* str2);
+   double (*pf_fold)(void* state, const char* seq, char* structure);   // NULL if not supported
+   void (*params_changed)();   // the energy parameters or the temperature were changed
+   void (*cleanup)();          // frees what the backend keeps beyond its instances
+};
+
+struct FoldEngine
+{
+   const FoldBackend* backend;
+   void* state;
+   int max_len;
+};
+
+// the backend with the given id, NULL if it doesn't exist or isn't compiled in
+const FoldBackend* fold_backend(int id);
+
+FoldEngine* fold_engine_alloc(int backend, int max_len, int threads);
+void fold_engine_free(FoldEngine* fe);
+
+// structure may be NULL for incremental backends (the matrices are kept, no traceback)
+inline double fold_engine_fold(FoldEngine* fe, const char* seq, char* structure, char backtrack)
+{
+   return fe->backend->fold(fe->state, seq, structure, backtrack);
+}
+
+inline double fold_engine_eval(FoldEngine* fe, const char* seq, char* structure, char backtrack)
+{
+   return fe->backend->eval(fe->state, seq, structure, backtrack);
+}
+
+inline void fold_engine_accept(FoldEngine* fe, const char* seq)
+{
+   fe->backend->accept(fe->state, seq);
+}
+
+inline double fold_engine_energy(FoldEngine* fe, const char* seq, const char* structure)
+{
+   return fe->backend->energy_of_struct(fe->state, seq, structure);
+}
+
+inline int fold_engine_distance(FoldEngine* fe, const char* str1, const char* str2)
+{
+   return fe->backend->bp_distance(fe->state, str1, str2);
+}
+
+inline double fold_engine_pf(FoldEngine* fe, const char* seq, char* structure)
+{
+   return fe->backend->pf_fold(fe->state, seq, structure);
+}
+
+// all backends: new parameters (after the tables of energy.h and Vienna's globals are set) and cleanup
+void fold_backends_params_changed();
+void fold_backends_cleanup();
+
+#endif   // _FOLD_ENGINE_
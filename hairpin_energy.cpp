@@ -1,6 +1,7 @@
 
 
 #include "hairpin_energy.h"
+#include "loop_memo.h"
 
 
 
@@ -9,45 +10,10 @@
 identifies the energy boni for special tetra loops
 ******************************************************/
 
-double tetra_loop_energy(char* str)
+int tetra_loop_energy(int index)
 {
-   double energy = 0.0;
-
-   //              Seq              Energy
-   // --------------------------------------
-   if      (strcmp(str,"GGGGAC") == 0) energy =  -3.00 ;
-   else if (strcmp(str,"GGUGAC") == 0) energy =  -3.00 ;
-   else if (strcmp(str,"CGAAAG") == 0) energy =  -3.00 ;
-   else if (strcmp(str,"GGAGAC") == 0) energy =  -3.00 ;
-   else if (strcmp(str,"CGCAAG") == 0) energy =  -3.00 ;
-   else if (strcmp(str,"GGAAAC") == 0) energy =  -3.00 ;
-   else if (strcmp(str,"CGGAAG") == 0) energy =  -3.00 ;
-   else if (strcmp(str,"CUUCGG") == 0) energy =  -3.00 ;
-   else if (strcmp(str,"CGUGAG") == 0) energy =  -3.00 ;
-   else if (strcmp(str,"CGAAGG") == 0) energy =  -2.50 ;
-   else if (strcmp(str,"CUACGG") == 0) energy =  -2.50 ;
-   else if (strcmp(str,"GGCAAC") == 0) energy =  -2.50 ;
-   else if (strcmp(str,"CGCGAG") == 0) energy =  -2.50 ;
-   else if (strcmp(str,"UGAGAG") == 0) energy =  -2.50 ;
-   else if (strcmp(str,"CGAGAG") == 0) energy =  -2.00 ;
-   else if (strcmp(str,"AGAAAU") == 0) energy =  -2.00 ;
-   else if (strcmp(str,"CGUAAG") == 0) energy =  -2.00 ;
-   else if (strcmp(str,"CUAACG") == 0) energy =  -2.00 ;
-   else if (strcmp(str,"UGAAAG") == 0) energy =  -2.00 ;
-   else if (strcmp(str,"GGAAGC") == 0) energy =  -1.50 ;
-   else if (strcmp(str,"GGGAAC") == 0) energy =  -1.50 ;
-   else if (strcmp(str,"UGAAAA") == 0) energy =  -1.50 ;
-   else if (strcmp(str,"AGCAAU") == 0) energy =  -1.50 ;
-   else if (strcmp(str,"AGUAAU") == 0) energy =  -1.50 ;
-   else if (strcmp(str,"CGGGAG") == 0) energy =  -1.50 ;
-   else if (strcmp(str,"AGUGAU") == 0) energy =  -1.50 ;
-   else if (strcmp(str,"GGCGAC") == 0) energy =  -1.50 ;
-   else if (strcmp(str,"GGGAGC") == 0) energy =  -1.50 ;
-   else if (strcmp(str,"GUGAAC") == 0) energy =  -1.50 ;
-   else if (strcmp(str,"UGGAAA") == 0) energy =  -1.50 ;
-
-   return energy;
-};
+   return tetra_loop_table[index];
+}
 
 
 
@@ -57,34 +23,34 @@ finds best boni for tetraloops depending on the closing BP + the
 first mismatch
      ==> fct. is not longer used when dealing with seq. constraints
 *******************************************************************/
-double best_tetra_loop_energy(int bp_i, int bp_j, int i, int j)
+int best_tetra_loop_energy(int bp_i, int bp_j, int i, int j)
 {
-   double best_energy = 0.0;
+   int best_energy = 0;
 
    if ((bp_i == 0) && (bp_j == 3))
    {
-      if ((i==2) && (j==0)) best_energy = -2.00;
+      if ((i==2) && (j==0)) best_energy = -200;
    }
    else if ((bp_i == 1) && (bp_j == 2))
    {
-      if ((i==2) && (j==0)) best_energy = -3.00;
-      else if ((i==2) && (j==2)) best_energy = -2.5;
-      else if ((i==3) && (j==1)) best_energy = -2.0;
-      else if ((i==3) && (j==2)) best_energy = -3.0;
+      if ((i==2) && (j==0)) best_energy = -300;
+      else if ((i==2) && (j==2)) best_energy = -250;
+      else if ((i==3) && (j==1)) best_energy = -200;
+      else if ((i==3) && (j==2)) best_energy = -300;
    }
    else if ((bp_i == 2) && (bp_j == 1))
    {
-      if ((i==2) && (j==0)) best_energy = -3.00;
-      else if ((i==2) && (j==2)) best_energy = -1.5;
-      else if ((i==3) && (j==0)) best_energy = -1.5;
+      if ((i==2) && (j==0)) best_energy = -300;
+      else if ((i==2) && (j==2)) best_energy = -150;
+      else if ((i==3) && (j==0)) best_energy = -150;
    }
    else if ((bp_i == 3) && (bp_j == 0))
    {
-      if ((i==2) && (j==0)) best_energy = -1.50;
+      if ((i==2) && (j==0)) best_energy = -150;
    }
    else if ((bp_i == 3) && (bp_j == 2))
    {
-      if ((i==2) && (j==0)) best_energy = -2.50;
+      if ((i==2) && (j==0)) best_energy = -250;
    }
 
    return best_energy;
@@ -97,14 +63,14 @@ size and given closing BP
 
 *************************************************************/
 
-double BestHairpinLoopEnergy(int bp_pos, int size, int bp_i, int bp_j)
+int BestHairpinLoopEnergy(DesignContext* ctx, int bp_pos, int size, int bp_i, int bp_j)
 {
-   double energy = 0.0;
-   double min = MAX_DOUBLE;
-   double energy_help;
+   int energy = 0;
+   int min = MAX_ENERGY;
+   int energy_help;
 
-   int bp_pos_i = BP_Order[bp_pos][0];
-   int bp_pos_j = BP_Order[bp_pos][1];
+   int bp_pos_i = ctx->BP_Order[bp_pos][0];
+   int bp_pos_j = ctx->BP_Order[bp_pos][1];
 
    // loop_destabilizing_energies
    //****************************
@@ -113,7 +79,7 @@ double BestHairpinLoopEnergy(int bp_pos, int size, int bp_i, int bp_j)
    else
    {
       energy += loop_destabilizing_energies[3*30-1];
-      energy += 1.75*RT*log((double)(size/30.0));
+      energy += LoopExtrapolation(size);
    }
 
    // terminal mismatch (size > 3)
@@ -138,7 +104,7 @@ double BestHairpinLoopEnergy(int bp_pos, int size, int bp_i, int bp_j)
       //    }
 
       // if (onlyCs)
-      //    energy = Sum_MaxDouble(energy,0.3*size+1.6);
+      //    energy = Sum_MaxEnergy(energy,0.3*size+1.6);
 
       if (size != 4)
       {
@@ -147,76 +113,97 @@ double BestHairpinLoopEnergy(int bp_pos, int size, int bp_i, int bp_j)
          // are not fixed until the traceback, their penalty is also considered there
          // (since at least one base has to be valid for each position, the exact
          // assignment has not to be fixed here)
-         min = MAX_DOUBLE;
-         for (int i=0; i<4; i++)
-            for (int j=0; j<4; j++)
-            {
-               energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+1,i), BasePenalty(bp_pos_j-1,j), mismatch_energies_hairpin[64*bp_i+16*i+4*bp_j+j]);
-               if (energy_help < min)
-                  min = energy_help;
-            }
-         energy = Sum_MaxDouble(energy,min);
+         // (the minimum is taken from the memo table, if it is already known)
+         int* memo = LoopMemo(MEMO_HAIRPIN);
+         int key = (BP2int(bp_i, bp_j)*16 + AllowedMask(ctx, bp_pos_i+1))*16 + AllowedMask(ctx, bp_pos_j-1);
+
+         min = Memo_Get(memo, key);
+         if (min == MEMO_UNSET)
+         {
+            const int* pen_i = BasePenalties(ctx, bp_pos_i+1);
+            const int* pen_j = BasePenalties(ctx, bp_pos_j-1);
+
+            min = MAX_ENERGY;
+            for (int i=0; i<4; i++)
+               for (int j=0; j<4; j++)
+               {
+                  energy_help = Sum_MaxEnergy3(pen_i[i], pen_j[j], mismatch_energies_hairpin[64*bp_i+16*i+4*bp_j+j]);
+                  if (energy_help < min)
+                     min = energy_help;
+               }
+            Memo_Set(memo, key, min);
+         }
+         energy = Sum_MaxEnergy(energy,min);
       }
       else
       {
-         char* tetra_plus_closing;
-         tetra_plus_closing = (char*) malloc(sizeof(char)*6);
-         tetra_plus_closing[0] = int2char(bp_i);
-         tetra_plus_closing[5] = int2char(bp_j);
-
          // consider all cases of the tetraloop (4*4*4*4) and add term-mismatch and
          // possibly a bonus, furthermore add the penalties for all 4 bases
          //      i2   j2
          //   i           j
          //     bp_i-bp_j
          //       .   .
+         // (the minimum is taken from the memo table, if it is already known)
+         int* memo = LoopMemo(MEMO_TETRA_LOOP);
+         int key = (((BP2int(bp_i, bp_j)*16 + AllowedMask(ctx, bp_pos_i+1))*16 + AllowedMask(ctx, bp_pos_i+2))*16
+                    + AllowedMask(ctx, bp_pos_j-2))*16 + AllowedMask(ctx, bp_pos_j-1);
 
-         min = MAX_DOUBLE;
-         for (int i=0; i<4; i++)
-            for (int j=0; j<4; j++)
-               for (int i2=0; i2<4; i2++)
-                  for (int j2=0; j2<4; j2++)
-                  {
-                     energy_help = Sum_MaxDouble4(BasePenalty(bp_pos_i+1,i), BasePenalty(bp_pos_i+2,i2), BasePenalty(bp_pos_j-2,j2),BasePenalty(bp_pos_j-1,j));
-                     tetra_plus_closing[1] = int2char(i);
-                     tetra_plus_closing[2] = int2char(i2);
-                     tetra_plus_closing[3] = int2char(j2);
-                     tetra_plus_closing[4] = int2char(j);
-                     energy_help = Sum_MaxDouble3(energy_help, tetra_loop_energy(tetra_plus_closing), mismatch_energies_hairpin[64*bp_i+16*i+4*bp_j+j]);
-
-                     if (energy_help < min)
-                        min = energy_help;
-                  }
-         energy = Sum_MaxDouble(energy,min);
-         free(tetra_plus_closing);
+         min = Memo_Get(memo, key);
+         if (min == MEMO_UNSET)
+         {
+            const int* pen[4];  // penalties of the 4 loop bases (i, i2, j2, j)
+            pen[0] = BasePenalties(ctx, bp_pos_i+1);
+            pen[1] = BasePenalties(ctx, bp_pos_i+2);
+            pen[2] = BasePenalties(ctx, bp_pos_j-2);
+            pen[3] = BasePenalties(ctx, bp_pos_j-1);
+
+            min = MAX_ENERGY;
+            for (int i=0; i<4; i++)
+               for (int j=0; j<4; j++)
+                  for (int i2=0; i2<4; i2++)
+                     for (int j2=0; j2<4; j2++)
+                     {
+                        energy_help = Sum_MaxEnergy4(pen[0][i], pen[1][i2], pen[2][j2], pen[3][j]);
+                        energy_help = Sum_MaxEnergy3(energy_help, tetra_loop_table[TETRA_INDEX(bp_i,i,i2,j2,j,bp_j)], mismatch_energies_hairpin[64*bp_i+16*i+4*bp_j+j]);
+
+                        if (energy_help < min)
+                           min = energy_help;
+                     }
+            Memo_Set(memo, key, min);
+         }
+         energy = Sum_MaxEnergy(energy,min);
       }
    }
    else if (size == 3)
    {
-      min = MAX_DOUBLE;
+      const int* pen_i = BasePenalties(ctx, bp_pos_i+1);
+      const int* pen_i2 = BasePenalties(ctx, bp_pos_i+2);
+      const int* pen_j = BasePenalties(ctx, bp_pos_j-1);
+
+      min = MAX_ENERGY;
       for (int i=0; i<4; i++)
          for (int j=0; j<4; j++)
             for (int i2=0; i2<4; i2++)
             {
-               energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+1,i), BasePenalty(bp_pos_i+2,i2), BasePenalty(bp_pos_j-1,j));
+               energy_help = Sum_MaxEnergy3(pen_i[i], pen_i2[i2], pen_j[j]);
 
                // If the HL would only consist of Cs, a penalty of 1.4 has to be added.
                // This is just the best solution, if all other bases are forbidden by the constraints.
                if ((i==1) && (i2==1) && (j==1))
-                  energy_help = Sum_MaxDouble(energy_help,Ctriloop);
+                  energy_help = Sum_MaxEnergy(energy_help,Ctriloop);
 
                // If the HL would only consist of Gs, a term of -2.2 has to be added.
                // This is not considered in the ViennaPackage, so do we
                //if ((i==2) && (i2==2) && (j==2))
-               //   energy_help = Sum_MaxDouble(energy_help,Gtriloop);
+               //   energy_help = Sum_MaxEnergy(energy_help,Gtriloop);
 
                if (energy_help < min)
                   min = energy_help;
             }
-      energy = Sum_MaxDouble(energy,min);
+      energy = Sum_MaxEnergy(energy,min);
 
       if (((bp_i==0) && (bp_j==3)) || ((bp_i==3) && (bp_j==0))|| ((bp_i==2) && (bp_j==3)) || ((bp_i==3) && (bp_j==2)))
-         energy = Sum_MaxDouble(energy,terminalAU);
+         energy = Sum_MaxEnergy(energy,energy_tables.terminalAU);
    }
    else
    {
@@ -237,11 +224,10 @@ the difference of two assignments of it
 
 *************************************************************/
 
-double HairpinLoopEnergy(int size, int pos_i, int* int_seq)
+int HairpinLoopEnergy(DesignContext* ctx, int size, int pos_i, int* int_seq)
 {
-   double energy = 0.0;
-   int i, k; // only_Cs;
-   char* tetra_loop_assign;
+   int energy = 0;
+   int i; // only_Cs;
    int pos_j = pos_i + size + 1;
 
    int bp_i = int_seq[pos_i];
@@ -249,7 +235,7 @@ double HairpinLoopEnergy(int size, int pos_i, int* int_seq)
    int mis_i = int_seq[pos_i+1];
    int mis_j = int_seq[pos_j-1];
 
-   double energy_help = 0.0;
+   int energy_help = 0;
 
    // loop_destabilizing_energies (not necessary here, since this function is
    // just used for the difference of two assignments of the same HL)
@@ -259,7 +245,7 @@ double HairpinLoopEnergy(int size, int pos_i, int* int_seq)
    else
    {
       energy += loop_destabilizing_energies[3*30-1];
-      energy += 1.75*RT*log((double)(size/30.0));
+      energy += LoopExtrapolation(size);
    }*/
 
 
@@ -282,36 +268,33 @@ double HairpinLoopEnergy(int size, int pos_i, int* int_seq)
       //**************************************************************
 
       //penalties for all bases of the loop
-      energy_help = 0.0;
+      energy_help = 0;
       for (i=1; i<=size; i++)
-         energy_help = Sum_MaxDouble(energy_help,BasePenalty(pos_i+i,int_seq[pos_i+i]));
+         energy_help = Sum_MaxEnergy(energy_help,BasePenalty(ctx, pos_i+i,int_seq[pos_i+i]));
 
       // terminal-mismatch energy for the closing BP and its penalty
-      energy = Sum_MaxDouble4(energy, energy_help, mismatch_energies_hairpin[64*bp_i+16*mis_i+4*bp_j+mis_j], PairPenalty(pos_i,pos_j,bp_i,bp_j));
+      energy = Sum_MaxEnergy4(energy, energy_help, mismatch_energies_hairpin[64*bp_i+16*mis_i+4*bp_j+mis_j], PairPenalty(ctx, pos_i,pos_j,bp_i,bp_j));
 
       if (size == 4)
       {
          /*for tetraloops, consider a special term*/
-         tetra_loop_assign = (char*) malloc(sizeof(char)*7);
-         for (k=0; k<6; k++)
-            tetra_loop_assign[k] = int2char(int_seq[pos_i+k]);
-         tetra_loop_assign[6] = '\0';
-         energy = Sum_MaxDouble(energy,tetra_loop_energy(tetra_loop_assign));
+         energy = Sum_MaxEnergy(energy,tetra_loop_table[TETRA_INDEX(int_seq[pos_i], int_seq[pos_i+1], int_seq[pos_i+2],
+                                                                    int_seq[pos_i+3], int_seq[pos_i+4], int_seq[pos_i+5])]);
       }
    }
    else if (size == 3)
    {
-      energy_help = Sum_MaxDouble3(BasePenalty(pos_i+1,mis_i), BasePenalty(pos_i+2,int_seq[pos_i+2]), BasePenalty(pos_j-1,mis_j));
-      energy = Sum_MaxDouble3(energy, energy_help, PairPenalty(pos_i,pos_j,bp_i,bp_j));
+      energy_help = Sum_MaxEnergy3(BasePenalty(ctx, pos_i+1,mis_i), BasePenalty(ctx, pos_i+2,int_seq[pos_i+2]), BasePenalty(ctx, pos_j-1,mis_j));
+      energy = Sum_MaxEnergy3(energy, energy_help, PairPenalty(ctx, pos_i,pos_j,bp_i,bp_j));
 
       if (((bp_i==0) && (bp_j==3)) || ((bp_i==3) && (bp_j==0)) || ((bp_i==2) && (bp_j==3)) || ((bp_i==3) && (bp_j==2)))
-         energy = Sum_MaxDouble(energy,terminalAU);
+         energy = Sum_MaxEnergy(energy,energy_tables.terminalAU);
       // If the HL would only consist of Cs, a penalty of 1.4 has to be added.
       if ((int_seq[pos_i+1] == 1) && (int_seq[pos_i+2] == 1) && (int_seq[pos_i+3] == 1))
-         energy = Sum_MaxDouble(energy,Ctriloop);
+         energy = Sum_MaxEnergy(energy,Ctriloop);
       // If the HL would only consist of Gs, a term of -2.2 has to be added. This is not considered in the ViennaPackage, so do we
       //if ((int_seq[pos_i+1] == 2) && (int_seq[pos_i+2] == 2) && (int_seq[pos_i+3] == 2))
-      //   energy = Sum_MaxDouble(energy,Gtriloop);
+      //   energy = Sum_MaxEnergy(energy,Gtriloop);
    }
    else
    {
@@ -320,7 +303,7 @@ double HairpinLoopEnergy(int size, int pos_i, int* int_seq)
    }
 
    //if closingHL the last BP in a stack
-   energy = Sum_MaxDouble(energy, Zero_or_StemEndAU(BP_Pos_Nr[pos_i], BP2int(bp_i,bp_j)));
+   energy = Sum_MaxEnergy(energy, Zero_or_StemEndAU(ctx, ctx->BP_Pos_Nr[pos_i], BP2int(bp_i,bp_j)));
 
    return energy;
 }
@@ -7,10 +7,13 @@
 
 using namespace std;
 
-double tetra_loop_energy(char* str);
-double best_tetra_loop_energy(int bp_i, int bp_j, int i, int j);
-double BestHairpinLoopEnergy(int bp_pos, int size, int bp_i, int bp_j);
-double HairpinLoopEnergy(int size, int pos_i, int* int_seq);
+// index of a hexamer (bases as integers, the first one is the most significant) in the table of the tetra loops
+#define TETRA_INDEX(b0,b1,b2,b3,b4,b5) (((b0)<<10) | ((b1)<<8) | ((b2)<<6) | ((b3)<<4) | ((b4)<<2) | (b5))
+
+int tetra_loop_energy(int index);
+int best_tetra_loop_energy(int bp_i, int bp_j, int i, int j);
+int BestHairpinLoopEnergy(DesignContext* ctx, int bp_pos, int size, int bp_i, int bp_j);
+int HairpinLoopEnergy(DesignContext* ctx, int size, int pos_i, int* int_seq);
 
 #endif   // _HAIRPIN_ENERGY_
 
@@ -0,0 +1,547 @@
+
+#include "basics.h"
+#include "constraints.h"
+#include "struct.h"
+#include "inverse.h"
+#include "search.h"
+#include "loop_memo.h"
+#include "par_file.h"
+#include "inforna.h"
+
+using namespace std;
+
+
+/**********************************************************************************
+*                               options                                           *
+**********************************************************************************/
+
+void inforna_default_options(InfoRNAOptions* opt)
+{
+   opt->random_init = 0;
+   opt->free_bases_set2A = 0;
+   opt->free_bases_set2C = 0;
+   opt->free_bases_set2G = 0;
+   opt->free_bases_set2U = 0;
+   opt->search_strategy = 1;
+   opt->neighbour_choice = 1;
+   opt->only_mutation_is_step = 0;
+   opt->step_multiplier = 10;
+   opt->p_accept = 0.1;
+   opt->fold_engine = 1;
+   opt->eval_engine = 1;
+   opt->num_threads = 1;
+   opt->fold_threads = 1;
+   opt->time_limit = 3600;
+   opt->max_evaluations = 0;
+   opt->max_accepted = 0;
+   opt->energy_filter = -1;
+   opt->max_mis = -1;
+   opt->mfe = 1;
+   opt->pf = 0;
+   opt->repeat = 0;
+   opt->seed = 0;
+}
+
+
+int inforna_check_options(const InfoRNAOptions* opt)
+{
+   if ((opt->search_strategy > 3) || (opt->search_strategy < 1))
+   {
+      cerr << "\nThe search strategy is not valid.\n\n";
+      return 0;
+   }
+
+   if ((opt->neighbour_choice > 2) || (opt->neighbour_choice < 1))
+   {
+      cerr << "\nThe choice of the neighbours is not valid.\n\n";
+      return 0;
+   }
+
+   if ((fold_backend(opt->fold_engine) == NULL) || (fold_backend(opt->eval_engine) == NULL) || (opt->num_threads < 1) || (opt->fold_threads < 1))
+   {
+      cerr << "\nThe folding engine is not valid.\n\n";
+      return 0;
+   }
+
+   // another backend would judge the designs by another energy model, so it isn't switched
+   if ((opt->num_threads > 1) && !fold_backend(opt->fold_engine)->thread_safe)
+   {
+      cerr << "\nThe parallel search needs a thread-safe folding engine (-e 2 or 3).\n\n";
+      return 0;
+   }
+
+   if ((opt->time_limit < 0) || (opt->max_evaluations < 0) || (opt->max_accepted < 0))
+   {
+      cerr << "\nThe budget of the local search is not valid.\n\n";
+      return 0;
+   }
+   return 1;
+}
+
+
+/**********************************************************************************
+*   Checks the structure, the constraints and the allowed mismatches of a design  *
+*   and builds the tables of the structure. Returns 0 (after printing the reason) *
+*   if the input is not valid                                                     *
+**********************************************************************************/
+
+static int Prepare_Design(DesignContext* ctx, const char* mis_vec_char, bool constraints_given)
+{
+   //if no constraints are given, set to NNNNN.... :
+   //*********************************************************
+   if (ctx->iupac_const == NULL)
+   {
+      ctx->iupac_const = (char*) malloc(sizeof(char)*((int)strlen(ctx->brackets)+1));
+      for (int i=0; i<(int)strlen(ctx->brackets); i++)
+         ctx->iupac_const[i] = 'N';
+      ctx->iupac_const[(int)strlen(ctx->brackets)] = '\0';
+   }
+
+   //test, whether the structure is valid:
+   //***************************************
+   int correct = check_brackets(ctx->brackets);
+   ctx->numBP = NumOfBP(ctx->brackets);
+   ctx->struct_len = (int)strlen(ctx->brackets);
+
+   if (correct)
+   {
+      getOrder(ctx, ctx->brackets);
+      Pos2BP_Pos(ctx);
+   }
+   else
+   {
+      cerr << "\nNo valid structure!\n\n";
+      return 0;
+   }
+
+   //test, whether brackets and iupac_const have the same length
+   //*****************************************************************************
+   if (ctx->struct_len != (int)strlen(ctx->iupac_const))
+   {
+      cerr << "\nThe structure and the constraint vector must have the same length!\n\n";
+      return 0;
+   }
+
+   //store mismatch information in an integer vector and look for errors
+   //********************************************************************
+   ctx->mis_vec = (int*)malloc(sizeof(int)*ctx->struct_len);
+
+   //if no allowed mismatches are given, set mis_vec to "0" everywhere and max_mis to "0", too
+   if (mis_vec_char == NULL)
+   {
+      for (int i=0; i<ctx->struct_len; i++)
+         ctx->mis_vec[i] = 0;
+      ctx->max_mis = 0;
+   }
+   else
+   {
+      //test, whether brackets and mis_vec_char have the same length
+      if (ctx->struct_len != (int)strlen(mis_vec_char))
+      {
+         cerr << "\nThe structure and the mismatch vector must have the same length!\n\n";
+         return 0;
+      }
+
+      //if no constraints are given but allowed mismatches, ==> constraints are missing
+      if (constraints_given == false)
+      {
+         cerr << "\nAllowed mismatches make no sense without constraints!\n\n";
+         return 0;
+      }
+
+      //if some mismatches are allowed (conc. mis_vec_char) but the maximal number is not given or set to 0 => makes no sense
+      if (ctx->max_mis < 0)
+      {
+         cerr << "\nThe maximal number of mismatches is not given but a vector of allowed mismatch positions!\n\n";
+         return 0;
+      }
+
+      //set the integer vector
+      for (int i=0; i<(int)strlen(mis_vec_char); i++)
+      {
+         if (mis_vec_char[i] == '0')
+            ctx->mis_vec[i] = 0;
+         else if (mis_vec_char[i] == '1')
+            ctx->mis_vec[i] = 1;
+         else
+         {
+            cerr << endl << mis_vec_char[i] << " is not valid in the binary code for allowed mismatches!\n\n";
+            return 0;
+         }
+      }
+   }
+
+
+   //test, whether constraints are valid and create constraint array
+   //********************************************************************
+   int correct_iu = Check_iu(ctx);
+   int correct_bp = Check_constraints_bp(ctx);
+
+   if (correct_iu)
+   {
+      if (correct_bp)
+         getSeqConstraints(ctx);
+      else
+         return 0;
+   }
+   else
+   {
+      cerr << "\nNo valid IUPAC Code!\n\n";
+      return 0;
+   }
+   return 1;
+}
+
+
+/**********************************************************************************
+*   appends a solution to the result of the design                                *
+**********************************************************************************/
+
+static void Add_Solution(InfoRNADesign* design, int kind, char* string, char* structure, double energy, double distance, double probability)
+{
+   InfoRNAResult* res = &design->result;
+   InfoRNASolution* sol;
+
+   res->solutions = (InfoRNASolution*) realloc(res->solutions, sizeof(InfoRNASolution)*(res->num_solutions+1));
+   if (res->solutions == NULL)
+   {
+      cerr << "Not enough memory for the solutions!\n";
+      exit(1);
+   }
+   sol = &res->solutions[res->num_solutions++];
+
+   sol->kind = kind;
+   sol->sequence = strdup(string);
+   sol->hamming = hamming(design->rstart, string);
+   sol->energy = energy;
+   sol->mfe_structure = strdup(structure);
+   sol->distance = distance;
+   sol->probability = probability;
+   sol->mismatches = design->ctx->num_mis;
+   sol->budget_exceeded = design->ctx->time_out;
+   sol->evaluations = design->ctx->evaluations;
+   sol->filtered = design->ctx->filtered;
+   sol->accepted = design->ctx->accepted;
+}
+
+
+/**********************************************************************************
+*   Initializing step of a design: checks the input, designs the initial sequence *
+*   and prepares the local search. Returns NULL if the input is not valid         *
+**********************************************************************************/
+
+InfoRNADesign* inforna_prepare(const char* structure, const char* constraints, const char* allowed_mismatches, const InfoRNAOptions* opt)
+{
+   if (!inforna_check_options(opt))
+      return NULL;
+
+   InfoRNADesign* design = (InfoRNADesign*) calloc(1, sizeof(InfoRNADesign));
+   DesignContext* ctx = NewDesignContext();
+   design->ctx = ctx;
+   design->opt = *opt;
+
+   ctx->random_init = opt->random_init;
+   ctx->free_bases_set2A = opt->free_bases_set2A;
+   ctx->free_bases_set2C = opt->free_bases_set2C;
+   ctx->free_bases_set2G = opt->free_bases_set2G;
+   ctx->free_bases_set2U = opt->free_bases_set2U;
+   ctx->search_strategy = opt->search_strategy;
+   ctx->neighbour_choice = opt->neighbour_choice;
+   ctx->only_mutation_is_step = opt->only_mutation_is_step;
+   ctx->step_multiplier = opt->step_multiplier;
+   ctx->p_accept = opt->p_accept;
+   ctx->fold_engine = opt->fold_engine;
+   ctx->num_threads = opt->num_threads;
+   ctx->fold_threads = opt->fold_threads;
+   ctx->deadline = opt->time_limit;
+   ctx->max_evaluations = opt->max_evaluations;
+   ctx->max_accepted = opt->max_accepted;
+   ctx->energy_filter = opt->energy_filter;
+   ctx->max_mis = opt->max_mis;
+
+   design->result.structure = strdup(structure);
+   if (constraints != NULL)
+      design->result.constraints = strdup(constraints);
+   ctx->brackets = design->result.structure;
+   ctx->iupac_const = design->result.constraints;
+
+   if (!Prepare_Design(ctx, allowed_mismatches, (constraints != NULL)))
+   {
+      design->result.constraints = ctx->iupac_const;
+      inforna_free_design(design);
+      return NULL;
+   }
+   design->result.constraints = ctx->iupac_const;
+   design->result.allowed_mismatches = (char*) malloc(sizeof(char)*(ctx->struct_len+1));
+   for (int i=0; i<ctx->struct_len; i++)
+      design->result.allowed_mismatches[i] = (ctx->mis_vec[i] == 1)? '1' : '0';
+   design->result.allowed_mismatches[ctx->struct_len] = '\0';
+
+   #pragma omp critical(vienna)
+   {
+      do_backtrack = 0;
+      give_up = (opt->repeat<0);
+   }
+   ctx->folder = fold_engine_alloc(opt->eval_engine, ctx->struct_len, opt->fold_threads);
+
+   //Random generator of the design:
+   //*******************************
+   if (opt->seed != 0)
+   {
+      // as srand48 does
+      design->rng[0] = 0x330E;
+      design->rng[1] = (unsigned short)(opt->seed & 0xFFFF);
+      design->rng[2] = (unsigned short)((opt->seed >> 16) & 0xFFFF);
+   }
+   else
+   {
+      #pragma omp critical(vienna)
+      {
+         init_rand();
+         memcpy(design->rng, xsubi, sizeof(design->rng));
+      }
+   }
+
+   //Initialization:
+   //***************
+   // random choices of the initializing step are drawn from the generator of the design
+   ctx->rng = design->rng;
+   if (ctx->random_init == 1)
+      design->result.initial_energy = Random_Init(ctx);
+   else
+      design->result.initial_energy = Recursion(ctx);
+   design->result.initial_sequence = strdup(ctx->best_char_seq);
+   design->result.random_init = ctx->random_init;
+
+   //Local Search:
+   //*************
+   ctx->rng = design->repeat_rng;
+
+   ctx->step = 2;
+
+   design->kT = (temperature+273.15)*1.98717/1000.0;
+   design->found = (opt->repeat!=0)? abs(opt->repeat) : 1;
+   design->rstart = (char*) malloc(sizeof(char)*(ctx->struct_len+1));
+   design->str2 = (char*) malloc(sizeof(char)*(ctx->struct_len+1));
+   design->test_str = (char*) malloc(sizeof(char)*(ctx->struct_len+1));
+
+   return design;
+}
+
+
+/**********************************************************************************
+*   One repeat of the local search (starting from the initial sequence), the      *
+*   solutions are appended to the result. Returns 1, if the repeat counts for the *
+*   number of repeats                                                             *
+**********************************************************************************/
+
+void inforna_seed_repeat(InfoRNADesign* design)
+{
+   for (int r=0; r<3; r++)
+      design->repeat_rng[r] = (unsigned short)(erand48(design->rng)*65536);
+}
+
+
+int inforna_repeat(InfoRNADesign* design)
+{
+   DesignContext* ctx = design->ctx;
+   char *string, *str2 = design->str2, *test_str = design->test_str;
+   int counted = 0, repeat = design->opt.repeat;
+   double energy = 0.0, min_en, kT = design->kT;
+
+   inforna_seed_repeat(design);
+   string = (char *) malloc(sizeof(char)*((unsigned)ctx->struct_len+1));
+   strcpy(string, ctx->best_char_seq);
+   strcpy(design->rstart, string); /* remember start string */
+
+   if (design->opt.mfe)
+   {
+      energy = inverse_fold(ctx, string);
+      min_en = fold_engine_fold(ctx->folder, string, test_str, 'F');
+      // the walks of the remaining substructures were skipped, the distance of the last one doesn't hold
+      if (ctx->time_out)
+         energy = fold_engine_distance(ctx->folder, test_str, ctx->brackets);
+      if( (repeat>=0) || (energy<=0.0) )
+      {
+         counted = 1;
+         Add_Solution(design, INFORNA_MFE, string, test_str, min_en, (energy>0)? energy : 0.0, 0.0);
+      }
+   }
+
+   if (design->opt.pf)
+   {
+      if (!(design->opt.mfe && give_up && (energy>0)))
+      {
+         /* unless we gave up in the mfe part */
+         double prob, min_en, sfact=1.07;
+
+         // pf_fold keeps its matrices and its scaling factor in globals
+         #pragma omp critical(vienna_pf)
+         {
+            /* get a reasonable pf_scale */
+            min_en = fold_engine_fold(ctx->folder, string, str2, 'F');
+            pf_scale = exp(-(sfact*min_en)/kT/ctx->struct_len);
+            init_pf_fold(ctx->struct_len);
+
+            energy = inverse_pf_fold(ctx, string);
+            free_pf_arrays();
+         }
+         prob = exp(-energy/kT);
+         min_en = fold_engine_fold(ctx->folder, string, test_str, 'F');
+         Add_Solution(design, INFORNA_PF, string, test_str, min_en, 0.0, prob);
+      }
+      if (! (design->opt.mfe))
+         counted = 1;
+   }
+   free(string);
+   ctx->num_mis = 0;
+   design->found -= counted;
+   return counted;
+}
+
+
+int inforna_done(const InfoRNADesign* design)
+{
+   return (design->found <= 0);
+}
+
+
+static void Free_Result(InfoRNAResult* res)
+{
+   for (int i=0; i<res->num_solutions; i++)
+   {
+      free(res->solutions[i].sequence);
+      free(res->solutions[i].mfe_structure);
+   }
+   free(res->solutions);
+   free(res->structure);
+   free(res->constraints);
+   free(res->allowed_mismatches);
+   free(res->initial_sequence);
+}
+
+
+void inforna_free_design(InfoRNADesign* design)
+{
+   Free_Result(&design->result);
+   free(design->rstart);
+   free(design->str2);
+   free(design->test_str);
+   FreeDesignContext(design->ctx);
+   free(design);
+}
+
+
+/**********************************************************************************
+*                        complete design of a structure                           *
+**********************************************************************************/
+
+InfoRNAResult* inforna_design(const char* structure, const char* constraints, const char* allowed_mismatches, const InfoRNAOptions* opt)
+{
+   InfoRNADesign* design = inforna_prepare(structure, constraints, allowed_mismatches, opt);
+   if (design == NULL)
+      return NULL;
+
+   while (!inforna_done(design))
+      inforna_repeat(design);
+
+   // the result is handed over to the caller
+   InfoRNAResult* res = (InfoRNAResult*) malloc(sizeof(InfoRNAResult));
+   *res = design->result;
+   memset(&design->result, 0, sizeof(InfoRNAResult));
+   inforna_free_design(design);
+   return res;
+}
+
+
+void inforna_free_result(InfoRNAResult* res)
+{
+   Free_Result(res);
+   free(res);
+}
+
+
+const char* inforna_fold_engine_name(int engine)
+{
+   const FoldBackend* backend = fold_backend(engine);
+   return (backend != NULL)? backend->name : NULL;
+}
+
+
+int inforna_fold_engine_thread_safe(int engine)
+{
+   const FoldBackend* backend = fold_backend(engine);
+   return (backend != NULL) && backend->thread_safe;
+}
+
+
+int inforna_num_fold_engines(void)
+{
+   return FOLD_BACKENDS;
+}
+
+
+void inforna_cleanup(void)
+{
+   fold_backends_cleanup();
+   Free_LoopMemos();
+}
+
+
+
+/**********************************************************************************
+*   the tables of 37 C are rescaled with the enthalpies of the parameters of      *
+*   Vienna's fold, which gets the same temperature                                *
+**********************************************************************************/
+
+static int Set_Temperature(double celsius)
+{
+   if (celsius != 37.0)
+   {
+      if (!energy_enthalpies_set && !Load_Vienna_Enthalpies())
+         return 0;
+      Scale_Energies(celsius);
+   }
+   energy_temperature = celsius;
+
+   #pragma omp critical(vienna)
+   temperature = celsius;
+   Free_LoopMemos();
+   fold_backends_params_changed();
+   return 1;
+}
+
+
+int inforna_load_parameters(const char* file)
+{
+   if (energy_temperature != 37.0)
+   {
+      cerr << "The parameter file has to be read before the temperature is set!\n";
+      return 0;
+   }
+   if (!Load_Parameter_File(file))
+      return 0;
+
+   // Vienna's fold gets the same parameters, the loop minima and the tables of the backends are recomputed
+   #pragma omp critical(vienna)
+   read_parameter_file(file);
+   Free_LoopMemos();
+   fold_backends_params_changed();
+   return 1;
+}
+
+
+int inforna_set_temperature(double celsius)
+{
+   if (celsius <= -273.15)
+   {
+      cerr << "The temperature " << celsius << " C is below the absolute zero!\n";
+      return 0;
+   }
+   if (energy_temperature != 37.0)
+   {
+      cerr << "The temperature is already set!\n";
+      return 0;
+   }
+   return Set_Temperature(celsius);
+}
@@ -0,0 +1,140 @@
+#ifndef _INFORNA__
+#define _INFORNA__
+
+/**********************************************************************************
+*  libinforna: design of sequences that fold into a given structure and satisfy  *
+*  the given sequence constraints. The results are returned as structs, nothing  *
+*  is printed (except the reason of a rejected input on stderr).                 *
+*                                                                                *
+*     InfoRNAOptions opt;                                                        *
+*     inforna_default_options(&opt);                                             *
+*     InfoRNAResult* res = inforna_design("((((...))))", NULL, NULL, &opt);      *
+*     ... res->solutions[0].sequence ...                                         *
+*     inforna_free_result(res);                                                  *
+**********************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct DesignContext;
+
+#define INFORNA_MFE 0   // solution of the local search with mfe folding
+#define INFORNA_PF  1   // solution of the local search with partition function folding
+
+struct InfoRNAOptions
+{
+   int random_init;            // 1: random initializing sequence instead of the optimal one
+   int free_bases_set2A;       // bases the free bases (no energy contribution) may be set to,
+   int free_bases_set2C;       // all 0 = no restriction
+   int free_bases_set2G;
+   int free_bases_set2U;
+   int search_strategy;        // 1 = adaptive walk, 2 = full local search, 3 = stochastic local search
+   int neighbour_choice;       // 1 = random, 2 = energy dependent
+   int only_mutation_is_step;  // 1: only accepted mutations are counted as steps of the SLS
+   int step_multiplier;        // max. number of steps of the SLS = step_multiplier * length
+   double p_accept;            // probability to accept worse neighbors during the SLS
+   int fold_engine;            // folding backend of the local search: 1 = Vienna fold, 2 = native incremental fold,
+                               // 3 = fold compounds of Vienna 2.x (if built with VIENNA_VERSION=2)
+   int eval_engine;            // folding backend of the initial and the designed sequences (mfe, structure, distance)
+   int num_threads;            // threads folding the neighbors of the local search
+   int fold_threads;           // threads folding one sequence (native fold: wavefront of blocks of the matrices)
+   double time_limit;          // budgets of each run of the local search, the best sequence found so far
+   long max_evaluations;       // is returned when one is exceeded: running time in seconds, folded
+   long max_accepted;          // candidates and accepted steps (0 = no limit)
+   double energy_filter;       // candidates raising the energy of the target structure by more than this
+                               // (kcal/mol) are only folded if no other neighbor is accepted, < 0 = off
+   int max_mis;                // max. number of mismatches to the constraints (-1 = not given)
+   int mfe;                    // local search with mfe folding
+   int pf;                     // local search with partition function folding
+   int repeat;                 // number of repeats of the local search (<0: until -repeat solutions are found)
+   long seed;                  // seed of the random generator of the design (initializing step and local search), 0 = from the time
+};
+
+struct InfoRNASolution
+{
+   int kind;                   // INFORNA_MFE or INFORNA_PF
+   char* sequence;             // designed sequence
+   int hamming;                // hamming distance to the initializing sequence
+   double energy;              // minimum free energy of the sequence (kcal/mol)
+   char* mfe_structure;        // its mfe structure
+   double distance;            // INFORNA_MFE: base pair distance of the mfe structure to the target (0 = solved)
+   double probability;         // INFORNA_PF: probability of the target structure
+   int mismatches;             // number of mismatches to the constraints
+   int budget_exceeded;        // 1 if the local search was stopped by a budget (see InfoRNAOptions)
+   long evaluations;           // folded candidates
+   long filtered;              // candidates deferred by the energy filter and never folded (folds saved)
+   long accepted;              // accepted steps
+};
+
+struct InfoRNAResult
+{
+   char* structure;            // wanted structure
+   char* constraints;          // sequence constraints in IUPAC code
+   char* allowed_mismatches;   // positions where mismatches are allowed ('0'/'1')
+   char* initial_sequence;     // result of the initializing step
+   double initial_energy;
+   int random_init;
+   int num_solutions;
+   struct InfoRNASolution* solutions; // one per repeat and folding (mfe, pf)
+};
+
+struct InfoRNADesign           // a design in progress, see inforna_prepare
+{
+   struct DesignContext* ctx;
+   struct InfoRNAOptions opt;
+   struct InfoRNAResult result;
+   int found;                  // number of repeats that are still to be done
+   char* rstart;               // work space of the repeats
+   char* str2;
+   char* test_str;
+   double kT;
+   unsigned short rng[3];      // random generator the repeats are seeded from (in their order)
+   unsigned short repeat_rng[3]; // random generator of the local search of the current repeat
+};
+
+typedef struct InfoRNAOptions InfoRNAOptions;
+typedef struct InfoRNASolution InfoRNASolution;
+typedef struct InfoRNAResult InfoRNAResult;
+typedef struct InfoRNADesign InfoRNADesign;
+
+void inforna_default_options(InfoRNAOptions* opt);
+int inforna_check_options(const InfoRNAOptions* opt);
+
+// complete design: initializing step and all repeats of the local search, NULL if the input is not valid
+InfoRNAResult* inforna_design(const char* structure, const char* constraints, const char* allowed_mismatches, const InfoRNAOptions* opt);
+void inforna_free_result(InfoRNAResult* res);
+
+// step by step: inforna_prepare does the initializing step, each inforna_repeat one repeat of the
+// local search (its solutions are appended to design->result), returns 1 if the repeat counts
+InfoRNADesign* inforna_prepare(const char* structure, const char* constraints, const char* allowed_mismatches, const InfoRNAOptions* opt);
+int inforna_repeat(InfoRNADesign* design);
+// seeds the random generator of the next repeat, i.e. a repeat depends only on the seed and its number;
+// inforna_repeat calls it, a caller that runs the repeat elsewhere (e.g. in a child process) calls it to skip the repeat
+void inforna_seed_repeat(InfoRNADesign* design);
+int inforna_done(const InfoRNADesign* design);
+void inforna_free_design(InfoRNADesign* design);
+
+// reads an energy parameter file of the Vienna package (RNAfold -P) for the initializing step and
+// the folding, call it before the designs start, 0 if the file is not valid (parameters unchanged)
+int inforna_load_parameters(const char* file);
+
+// rescales the energy parameters of the initializing step and the folding from 37 C to the given
+// temperature (C), call it once before the designs start (after inforna_load_parameters), 0 on failure
+int inforna_set_temperature(double celsius);
+
+// name of the folding backend with the given number (InfoRNAOptions.fold_engine, eval_engine, 1..inforna_num_fold_engines()),
+// NULL if it isn't compiled in
+const char* inforna_fold_engine_name(int engine);
+// 1 if the backend can fold with several threads (num_threads > 1), else the options are rejected
+int inforna_fold_engine_thread_safe(int engine);
+int inforna_num_fold_engines(void);
+
+// frees the matrices of the folding backends and the loop memo tables, call it when no design is running any more
+void inforna_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif   // _INFORNA_
@@ -1,6 +1,7 @@
 
 
 #include "interior_energy.h"
+#include "loop_memo.h"
 
 /************************************************************
 
@@ -9,21 +10,31 @@ assignments of both closing BPs are known
 
 ************************************************************/
 
-double BestInteriorLoopEnergy(int bp_pos, int leftSize, int rightSize, int bp_i, int bp_j, int bp_before)
+int BestInteriorLoopEnergy(DesignContext* ctx, int bp_pos, int leftSize, int rightSize, int bp_i, int bp_j, int bp_before)
 {
-   double energy = 0.0;
-   double asym = 0.0;
-   double min = MAX_DOUBLE;
-   double energy_help;
+   int energy = 0;
+   int asym = 0;
+   int min = MAX_ENERGY;
+   int energy_help;
 
    int size = leftSize + rightSize;
    int bp_new = BP2int(bp_i, bp_j);
    int base_i_before, base_j_before;
    int bp_pos_i, bp_pos_j;
+   int* memo;   // memo table of the small loops and the key of this loop
+   int key;
 
    BP2_2(bp_before,base_i_before,base_j_before);
-   bp_pos_i = BP_Order[bp_pos][0];
-   bp_pos_j = BP_Order[bp_pos][1];
+   bp_pos_i = ctx->BP_Order[bp_pos][0];
+   bp_pos_j = ctx->BP_Order[bp_pos][1];
+
+   // penalties of the loop bases next to the closing BPs (at most 2 per side are considered one by one)
+   const int* pen_i1 = BasePenalties(ctx, bp_pos_i+1);
+   const int* pen_i2 = BasePenalties(ctx, bp_pos_i+2);
+   const int* pen_j1 = BasePenalties(ctx, bp_pos_j-1);
+   const int* pen_j2 = BasePenalties(ctx, bp_pos_j-2);
+   const int* pen_left = BasePenalties(ctx, bp_pos_i+leftSize);
+   const int* pen_right = BasePenalties(ctx, bp_pos_j-rightSize);
 
    // no bulges and loops of size 0:
    //******************************************
@@ -35,56 +46,81 @@ double BestInteriorLoopEnergy(int bp_pos, int leftSize, int rightSize, int bp_i,
 
    // special cases:
    //******************************************
+   // (their minimum is taken from the memo table, if it is already known)
    if ((leftSize == 1) && (rightSize == 1))
    {
+      memo = LoopMemo(MEMO_INTERIOR_1_1);
+      key = ((6*bp_new+bp_before)*16 + AllowedMask(ctx, bp_pos_i+1))*16 + AllowedMask(ctx, bp_pos_j-1);
+      if ((energy = Memo_Get(memo, key)) != MEMO_UNSET)
+         return energy;
+
       for (int x=0; x<4; x++)
          for (int y=0; y<4; y++)
          {
-            energy_help = Sum_MaxDouble3(interior_loop_1_1_energy[96*bp_new+24*x+4*bp_before+y], BasePenalty(bp_pos_i+1,x), BasePenalty(bp_pos_j-1,y));
+            energy_help = Sum_MaxEnergy3(interior_loop_1_1_energy[96*bp_new+24*x+4*bp_before+y], pen_i1[x], pen_j1[y]);
             if (energy_help < min)
                min = energy_help;
          }
       energy = min;
+      Memo_Set(memo, key, energy);
    }
    else if ((leftSize == 1) && (rightSize == 2)) /*x(i-1)-x(i)=2 and y(i)-y(i-1)=3*/
    {
+      memo = LoopMemo(MEMO_INTERIOR_1_2);
+      key = (((6*bp_new+bp_before)*16 + AllowedMask(ctx, bp_pos_i+1))*16 + AllowedMask(ctx, bp_pos_j-1))*16 + AllowedMask(ctx, bp_pos_j-2);
+      if ((energy = Memo_Get(memo, key)) != MEMO_UNSET)
+         return energy;
+
       for (int x=0; x<4; x++)
          for (int y=0; y<4; y++)
             for (int z=0; z<4; z++)
             {
-               energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+1,x), BasePenalty(bp_pos_j-1,y), BasePenalty(bp_pos_j-2,z));
-               energy_help = Sum_MaxDouble(energy_help, interior_loop_1_2_energy[384*bp_new+96*z+24*x+4*bp_before+y]);
+               energy_help = Sum_MaxEnergy3(pen_i1[x], pen_j1[y], pen_j2[z]);
+               energy_help = Sum_MaxEnergy(energy_help, interior_loop_1_2_energy[384*bp_new+96*z+24*x+4*bp_before+y]);
                if (energy_help < min)
                   min = energy_help;
             }
       energy = min;
+      Memo_Set(memo, key, energy);
    }
    else if ((leftSize == 2) && (rightSize == 1)) /*x(i-1)-x(i)=3 and y(i)-y(i-1)=2*/
    {
+      memo = LoopMemo(MEMO_INTERIOR_2_1);
+      key = (((6*bp_new+bp_before)*16 + AllowedMask(ctx, bp_pos_i+1))*16 + AllowedMask(ctx, bp_pos_i+2))*16 + AllowedMask(ctx, bp_pos_j-1);
+      if ((energy = Memo_Get(memo, key)) != MEMO_UNSET)
+         return energy;
+
       for (int x=0; x<4; x++)
          for (int y=0; y<4; y++)
             for (int z=0; z<4; z++)
             {
-               energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+1,z), BasePenalty(bp_pos_i+2,y), BasePenalty(bp_pos_j-1,x));
-               energy_help = Sum_MaxDouble(energy_help, interior_loop_1_2_energy[384*bp_before+96*z+24*x+4*bp_new+y]);
+               energy_help = Sum_MaxEnergy3(pen_i1[z], pen_i2[y], pen_j1[x]);
+               energy_help = Sum_MaxEnergy(energy_help, interior_loop_1_2_energy[384*bp_before+96*z+24*x+4*bp_new+y]);
                if (energy_help < min)
                   min = energy_help;
             }
       energy = min;
+      Memo_Set(memo, key, energy);
    }
    else if ((leftSize == 2) && (rightSize == 2))
    {
+      memo = LoopMemo(MEMO_INTERIOR_2_2);
+      key = ((((6*bp_new+bp_before)*16 + AllowedMask(ctx, bp_pos_i+1))*16 + AllowedMask(ctx, bp_pos_i+2))*16 + AllowedMask(ctx, bp_pos_j-1))*16 + AllowedMask(ctx, bp_pos_j-2);
+      if ((energy = Memo_Get(memo, key)) != MEMO_UNSET)
+         return energy;
+
       for (int x1=0; x1<4; x1++)
          for (int x2=0; x2<4; x2++)
             for (int y1=0; y1<4; y1++)
                for (int y2=0; y2<4; y2++)
                {
-                  energy_help = Sum_MaxDouble4(BasePenalty(bp_pos_i+1,x1), BasePenalty(bp_pos_i+2,y1), BasePenalty(bp_pos_j-1,x2), BasePenalty(bp_pos_j-2,y2));
-                  energy_help = Sum_MaxDouble(energy_help, interior_loop_2_2_energy[1536*bp_new+256*bp_before+64*x1+16*x2+4*y1+y2]);
+                  energy_help = Sum_MaxEnergy4(pen_i1[x1], pen_i2[y1], pen_j1[x2], pen_j2[y2]);
+                  energy_help = Sum_MaxEnergy(energy_help, interior_loop_2_2_energy[1536*bp_new+256*bp_before+64*x1+16*x2+4*y1+y2]);
                   if (energy_help < min)
                      min = energy_help;
                }
       energy = min;
+      Memo_Set(memo, key, energy);
    }
    else
    {
@@ -95,7 +131,7 @@ double BestInteriorLoopEnergy(int bp_pos, int leftSize, int rightSize, int bp_i,
       else
       {
          energy += loop_destabilizing_energies[3*(30-1)];
-         energy += 1.75*RT*log((double)(size/30.0));
+         energy += LoopExtrapolation(size);
       }
 
       // terminal mismatches a both closings:
@@ -110,13 +146,13 @@ double BestInteriorLoopEnergy(int bp_pos, int leftSize, int rightSize, int bp_i,
             for (int i2=0; i2<4; i2++)
                for (int i3=0; i3<4; i3++)
                {
-                  energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+1,i1), BasePenalty(bp_pos_j-rightSize,i2), BasePenalty(bp_pos_j-1,i3));
-                  energy_help = Sum_MaxDouble3(energy_help, mismatch_energies_interior[64*base_j_before+16*i2+4*base_i_before+i1], mismatch_energies_interior[64*bp_i+16*i1+4*bp_j+i3]);
+                  energy_help = Sum_MaxEnergy3(pen_i1[i1], pen_right[i2], pen_j1[i3]);
+                  energy_help = Sum_MaxEnergy3(energy_help, mismatch_energies_interior[64*base_j_before+16*i2+4*base_i_before+i1], mismatch_energies_interior[64*bp_i+16*i1+4*bp_j+i3]);
 
                   if (energy_help < min)
                      min = energy_help;
                }
-         energy = Sum_MaxDouble(energy, min);
+         energy = Sum_MaxEnergy(energy, min);
       }
       else if (rightSize == 1)//        base_i_before - base_j_before
       {                       //  i1                                      i3
@@ -126,13 +162,13 @@ double BestInteriorLoopEnergy(int bp_pos, int leftSize, int rightSize, int bp_i,
             for (int i2=0; i2<4; i2++)
                for (int i3=0; i3<4; i3++)
                {
-                  energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+leftSize,i1), BasePenalty(bp_pos_i+1,i2), BasePenalty(bp_pos_j-1,i3));
-                  energy_help = Sum_MaxDouble3(energy_help, mismatch_energies_interior[64*base_j_before+16*i3+4*base_i_before+i1], mismatch_energies_interior[64*bp_i+16*i2+4*bp_j+i3]);
+                  energy_help = Sum_MaxEnergy3(pen_left[i1], pen_i1[i2], pen_j1[i3]);
+                  energy_help = Sum_MaxEnergy3(energy_help, mismatch_energies_interior[64*base_j_before+16*i3+4*base_i_before+i1], mismatch_energies_interior[64*bp_i+16*i2+4*bp_j+i3]);
 
                   if (energy_help < min)
                      min = energy_help;
                }
-         energy = Sum_MaxDouble(energy,min);
+         energy = Sum_MaxEnergy(energy,min);
       }
       else                    //        base_i_before - base_j_before
       {                       //  i1                                      i3
@@ -141,21 +177,21 @@ double BestInteriorLoopEnergy(int bp_pos, int leftSize, int rightSize, int bp_i,
            for (int i1=0; i1<4; i1++)
               for ( int i3=0; i3<4; i3++)
               {
-                 energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+leftSize,i1), BasePenalty(bp_pos_j-rightSize,i3), mismatch_energies_interior[64*base_j_before+16*i3+4*base_i_before+i1]);
+                 energy_help = Sum_MaxEnergy3(pen_left[i1], pen_right[i3], mismatch_energies_interior[64*base_j_before+16*i3+4*base_i_before+i1]);
                  if (energy_help < min)
                     min = energy_help;
               }
-           energy = Sum_MaxDouble(energy,min);
+           energy = Sum_MaxEnergy(energy,min);
 
-           min = MAX_DOUBLE;
+           min = MAX_ENERGY;
            for (int i2=0; i2<4; i2++)
               for ( int i4=0; i4<4; i4++)
               {
-                 energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+1,i2), BasePenalty(bp_pos_i-1,i4), mismatch_energies_interior[64*bp_i+16*i2+4*bp_j+i4]);
+                 energy_help = Sum_MaxEnergy3(pen_i1[i2], BasePenalty(ctx, bp_pos_i-1,i4), mismatch_energies_interior[64*bp_i+16*i2+4*bp_j+i4]);
                  if (energy_help < min)
                     min = energy_help;
               }
-           energy = Sum_MaxDouble(energy,min);
+           energy = Sum_MaxEnergy(energy,min);
       }
 
       // asymmetry-penalty:
@@ -163,10 +199,10 @@ double BestInteriorLoopEnergy(int bp_pos, int leftSize, int rightSize, int bp_i,
       // (for 1x2 IL not extra penalty)
       if (leftSize != rightSize)
       {
-         asym = 0.5 * abs(leftSize-rightSize);
-         if (asym > 3.0)
-            asym = 3.0;
-         energy = Sum_MaxDouble(energy,asym);
+         asym = energy_tables.ninio * abs(leftSize-rightSize);
+         if (asym > energy_tables.max_ninio)
+            asym = energy_tables.max_ninio;
+         energy = Sum_MaxEnergy(energy,asym);
       }
    }
    return energy;
@@ -184,10 +220,10 @@ of two assignments of the loop)
 
 ************************************************************/
 
-double InteriorLoopEnergy(int leftSize, int rightSize, int* int_seq, int pos_i, int pos_j)
+int InteriorLoopEnergy(int leftSize, int rightSize, int* int_seq, int pos_i, int pos_j)
 {
-   double energy = 0.0;
-   //double asym = 0.0;
+   int energy = 0;
+   //int asym = 0;
    int x1, x2, y1, y2, i1, i2, i3, i4;
    //int size = leftSize + rightSize;
 
@@ -247,7 +283,7 @@ double InteriorLoopEnergy(int leftSize, int rightSize, int* int_seq, int pos_i,
       else
       {
          energy += loop_destabilizing_energies[3*(30-1)];
-         energy += 1.75*RT*log((double)(size/30.0));
+         energy += LoopExtrapolation(size);
       }*/
 
       // terminal mismatches a both closings:
@@ -288,9 +324,9 @@ double InteriorLoopEnergy(int leftSize, int rightSize, int* int_seq, int pos_i,
       // (for 1x2 IL not extra penalty)
       /*if (leftSize != rightSize)
       {
-         asym = 0.5 * abs(leftSize-rightSize);
-         if (asym > 3.0)
-            asym = 3.0;
+         asym = 50 * abs(leftSize-rightSize);
+         if (asym > 300)
+            asym = 300;
          energy+=asym;
       }*/
    }
@@ -7,7 +7,7 @@
 
 using namespace std;
 
-double BestInteriorLoopEnergy(int bp_pos, int leftSize, int rightSize, int bp_i, int bp_j, int bp_before);
-double InteriorLoopEnergy(int leftSize, int rightSize, int* int_seq, int pos_i, int pos_j);
+int BestInteriorLoopEnergy(DesignContext* ctx, int bp_pos, int leftSize, int rightSize, int bp_i, int bp_j, int bp_before);
+int InteriorLoopEnergy(int leftSize, int rightSize, int* int_seq, int pos_i, int pos_j);
 
 #endif   // _INTERIOR_ENERGY_
@@ -8,74 +8,17 @@
 
 #include <iostream>
 #include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
 
-#include "basics.h"
-#include "constraints.h"
-#include "struct.h"
-#include "inverse.h"
-#include "search.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
 
-using namespace std;
-
-
-/**********************************************************************************
-*    Constants                                                                   *
-*          defined in "basics.h"
-**********************************************************************************/
-
-const int MAX_LOOPS = 2000; //max. number of loops
-
-const double T                    = 310.15  ; // temperature in Kelvin(37C);K=C+273.15
-const double RT                   = 0.616   ; // Boltzmann gas constant in kcal/mol
-// RT=kT=1.380622*10^(-23)Joule/K *310.15K (37C=273.15K+37K=310.15K)
-
-const double MIN_DOUBLE = -1000000.0;
-const double MAX_DOUBLE =  1000000.0;
-const double DOUBLE_DIFF = 0.00001;
-
-const int MIN_INT = -1000000;
-const int MAX_INT = 1000000;
-
-/**********************************************************************************
-*                               global variabels                                  *
-**********************************************************************************/
-int step;   //is 1 if we are in the initialization step, 2 during the local search (the variable is necessary since constraint mismatches
-            //are allowed only during the second step, but the functions with allow them (PairPenaly, BasePenalty) are used during the
-            //initialization as well
-
-char* brackets;  //Structure given in bracket notation
-int struct_len;  //size of the structure
-char *ElementStruct;  // another representation of the structure (incl. elements like S, M, B,...)
-int** BP_Order;  //order of the base pairs (BPs) in which they are examined
-int numBP;       //number of base pairs
-int*  BP_Pos_Nr; //vector in which for each pos. in brackets the pos. in BP_Order is stored
-
-double** D;    //Dynamic recursion matrix
-int**** Trace; //Dynamic Traceback Matrix (has 2 dimensions more than D, since in each D-corresponding field the coordinates of all
-               // predecessor fields have to be stored (two coord. per predecessor) and since there could be more than one predecessors
-               // 2 more dimensions are needed)
-
-char* iupac_const; //sequence constraints in IUPAC Code. If not given by the user, iupac_const is set to NNNNNN....
-int** seq_constraints; //IUPAC constraints translated in boolean constraint, i.e. it is a 2dim. array with as many
-                       //rows as sequence positions exist and 4 columns per row represention the possible base assignments,
-                       //the entries are set to 0 (base not allowed) or 1 (allowed) (0 = A, 1 = C, 2 = G, 3 = U)
-int max_mis; //max. number of mismatches that are allowed among the constrained position or in an interval
-int num_mis; //counter for occuring mismatches
-int* mis_vec; //vector where for each position is stored whether a mismatch is allowed or not
-
-char* best_char_seq;   // designed sequence
-bool free_bases_set2A; // is true, if free bases have to be set to 'A'
-bool free_bases_set2C;
-bool free_bases_set2G;
-bool free_bases_set2U;
-bool random_init;      // true, if the initializing sequence should be designed with random and not optimal
-
-int search_strategy;       // gives the search strategy ( 1 = adaptive walk, 2 = full local search, 3 = stochastic local search)
-int neighbour_choice;      // gives the kind of ranking of the neighbors (1 = random, 2 = energy dependent)
-int only_mutation_is_step; // gives the information how to count the step done during the stochastic local search
-int step_multiplier;       // maximal number of steps during SLS = step_multiplier * length
-double p_accept;           //probability to accept worse neighbors during SLS
+#include "inforna.h"
 
+using namespace std;
 
 
 /**********************************************************************************
@@ -90,7 +33,12 @@ void usage(char* name)
    cout << "                   [-f[ACGUMRWSYKVHDBN] assignment where free bases are set to]\n";
    cout << "                   [-F[mp]] [-R [repeats]] [-S search strategy] [-m]\n";
    cout << "                   [-s length multiplier for max. number of steps during SLS] \n";
-   cout << "                   [-N neighbor choice] [-p prob. to accept worse neighbors]\n\n";
+   cout << "                   [-N neighbor choice] [-p prob. to accept worse neighbors]\n";
+   cout << "                   [-e folding engine] [-a folding engine of the results]\n";
+   cout << "                   [-P threads] [-W threads per fold] [-j jobs]\n";
+   cout << "                   [-t seconds] [-E evaluations] [-A accepted steps]\n";
+   cout << "                   [-D energy filter] [-L parameter file] [-T temperature]\n";
+   cout << "  or: " << name << " -b file [options]\n\n";
    exit(1);
 }
 
@@ -103,7 +51,12 @@ void usage_help(char* name)
    cout << "                   [-f[ACGUMRWSYKVHDBN] assignment where free bases are set to]\n";
    cout << "                   [-F[mp]] [-R [repeats]] [-S search strategy] [-m]\n";
    cout << "                   [-s length multiplier for max. number of steps during SLS] \n";
-   cout << "                   [-N neighbor choice] [-p prob. to accept worse neighbors]\n\n";
+   cout << "                   [-N neighbor choice] [-p prob. to accept worse neighbors]\n";
+   cout << "                   [-e folding engine] [-a folding engine of the results]\n";
+   cout << "                   [-P threads] [-W threads per fold] [-j jobs]\n";
+   cout << "                   [-t seconds] [-E evaluations] [-A accepted steps]\n";
+   cout << "                   [-D energy filter] [-L parameter file] [-T temperature]\n";
+   cout << "  or: " << name << " -b file [options]\n\n";
    cout << endl;
    cout << "\nGeneral options: \n";
    cout << "---------------------\n";
@@ -150,6 +103,63 @@ void usage_help(char* name)
    cout << " -p probability\t Probability to accept worse neighbors during the stochastic\n";
    cout << " \t\t local search. It is set to 0.1 by default.\n";
    cout << endl;
+   cout << " -e engine\t Folding of the candidates during the local search:\n";
+   cout << "                            1 - Vienna fold() (default)\n";
+   cout << "                            2 - native fold, only the part of the DP matrices\n";
+   cout << "                                affected by a mutation is recomputed (-Fm);\n";
+   cout << "                                its energy model isn't verified against\n";
+   cout << "                                Vienna 1.x yet (bench/native_bench)\n";
+   cout << "                            3 - fold compounds of the Vienna package 2.x, one\n";
+   cout << "                                per thread (if built with VIENNA_VERSION=2)\n";
+   cout << endl;
+   cout << " -a engine\t Folding of the initial and the designed sequences (mfe,\n";
+   cout << " \t\t mfe structure, distance to the target), 1 = Vienna fold()\n";
+   cout << " \t\t (default), 2 = native fold (see -e 2). With -e 2 -a 2 the\n";
+   cout << " \t\t mfe design doesn't use Vienna's fold at all.\n";
+   cout << endl;
+   cout << " -P threads\t Number of threads that fold the neighbors during the local\n";
+   cout << " \t\t search (-Fm, -S 1, 2 or 3) in parallel. The accepted neighbors\n";
+   cout << " \t\t are the same as in the serial search. Needs a thread-safe\n";
+   cout << " \t\t folding engine (-e 2 or 3), 1 by default.\n";
+   cout << endl;
+   cout << " -W threads\t Number of threads that fold one sequence with the native\n";
+   cout << " \t\t engine (-e 2, -a 2): the DP matrices are filled in blocks\n";
+   cout << " \t\t along their anti-diagonals, for long targets. The folds of\n";
+   cout << " \t\t the parallel search (-P) use one thread each. 1 by default.\n";
+   cout << endl;
+   cout << " -j jobs\t Number of repeats (-R) that are run at the same time in\n";
+   cout << " \t\t separate processes. Each repeat seeds its own random numbers,\n";
+   cout << " \t\t the results are the same as with -j 1 and are printed in the\n";
+   cout << " \t\t order of the repeats.\n";
+   cout << " \t\t In the batch mode (-b) the number of records designed at the\n";
+   cout << " \t\t same time (threads).\n";
+   cout << endl;
+   cout << " -t seconds\t Budgets of each run of the local search: maximal running\n";
+   cout << " -E evaluations\t time (3600 s by default), number of folded candidates and\n";
+   cout << " -A steps\t number of accepted steps. 0 means no limit. When a budget\n";
+   cout << " \t\t is exceeded, the best sequence found so far is returned.\n";
+   cout << endl;
+   cout << " -D kcal/mol\t Energy filter: candidates that raise the energy of the\n";
+   cout << " \t\t target structure by more than this are not folded, unless\n";
+   cout << " \t\t no other neighbor is accepted. Prints the number of folds,\n";
+   cout << " \t\t saved folds and accepted steps of each solution. Off by default.\n";
+   cout << endl;
+   cout << " -L file\t Energy parameter file of the Vienna package (format of\n";
+   cout << " \t\t RNAfold -P in version 1.x), used by the initializing step\n";
+   cout << " \t\t and the folding. Turner 1999 parameters by default.\n";
+   cout << endl;
+   cout << " -T temperature\t Temperature (C) of the design, also --temperature. The\n";
+   cout << " \t\t energy parameters are rescaled from 37 C (default) with\n";
+   cout << " \t\t the enthalpies of the Vienna package.\n";
+   cout << endl;
+   cout << "\nBatch mode:\n";
+   cout << "-----------------------------------\n";
+   cout << " -b file\t Designs all records of the file (\"-\" = stdin), one per line:\n";
+   cout << " \t\t structure [constraints [allowed mismatches [max. mismatches]]]\n";
+   cout << " \t\t Empty lines and lines starting with '#' are skipped. The other\n";
+   cout << " \t\t options hold for all records, the results of a record are\n";
+   cout << " \t\t printed as soon as it is designed.\n";
+   cout << endl;
 
    exit(0);
 }
@@ -159,22 +169,294 @@ void usage_help(char* name)
 *         Print the input and the results of the initializing step                *
 **********************************************************************************/
 
-void print_in_and_output(double best_energy)
+void print_in_and_output(FILE* out, const InfoRNAResult* res)
+{
+   fprintf(out, "\n=========================\n");
+   fprintf(out, "Initializing Step: \n");
+   fprintf(out, "=========================\n");
+   fprintf(out, "Wanted Structure    : %s\n", res->structure);
+   fprintf(out, "Sequence Constraints: %s\n", res->constraints);
+   fprintf(out, "Allowed Mismatches  : %s\n", res->allowed_mismatches);
+   fprintf(out, "Designed Sequence   : %s\n", res->initial_sequence);
+   fprintf(out, "designed randomly   : %d\n", res->random_init);
+   //fprintf(out, "Energy: %1.2f\n", res->initial_energy);
+   fprintf(out, "\n=========================\n");
+   fprintf(out, "Local Search Results: \n");
+   fprintf(out, "=========================\n");
+}
+
+
+/**********************************************************************************
+*         Print the solutions of the local search, starting with "first"          *
+**********************************************************************************/
+
+void print_solutions(FILE* out, const InfoRNAResult* res, int first, int filter_stats)
+{
+   for (int i=first; i<res->num_solutions; i++)
+   {
+      const InfoRNASolution* sol = &res->solutions[i];
+
+      if (sol->kind == INFORNA_MFE)
+      {
+         fprintf(out, "MFE:    %s  %3d  (%4.2f)", sol->sequence, sol->hamming, sol->energy);
+         if (sol->distance>0) /* no solution found */
+         {
+            fprintf(out, "   d= %g\n", sol->distance);
+            fprintf(out, "NO_MFE: %s\n", sol->mfe_structure);
+         }
+         else
+            fprintf(out, "\n");
+      }
+      else
+         fprintf(out, "PF:     %s  %3d  (%g)  (%4.2f)\n", sol->sequence, sol->hamming, sol->probability, sol->energy);
+      fprintf(out, "number of mismatches: %d\n", sol->mismatches);
+      if (sol->budget_exceeded)
+         fprintf(out, "budget exceeded, best sequence found so far\n");
+      if (filter_stats)
+         fprintf(out, "energy filter: %ld folds, %ld saved, %ld accepted steps (%.1f%% of the folds)\n", sol->evaluations,
+                 sol->filtered, sol->accepted, (sol->evaluations>0)? 100.0*sol->accepted/sol->evaluations : 0.0);
+   }
+}
+
+
+/**********************************************************************************
+*   Runs the repeats in up to "jobs" child processes. Each child writes into its  *
+*   own temporary file, that is copied to out after the former repeats.          *
+*   Each repeat gets its own mismatch counter and timeout, since these are       *
+*   process-local, and seeds its random generator as in the serial loop, i.e.    *
+*   the results don't depend on the number of jobs                               *
+**********************************************************************************/
+
+const int REPEAT_NOT_COUNTED = 3;  // exit code of a repeat that gave up (-R with a negative number)
+
+void Parallel_Repeats(FILE* out, InfoRNADesign* design, int jobs)
+{
+   int total = (design->opt.repeat>0)? design->opt.repeat : -1;  // number of repeats (-1: until enough solutions are found)
+   int next = 0, printed = 0, running = 0;
+   int status, c, r;
+   vector<pid_t> pids;
+   vector<FILE*> files;
+
+   fflush(out);   // not written again by the children
+
+   while (!inforna_done(design))
+   {
+      // start new repeats
+      while ((running < jobs) && ((total < 0) || (next < total)))
+      {
+         FILE* tmp = tmpfile();
+         if (tmp == NULL)
+         {
+            cerr << "\nCould not create a temporary file for repeat " << next << "!\n\n";
+            exit(1);
+         }
+         pid_t pid = fork();
+         if (pid < 0)
+         {
+            cerr << "\nCould not start a process for repeat " << next << "!\n\n";
+            exit(1);
+         }
+         if (pid == 0)
+         {
+            int first = design->result.num_solutions;
+            r = inforna_repeat(design);
+            print_solutions(tmp, &design->result, first, design->opt.energy_filter >= 0);
+            fflush(tmp);
+            _exit(r ? 0 : REPEAT_NOT_COUNTED);
+         }
+         // the child seeds the repeat from the generator as it was before, here the repeat is skipped,
+         // i.e. the repeats are seeded in their order as in the serial loop
+         inforna_seed_repeat(design);
+         pids.push_back(pid);
+         files.push_back(tmp);
+         next++;
+         running++;
+      }
+
+      // print the next repeat in order
+      if (waitpid(pids[printed], &status, 0) < 0)
+      {
+         cerr << "\nLost the process of repeat " << printed << "!\n\n";
+         exit(1);
+      }
+      running--;
+      if (!WIFEXITED(status) || ((WEXITSTATUS(status) != 0) && (WEXITSTATUS(status) != REPEAT_NOT_COUNTED)))
+      {
+         cerr << "\nRepeat " << printed << " failed!\n\n";
+         exit(1);
+      }
+      rewind(files[printed]);
+      while ((c = fgetc(files[printed])) != EOF)
+         fputc(c, out);
+      fflush(out);
+      fclose(files[printed]);
+      if (WEXITSTATUS(status) == 0)
+         design->found--;
+      printed++;
+   }
+
+   // repeats that are not needed any more (only if repeat < 0)
+   for (r=printed; r<next; r++)
+   {
+      kill(pids[r], SIGKILL);
+      waitpid(pids[r], &status, 0);
+      fclose(files[r]);
+   }
+}
+
+
+/**********************************************************************************
+*   Local search of a prepared design, the results of the initializing step and  *
+*   of all repeats are printed to out                                            *
+**********************************************************************************/
+
+void Print_Design(FILE* out, InfoRNADesign* design, int jobs)
 {
-   printf("\n=========================\n");
-   printf("Initializing Step: \n");
-   printf("=========================\n");
-   printf("Wanted Structure    : %s\n",brackets);
-   printf("Sequence Constraints: %s\n", iupac_const);
-   printf("Allowed Mismatches  : ");
-   for (int i=0; i<struct_len; i++)
-      printf("%d", mis_vec[i]);
-   printf("\nDesigned Sequence   : %s\n",best_char_seq);
-   printf("designed randomly   : %d\n", random_init);
-   //printf("Energy: %1.2f\n", best_energy);
-   printf("\n=========================\n");
-   printf("Local Search Results: \n");
-   printf("=========================\n");
+   print_in_and_output(out, &design->result);
+
+   if ((jobs > 1) && (design->opt.repeat != 0))
+      Parallel_Repeats(out, design, jobs);
+   else
+      while (!inforna_done(design))
+      {
+         int first = design->result.num_solutions;
+         inforna_repeat(design);
+         print_solutions(out, &design->result, first, design->opt.energy_filter >= 0);
+      }
+
+   fprintf(out, "\n");
+}
+
+
+/**********************************************************************************
+*   Designs one record of the batch mode:                                         *
+*      structure [constraints [allowed mismatches [max. number of mismatches]]]   *
+*   The results are collected in memory and printed as a whole when the design is *
+*   finished. Returns 0 if the record is not valid                                *
+**********************************************************************************/
+
+int Batch_Record(const InfoRNAOptions* opts, char* record, int nr, long seed)
+{
+   char *field[4] = {NULL, NULL, NULL, NULL}, *save;
+   char *result = NULL;
+   size_t result_len = 0;
+   int num_fields = 0;
+   InfoRNAOptions opt = *opts;
+   InfoRNADesign* design = NULL;
+
+   for (char* f = strtok_r(record, " \t\r\n", &save); f != NULL; f = strtok_r(NULL, " \t\r\n", &save))
+   {
+      if (num_fields == 4)
+         break;
+      field[num_fields++] = f;
+   }
+
+   opt.seed = seed;
+   if ((num_fields > 3) && (sscanf(field[3], "%d", &opt.max_mis) == 0))
+      cerr << "\nRecord " << nr << ": the maximal number of mismatches is not a number!\n";
+   else
+      design = inforna_prepare(field[0], field[1], field[2], &opt);
+
+   if (design == NULL)
+   {
+      cerr << "Record " << nr << " (" << field[0] << ") is skipped.\n";
+      return 0;
+   }
+
+   FILE* out = open_memstream(&result, &result_len);
+   if (out == NULL)
+   {
+      cerr << "\nCould not buffer the results of record " << nr << "!\n\n";
+      exit(1);
+   }
+   fprintf(out, "\nRecord %d\n", nr);
+   Print_Design(out, design, 1);
+   fclose(out);
+
+   #pragma omp critical(output)
+   {
+      fwrite(result, 1, result_len, stdout);
+      fflush(stdout);
+   }
+   free(result);
+   inforna_free_design(design);
+   return 1;
+}
+
+
+/**********************************************************************************
+*   Batch mode: reads the records (one per line, empty lines and lines starting   *
+*   with '#' are skipped) from file ("-" = stdin) and designs them with up to     *
+*   "jobs" threads. Each record becomes a task as soon as it is read, idle        *
+*   threads take the next open task. The results are printed as soon as a        *
+*   record is finished, i.e. not necessarily in the order of the records          *
+**********************************************************************************/
+
+void Batch_Design(const InfoRNAOptions* opts, char* file, int jobs)
+{
+   FILE* in = (strcmp(file, "-") == 0)? stdin : fopen(file, "r");
+   char* line = NULL;
+   size_t line_size = 0;
+   int nr = 0, designed = 0, skipped = 0;
+   unsigned short rng[3];
+
+   if (in == NULL)
+   {
+      cerr << "\nCould not open the batch file " << file << "!\n\n";
+      exit(1);
+   }
+
+   // the random generators of the records are seeded from this one in the order of the records,
+   // i.e. the local search of a record does not depend on the number of jobs
+   if (opts->seed != 0)
+   {
+      rng[0] = 0x330E;
+      rng[1] = (unsigned short)(opts->seed & 0xFFFF);
+      rng[2] = (unsigned short)((opts->seed >> 16) & 0xFFFF);
+   }
+   else
+   {
+      rng[0] = 0x330E;
+      rng[1] = (unsigned short)(time(NULL) & 0xFFFF);
+      rng[2] = (unsigned short)getpid();
+   }
+
+   #pragma omp parallel num_threads(jobs)
+   #pragma omp single
+   {
+      while (getline(&line, &line_size, in) != -1)
+      {
+         char* p = line;
+         while ((*p == ' ') || (*p == '\t'))
+            p++;
+         if ((*p == '\0') || (*p == '\n') || (*p == '\r') || (*p == '#'))
+            continue;
+
+         nr++;
+         char* record = strdup(p);
+         long seed = 1 + (long)(erand48(rng)*2147483646.0);
+
+         #pragma omp task firstprivate(record, nr, seed) shared(designed, skipped) if(jobs > 1)
+         {
+            int valid = Batch_Record(opts, record, nr, seed);
+            #pragma omp atomic
+            designed += valid;
+            #pragma omp atomic
+            skipped += 1-valid;
+            free(record);
+         }
+      }
+      #pragma omp taskwait
+   }
+
+   free(line);
+   if (in != stdin)
+      fclose(in);
+
+   cerr << "\n" << designed << " of " << nr << " records designed";
+   if (skipped > 0)
+      cerr << ", " << skipped << " skipped";
+   cerr << ".\n";
 }
 
 
@@ -184,35 +466,16 @@ void print_in_and_output(double best_energy)
 
 int main(int argc, char *argv[])
 {
-   char *rstart, *str2;
-   int hd, mfe = 1, pf = 0, repeat = 0, found;
-   double energy = 0.0, kT;
-   bool constraints_given = false; //mismatches in constraints are just useful if constraints are given at all. thus here the reminder
-                                   //whether constraints are given
+   int jobs = 1;
+   InfoRNAOptions opt;
+   char* structure = NULL;
+   char* constraints = NULL;
+   char* batch_file = NULL;   // records of the batch mode (-b), "-" = stdin
    char* mis_vec_char = NULL;
-   
-   //random generator init
-   long sec;
-   time(&sec);
-   srand((unsigned)sec);
-
-   step = 1;
-   random_init = 0;
-   max_mis = -1;
-   num_mis = 0;
-
-   search_strategy = 1;
-   neighbour_choice = 1;
-   only_mutation_is_step = 0;
-   step_multiplier = 10;
-   p_accept = 0.1;
-
-   do_backtrack = 0;
-
-   free_bases_set2A = 0;
-   free_bases_set2C = 0;
-   free_bases_set2G = 0;
-   free_bases_set2U = 0;
+   char* par_file = NULL;     // energy parameters (-L)
+   double celsius = 37.0;     // temperature (-T)
+
+   inforna_default_options(&opt);
 
    if (argc < 2)
    {
@@ -225,15 +488,15 @@ int main(int argc, char *argv[])
       usage_help(argv[0]);
       exit(0);
    }
-   else
-      brackets = argv[1];
+   else if (argv[1][0] != '-')
+      structure = argv[1];
 
-   for (int i = 2; i<argc; i++)
+   for (int i = (structure == NULL)? 1 : 2; i<argc; i++)
    {
       if (argv[i][0] == '-')
          switch (argv[i][1])
          {
-            case 'r': random_init = 1;
+            case 'r': opt.random_init = 1;
                       break;
             case 'f': //i++;
                       //if ( i<argc )
@@ -242,56 +505,56 @@ int main(int argc, char *argv[])
                          for(int j=2; j<(int)strlen(argv[i]); j++)
                             switch( argv[i][j] )
                             {
-                               case 'A' :  free_bases_set2A = 1;
+                               case 'A' :  opt.free_bases_set2A = 1;
                                            //cout << endl << "free_bases_set2A: " << free_bases_set2A;
                                            break;
-                               case 'C' :  free_bases_set2C = 1;
+                               case 'C' :  opt.free_bases_set2C = 1;
                                            //cout << endl << "free_bases_set2C: " << free_bases_set2C;
                                            break;
-                               case 'G' :  free_bases_set2G = 1;
+                               case 'G' :  opt.free_bases_set2G = 1;
                                            //cout << endl << "free_bases_set2G: " << free_bases_set2G;
                                            break;
-                               case 'U' :  free_bases_set2U = 1;
+                               case 'U' :  opt.free_bases_set2U = 1;
                                            //cout << endl << "free_bases_set2U: " << free_bases_set2U;
                                            break;
-                               case 'M' :  free_bases_set2A = 1;
-                                           free_bases_set2C = 1;
+                               case 'M' :  opt.free_bases_set2A = 1;
+                                           opt.free_bases_set2C = 1;
                                            break;
-                               case 'R' :  free_bases_set2A = 1;
-                                           free_bases_set2G = 1;
+                               case 'R' :  opt.free_bases_set2A = 1;
+                                           opt.free_bases_set2G = 1;
                                            break;
-                               case 'W' :  free_bases_set2A = 1;
-                                           free_bases_set2U = 1;
+                               case 'W' :  opt.free_bases_set2A = 1;
+                                           opt.free_bases_set2U = 1;
                                            break;
-                               case 'S' :  free_bases_set2C = 1;
-                                           free_bases_set2G = 1;
+                               case 'S' :  opt.free_bases_set2C = 1;
+                                           opt.free_bases_set2G = 1;
                                            break;
-                               case 'Y' :  free_bases_set2C = 1;
-                                           free_bases_set2U = 1;
+                               case 'Y' :  opt.free_bases_set2C = 1;
+                                           opt.free_bases_set2U = 1;
                                            break;
-                               case 'K' :  free_bases_set2G = 1;
-                                           free_bases_set2U = 1;
+                               case 'K' :  opt.free_bases_set2G = 1;
+                                           opt.free_bases_set2U = 1;
                                            break;
-                               case 'V' :  free_bases_set2A = 1;
-                                           free_bases_set2C = 1;
-                                           free_bases_set2G = 1;
+                               case 'V' :  opt.free_bases_set2A = 1;
+                                           opt.free_bases_set2C = 1;
+                                           opt.free_bases_set2G = 1;
                                            break;
-                               case 'H' :  free_bases_set2A = 1;
-                                           free_bases_set2C = 1;
-                                           free_bases_set2U = 1;
+                               case 'H' :  opt.free_bases_set2A = 1;
+                                           opt.free_bases_set2C = 1;
+                                           opt.free_bases_set2U = 1;
                                            break;
-                               case 'D' :  free_bases_set2A = 1;
-                                           free_bases_set2G = 1;
-                                           free_bases_set2U = 1;
+                               case 'D' :  opt.free_bases_set2A = 1;
+                                           opt.free_bases_set2G = 1;
+                                           opt.free_bases_set2U = 1;
                                            break;
-                               case 'B' :  free_bases_set2C = 1;
-                                           free_bases_set2G = 1;
-                                           free_bases_set2U = 1;
+                               case 'B' :  opt.free_bases_set2C = 1;
+                                           opt.free_bases_set2G = 1;
+                                           opt.free_bases_set2U = 1;
                                            break;
-                               case 'N' :  free_bases_set2A = 1;
-                                           free_bases_set2C = 1;
-                                           free_bases_set2G = 1;
-                                           free_bases_set2U = 1;
+                               case 'N' :  opt.free_bases_set2A = 1;
+                                           opt.free_bases_set2C = 1;
+                                           opt.free_bases_set2G = 1;
+                                           opt.free_bases_set2U = 1;
                                            break;
                                default : usage(argv[0]);
                             }
@@ -304,9 +567,8 @@ int main(int argc, char *argv[])
                          usage(argv[0]);
                       break;
             case 'c': i++;
-                      iupac_const = argv[i];
-                      constraints_given = true;
-                      if ((iupac_const == NULL) || (iupac_const[0] == '-'))
+                      constraints = argv[i];
+                      if ((constraints == NULL) || (constraints[0] == '-'))
                       {
                          printf("\nThe constraints are missing!\n");
                          usage(argv[0]);
@@ -324,14 +586,14 @@ int main(int argc, char *argv[])
                       break;
             case 'F': if ((int)strlen(argv[i]) > 2)
                       {
-                         mfe = 0; pf = 0;
+                         opt.mfe = 0; opt.pf = 0;
                          for(int j=2;j<(int)strlen(argv[i]);j++)
                          {
                             switch( argv[i][j] )
                             {
-                               case 'm' :  mfe = 1;
+                               case 'm' :  opt.mfe = 1;
                                            break;
-                               case 'p' :  pf = 1; /* old version had dangles=0 here */
+                               case 'p' :  opt.pf = 1; /* old version had dangles=0 here */
                                            break;
                                default : usage(argv[0]);
                             }
@@ -340,37 +602,100 @@ int main(int argc, char *argv[])
                       else
                          usage(argv[0]);
                       break;
-            case 'R': repeat = 100; //REPEAT_DEFAULT;
+            case 'R': opt.repeat = 100; //REPEAT_DEFAULT;
                       if(++i<argc)
-                         if (sscanf(argv[i], "%d", &repeat)==0)
+                         if (sscanf(argv[i], "%d", &opt.repeat)==0)
                             usage(argv[0]);
                       break;
             case 'S': if (argv[i][2]!='\0')
                          usage(argv[0]);
-                      if (sscanf(argv[++i], "%d", &search_strategy)==0)
+                      if (sscanf(argv[++i], "%d", &opt.search_strategy)==0)
                          usage(argv[0]);
                       break;
             case 'N': if (argv[i][2]!='\0')
                          usage(argv[0]);
-                      if (sscanf(argv[++i], "%d", &neighbour_choice)==0)
+                      if (sscanf(argv[++i], "%d", &opt.neighbour_choice)==0)
                          usage(argv[0]);
                       break;
             case 's': if (argv[i][2]!='\0')
                          usage(argv[0]);
-                      if (sscanf(argv[++i], "%d", &step_multiplier)==0)
+                      if (sscanf(argv[++i], "%d", &opt.step_multiplier)==0)
                          usage(argv[0]);
                       break;
             case 'p': if (argv[i][2]!='\0')
                          usage(argv[0]);
                       //p_accept = atof(argv[++i]);
-                      if (sscanf(argv[++i], "%lf", &p_accept)==0)
+                      if (sscanf(argv[++i], "%lf", &opt.p_accept)==0)
                          usage(argv[0]);
                       break;
-            case 'm': only_mutation_is_step = 1;
+            case 'm': opt.only_mutation_is_step = 1;
+                      break;
+            case 'e': if (argv[i][2]!='\0')
+                         usage(argv[0]);
+                      if ((sscanf(argv[++i], "%d", &opt.fold_engine)==0) || (inforna_fold_engine_name(opt.fold_engine)==NULL))
+                         usage(argv[0]);
+                      break;
+            case 'a': if (argv[i][2]!='\0')
+                         usage(argv[0]);
+                      if ((sscanf(argv[++i], "%d", &opt.eval_engine)==0) || (inforna_fold_engine_name(opt.eval_engine)==NULL))
+                         usage(argv[0]);
+                      break;
+            case 'j': if (argv[i][2]!='\0')
+                         usage(argv[0]);
+                      if ((sscanf(argv[++i], "%d", &jobs)==0) || (jobs<1))
+                         usage(argv[0]);
+                      break;
+            case 'P': if (argv[i][2]!='\0')
+                         usage(argv[0]);
+                      if ((sscanf(argv[++i], "%d", &opt.num_threads)==0) || (opt.num_threads<1))
+                         usage(argv[0]);
+                      break;
+            case 'W': if (argv[i][2]!='\0')
+                         usage(argv[0]);
+                      if ((sscanf(argv[++i], "%d", &opt.fold_threads)==0) || (opt.fold_threads<1))
+                         usage(argv[0]);
                       break;
             case 'n': if (argv[i][2]!='\0')
                          usage(argv[0]);
-                      if (sscanf(argv[++i], "%d", &max_mis)==0)
+                      if (sscanf(argv[++i], "%d", &opt.max_mis)==0)
+                         usage(argv[0]);
+                      break;
+            case 't': if (argv[i][2]!='\0')
+                         usage(argv[0]);
+                      if ((sscanf(argv[++i], "%lf", &opt.time_limit)==0) || (opt.time_limit<0))
+                         usage(argv[0]);
+                      break;
+            case 'E': if (argv[i][2]!='\0')
+                         usage(argv[0]);
+                      if ((sscanf(argv[++i], "%ld", &opt.max_evaluations)==0) || (opt.max_evaluations<0))
+                         usage(argv[0]);
+                      break;
+            case 'A': if (argv[i][2]!='\0')
+                         usage(argv[0]);
+                      if ((sscanf(argv[++i], "%ld", &opt.max_accepted)==0) || (opt.max_accepted<0))
+                         usage(argv[0]);
+                      break;
+            case 'D': if (argv[i][2]!='\0')
+                         usage(argv[0]);
+                      if ((sscanf(argv[++i], "%lf", &opt.energy_filter)==0) || (opt.energy_filter<0))
+                         usage(argv[0]);
+                      break;
+            case 'b': if ((argv[i][2]!='\0') || (++i>=argc))
+                         usage(argv[0]);
+                      batch_file = argv[i];
+                      break;
+            case 'L': if ((argv[i][2]!='\0') || (++i>=argc))
+                         usage(argv[0]);
+                      par_file = argv[i];
+                      break;
+            case 'T': if ((argv[i][2]!='\0') || (++i>=argc))
+                         usage(argv[0]);
+                      if (sscanf(argv[i], "%lf", &celsius)==0)
+                         usage(argv[0]);
+                      break;
+            case '-': if ((strcmp(argv[i], "--temperature")!=0) || (++i>=argc))
+                         usage(argv[0]);
+                      if (sscanf(argv[i], "%lf", &celsius)==0)
                          usage(argv[0]);
                       break;
             default : usage(argv[0]);
@@ -380,220 +705,39 @@ int main(int argc, char *argv[])
    }
 
 
-   if ((search_strategy > 3) || (search_strategy < 1))
-   {
-      printf("\nThe search strategy is not valid.\n");
+   if (!inforna_check_options(&opt))
       exit(1);
-   }
 
-   if ((neighbour_choice > 2) || (neighbour_choice < 1))
-   {
-      printf("\nThe choice of the neighbours is not valid.\n");
-      exit(1);
-   }
-
-
-   //if no constraints are given, set to NNNNN.... :
-   //*********************************************************
-   if (iupac_const == NULL)
-   {
-      iupac_const = (char*) malloc(sizeof(char)*((int)strlen(brackets)+1));
-      for (int i=0; i<(int)strlen(brackets); i++)
-         iupac_const[i] = 'N';
-      iupac_const[(int)strlen(brackets)] = '\0';
-   }
-
-   //test, whether the structure is valid:
-   //***************************************
-   int correct = check_brackets(brackets);
-   numBP = NumOfBP(brackets);
-   struct_len = (int)strlen(brackets);
+   if ((batch_file == NULL) == (structure == NULL))
+      usage(argv[0]);
 
-   if (correct)
-   {
-      getOrder(brackets);
-      Pos2BP_Pos();
-   }
-   else
-   {
-      cerr << "\nNo valid structure!\n\n";
+   if ((par_file != NULL) && !inforna_load_parameters(par_file))
       exit(1);
-   }
-
-   //test, whether brackets and iupac_const have the same length
-   //*****************************************************************************
-   if (struct_len != (int)strlen(iupac_const))
-   {
-      cerr << "\nThe structure and the constraint vector must have the same length!\n\n";
+   if ((celsius != 37.0) && !inforna_set_temperature(celsius))
       exit(1);
-   }
 
-   //store mismatch information in an integer vector and look for errors
-   //********************************************************************
-   mis_vec = (int*)malloc(sizeof(int)*struct_len);
-
-   //if no allowed mismatches are given, set mis_vec to "0" everywhere and max_mis to "0", too
-   if (mis_vec_char == NULL)
-   {
-      for (int i=0; i<struct_len; i++)
-         mis_vec[i] = 0;
-      max_mis = 0;
-   }
-   else
+   if (batch_file != NULL)
    {
-      //test, whether brackets and mis_vec_char have the same length
-      if (struct_len != (int)strlen(mis_vec_char))
-      {
-         cerr << "\nThe structure and the mismatch vector must have the same length!\n\n";
-         exit(1);
-      }
-
-      //if no constraints are given but allowed mismatches, ==> constraints are missing
-      if (constraints_given == false)
-      {
-         cerr << "\nAllowed mismatches make no sense without constraints!\n\n";
-         exit(1);
-      }
-
-      //if some mismatches are allowed (conc. mis_vec_char) but the maximal number is not given or set to 0 => makes no sense
-      if (max_mis < 0)
+      if ((constraints != NULL) || (mis_vec_char != NULL))
       {
-         cerr << "\nThe maximal number of mismatches is not given but a vector of allowed mismatch positions!\n\n";
+         cerr << "\nIn the batch mode the constraints are given in the records!\n\n";
          exit(1);
       }
-
-      //set the integer vector
-      for (int i=0; i<(int)strlen(mis_vec_char); i++)
-      {
-         if (mis_vec_char[i] == '0')
-            mis_vec[i] = 0;
-         else if (mis_vec_char[i] == '1')
-            mis_vec[i] = 1;
-         else
-         {
-            cerr << endl << mis_vec_char[i] << " is not valid in the binary code for allowed mismatches!\n\n";
-            exit(1);
-         }
-      }
+      Batch_Design(&opt, batch_file, jobs);
+      inforna_cleanup();
+      return 0;
    }
 
-
-   //test, whether constraints are valid and create constraint array
-   //********************************************************************
-   int correct_iu = Check_iu();
-   int correct_bp = Check_constraints_bp();
-
-   if (correct_iu)
-   {
-      if (correct_bp)
-         getSeqConstraints();
-   }
-   else
-   {
-      cerr << "\nNo valid IUPAC Code!\n\n";
+   InfoRNADesign* design = inforna_prepare(structure, constraints, mis_vec_char, &opt);
+   if (design == NULL)
       exit(1);
-   }
-
-   //****************************************************
-   //****************************************************
-
-   //Initialization:
-   //***************
-   double x;
-   
-   if (random_init == 1)
-      x = Random_Init();
-   else   
-      x = Recursion();
-
-   print_in_and_output(x);
-
-   //****************************************************
-   //****************************************************
-
-   //Local Search:
-   //*************
-   step = 2;
-   double min_en;
-   char* test_str;
-   test_str = (char*) malloc(sizeof(char)*(struct_len+1));
-
-   init_rand();
-   kT = (temperature+273.15)*1.98717/1000.0;
-   give_up = (repeat<0);
-
-   str2 = (char *) malloc(sizeof(char)*((unsigned)struct_len+1));
 
-   if (repeat!=0) found = (repeat>0)? repeat : (-repeat);
-   else found = 1;
+   Print_Design(stdout, design, jobs);
 
-   initialize_fold(struct_len);
-   rstart = (char *) malloc(sizeof(char)*((unsigned)struct_len+1));
+   inforna_free_design(design);
+   inforna_cleanup();
 
-   while(found>0) 
-   {
-      char *string;
-      string = (char *) malloc(sizeof(char)*((unsigned)struct_len+1));
-      strcpy(string, best_char_seq);
-      strcpy(rstart, string); /* remember start string */
-
-      if (mfe)
-      {
-         energy = inverse_fold(string);
-         min_en = fold(string, test_str);
-         if( (repeat>=0) || (energy<=0.0) )
-         {
-            found--;
-            hd = hamming(rstart, string);
-            printf("MFE:    %s  %3d  (%4.2f)", string, hd, min_en);
-            if (energy>0) /* no solution found */
-            {
-               printf("   d= %g\n", energy);
-               energy = fold(string,str2);
-               printf("NO_MFE: %s\n", str2);
-            }
-            else
-               printf("\n");
-            printf("number of mismatches: %d\n", num_mis);
-            
-          }
-      }
-
-      if (pf)
-      {
-         if (!(mfe && give_up && (energy>0)))
-         {
-            /* unless we gave up in the mfe part */
-            double prob, min_en, sfact=1.07;
-
-            /* get a reasonable pf_scale */
-            min_en = fold(string,str2);
-            pf_scale = exp(-(sfact*min_en)/kT/struct_len);
-            init_pf_fold(struct_len);
-
-            energy = inverse_pf_fold(string);
-            prob = exp(-energy/kT);
-            hd = hamming(rstart, string);
-            min_en = fold(string,test_str);
-            printf("PF:     %s  %3d  (%g)  (%4.2f)\n", string, hd, prob,min_en);
-            printf("number of mismatches: %d\n", num_mis);
-            free_pf_arrays();
-         }
-         if (! (mfe))
-            found--;
-      }
-      free(string);
-      num_mis = 0;
-   }
-   free(rstart);
-   free_arrays();
-   free(str2);
-
-   printf("\n");
    //****************************************************
    //****************************************************
    return 0;
 }
-
-
-
@@ -1,5 +1,7 @@
 
 #include "inverse.h"
+#include "search.h"
+#include "loop_memo.h"
 
 /*********************************************
 identifies the order of the base pairs in which their are treated dynamically
@@ -10,39 +12,30 @@ Rule:  The order vector BP_Order is filled starting with base pair (i,j) having
         BP_Order[k][2] gives the number of free bases in a ML, if k is the closing BP of a ML,
         BP_Order[k][3] gives the number of stems if k is the closing BP of a ML)
 
-       Furthermore, we have to take care whether the base pair is a closing one
-       of a ML. Thus, the structure vector (including the structural elements)
-       is also taken into account. If there is a '(Sx', then the next x base pairs
-       are not closing a ML, unless the 'Sx' is followed by a 'Mx'. In this case,
-       the last base pair of the stack '(Sx' is the closing one of the ML. This is
-       marked in BP_Order (in [2]) ==> BP_Order[pos][2]).
+       Furthermore, the loops closed by the base pairs are identified once (loop
+       type, enclosed base pairs, free bases, connections, see loop_index.h). The
+       sizes of the MLs and of the external loop (in the last row) are stored in
+       BP_Order[][2] and BP_Order[][3].
 *********************************************/
 
-void getOrder(char* structure)
+void getOrder(DesignContext* ctx, char* structure)
 {
-   int bp_pos, next_pos, k=0, stack_len;  // stack_len is the current stack length while search for the closing BP of a ML
-   bool stack = false;                    // shows, whether just a stack was found, only in this case, a following ML is searched for
-   char *help_num = (char*) malloc(sizeof(char)*5); // helping storing the length of a stack
-
-   int* results_ML;                       // new position after separately considering the ML
-   results_ML = (int*) malloc(sizeof(int)*2);
-
+   int bp_pos;
    int* bpTable;                          // stores for each pos. the bound pos. in the BP (or -1 if unbound)
    bpTable = make_BasePair_Table(structure);
-   ElementStruct = Element_Structure(right_Element_Structure(structure));
 
-   BP_Order = (int**) malloc(sizeof(int*)*(numBP+1));  // Order of the BPs
-   for (int i=0; i<numBP+1; i++)
+   ctx->BP_Order = (int**) malloc(sizeof(int*)*(ctx->numBP+1));  // Order of the BPs
+   for (int i=0; i<ctx->numBP+1; i++)
    {
-      BP_Order[i] = (int*) malloc(sizeof(int)*4);
+      ctx->BP_Order[i] = (int*) malloc(sizeof(int)*4);
       for (int j=0; j<4; j++)
-         BP_Order[i][j]=0;
+         ctx->BP_Order[i][j]=0;
    }
 
    //finding the BP order
    //*************************
-   bp_pos = numBP-1;
-   for (int i=0; i<(int)strlen(structure); i++)
+   bp_pos = ctx->numBP-1;
+   for (int i=0; i<ctx->struct_len; i++)
    {  //consider only opening bases of BPs
       if ((bpTable[i] != -1) && (bpTable[i]>i))
       {
@@ -51,163 +44,52 @@ void getOrder(char* structure)
             cerr << "Problem to get the order!" << endl;
             exit(1);
          }
-         BP_Order[bp_pos][0] = i;
-         BP_Order[bp_pos][1] = bpTable[i];
+         ctx->BP_Order[bp_pos][0] = i;
+         ctx->BP_Order[bp_pos][1] = bpTable[i];
          bp_pos--;
       }
    }
 
-   //finding closing BPs of MLs
-   //**********************************************
-   bp_pos = numBP-1;
-   unsigned int i=0;  //pos. in ElementStruct
-
-   while ( i < strlen(ElementStruct) )
-   {
-      if ((ElementStruct[i]=='(') && (ElementStruct[i+1]=='S'))
-      {
-         k=0;
-         stack = true;
-         while (ElementStruct[i+k+2] != '(')
-         {
-            help_num[k] = ElementStruct[i+k+2];
-            k++;
-         }
-         help_num[k] = '\0';
-         stack_len = atoi(help_num);
-         bp_pos-=stack_len;
-      }
-
-      //possibly pos. for a ML
-      next_pos = i+k+2+1;
-
-      if ((ElementStruct[next_pos]=='M') && (stack == true)) /*Multi-Loop*/
-      {
-         //size etc. are calculated in StemsInML
-         //i and next_pos are pos. in ElementStruct and bp_pos is pos. in BP_Order
-         results_ML = StemsInML(next_pos-1, bp_pos);
-
-         bp_pos = results_ML[1];
-         i = results_ML[0]; // Pos. of the last bracket of the ML
-      }
-      stack = false;
-      i++;
-   }
-
-   //finding all structures that are only bound by free bases without a closing BP
-   // (this is stored in the last additional row of BP_Order)
-   int* stems_and_freeBases;
-   stems_and_freeBases = ClosingStructure(bpTable);
-
-   BP_Order[numBP][2] = stems_and_freeBases[0];
-   BP_Order[numBP][3] = stems_and_freeBases[1];
+   //finding the loops, the MLs and the external loop
+   //**************************************************
+   ctx->loops = Build_LoopIndex(ctx, bpTable);
 
    free(bpTable);
-   free(ElementStruct);
-   free(help_num);
 }
 
 
-/*******************************************************
-Finds the number of stems in a ML:
-
-the vector ElementStruct is checked, if a "(Mx" is found, a ML begins,
-there, a function is called that counts the stems in this ML and that
-gives the pos. where the ML is closed.
-
-The function can be used recursively.
-*******************************************************/
+/*************************************************
+ allocates D and Trace in one block: the rows of
+ D, the offsets of the BPs in Trace and Trace with
+ 6 assignments for each predecessor of a BP (at
+ least one, hairpin loops have -1), 8 bit each
+*************************************************/
 
-// last_pos_in_element_struct is returned, the number of stems is directly written in BP_Order[][3]
-int* StemsInML(int first_pos, int BP_start_pos)  // first_pos is the pos. in ElementStruct, bp_start_pos gives the pos. in BP_Order
+static void alloc_Recursion(DesignContext* ctx)
 {
-   int k;
-   int pos = first_pos;  // current pos. in ElementStruct
-   int bp_pos = BP_start_pos;  // pos. in BP_Order
-   bool multi = true;    // indicates, whether we are still in the current ML, if "Mx)" is found => false
-   char *help_num = (char*) malloc(sizeof(char)*5); //help for the size of a stack
-   int stack_len = 0;    // stores the accumulated stack length of all stems in a ML, if a stem is closed, the number of BPs in this stem 
-                         // is substracted, if stack_len == 0 in between, a further stem in the ML is found
-   int stems = 0;        // number of stems
-   int* pos_return;      // help vector for returning pos and bp_pos
-   pos_return = (int*) malloc(sizeof(int)*2);
-
-   // run through "(Mx", store x
-   pos+=2;
-
-   k=0;
-   while (ElementStruct[pos+k] != '(')
-   {
-      help_num[k] = ElementStruct[pos+k];
-      k++;
-   }
-   help_num[k] = '\0';
-   BP_Order[BP_start_pos+1][2] = atoi(help_num); //number of free bases in the ML
-   // BP_start_pos+1, because the previous BP is the closing one of the ML!!
+   int i;
+   int rows = ctx->numBP+1;
+   size_t trace_size = 0;
+   char* block;
 
-   while (ElementStruct[pos] != '(')
-      pos++;
+   for (i=0; i<rows; i++)
+      trace_size += 6*Maximum(1,ctx->BP_Order[i][3]);
 
-   // searching the whole ML
-   while (multi)
+   block = (char*) malloc(sizeof(int[6])*rows + sizeof(int)*(rows+1) + trace_size);
+   if (block == NULL)
    {
-      // Stack starts
-      if ((ElementStruct[pos]=='(') && (ElementStruct[pos+1]=='S'))
-      {
-         k=0;
-         while (ElementStruct[pos+k+2] != '(')
-         {
-            help_num[k] = ElementStruct[pos+k+2];
-            k++;
-         }
-         help_num[k] = '\0';
-         stack_len += atoi(help_num);
-         bp_pos -= atoi(help_num);
-         pos += k+2;
-      }
-
-      // Stack ends
-      else if ((ElementStruct[pos]=='S') && (ElementStruct[pos-1]!='('))
-      {
-         k=0;
-         while (ElementStruct[pos+k+1] != ')')
-         {
-            help_num[k] = ElementStruct[pos+k+1];
-            k++;
-         }
-         help_num[k] = '\0';
-         stack_len -= atoi(help_num);
-         //count stems:
-         if (stack_len == 0)
-            stems++;
-         pos += k+2; // k+2, since the closing bracket has to be jumped
-      }
-
-      // new ML begins
-      else if ((ElementStruct[pos]=='(') && (ElementStruct[pos+1]=='M'))
-      {
-         // bp_pos stays as it is, since the previous BP is the closing one of the ML
-         pos_return = StemsInML(pos,bp_pos);
-         pos = pos_return[0] + 1;
-         bp_pos = pos_return[1];
-      }
-
-      // current ML ends
-      else if ((ElementStruct[pos]=='M') && (ElementStruct[pos-1]!='('))
-      {
-         multi = false;
-         while (ElementStruct[pos] != ')')
-            pos++;
-      }
-
-      else
-         pos++;
+      cerr << "Not enough memory for the initializing step!\n";
+      exit(1);
    }
-   BP_Order[BP_start_pos+1][3] = stems;  //BP_start_pos+1, because the previous BP is the closing one of the ML
-   pos_return[0] = pos;
-   pos_return[1] = bp_pos;
-
-   return pos_return;
+   ctx->D = (int (*)[6]) block;
+   ctx->Trace_Start = (int*) (block + sizeof(int[6])*rows);
+   ctx->Trace = (signed char*) (ctx->Trace_Start + rows+1);
+
+   ctx->Trace_Start[0] = 0;
+   for (i=0; i<rows; i++)
+      ctx->Trace_Start[i+1] = ctx->Trace_Start[i] + 6*Maximum(1,ctx->BP_Order[i][3]);
+   memset(ctx->D, 0, sizeof(int[6])*rows);
+   memset(ctx->Trace, -1, trace_size);   // field without a predecessor are initialized with -1
 }
 
 
@@ -215,91 +97,51 @@ int* StemsInML(int first_pos, int BP_start_pos)  // first_pos is the pos. in Ele
 
 *************************************************/
 
-float Recursion()
+float Recursion(DesignContext* ctx)
 {
-   int anz_vorgaenger; //number of predecessors for a BP (only for a ML more than one)
    int min_vorgaenger; //assignment of the predecessor than gives the minimal energy for the current BP
    int* best_int_seq; // designed sequence
-   double energy_help;
+   int energy_help;
+
+   // the minima of the small loops are shared by all designs
+   Init_LoopMemos();
 
    // one row more allocated than numBP, since the last row correponds to the dang. ends
    /*i.e.:    bp_i - bp_j                    bp_i - bp_j
          closing_i - closing_j freebase closing_i - closing_j free_base*/
-   D = (double**) malloc(sizeof(double*)*(numBP+1));
-   Trace = (int****) malloc(sizeof(int***)*(numBP+1));
-   for (int i=0; i<numBP+1; i++)
-   {
-      D[i] = (double*) malloc(sizeof(double)*6);
-      Trace[i] = (int***) malloc(sizeof(int**)*6);
-
-      anz_vorgaenger = Maximum(1,BP_Order[i][3]);
+   alloc_Recursion(ctx);
 
-      for (int j=0; j<6; j++)
-      {
-         D[i][j] = 0.0;
-         //as much space allocated as the BP has predecessors
-         Trace[i][j] = (int**) malloc(sizeof(int*)*anz_vorgaenger);
-         for ( int k=0; k<anz_vorgaenger; k++)
-         {
-            Trace[i][j][k] = (int*) malloc(sizeof(int)*2);
-            for (int u=0; u<2; u++)
-               Trace[i][j][k][u] = -1;   // field without a predecessor are initialized with -1
-         }
-      }
-   }
-
-   bool new_stem = true;
-   double min = MAX_DOUBLE;
+   int min = MAX_ENERGY;
    int loop_size, left_loop_size, right_loop_size;
    int bp_i, bp_j;
-   vector <int> stem_ends; // pos. in BP_Order of the last BPs in stems
    int bp_pos;
 
    // for each base pair: test all assignments
-   for (bp_pos=0; bp_pos<numBP; bp_pos++)
+   for (bp_pos=0; bp_pos<ctx->numBP; bp_pos++)
    {
-      if (new_stem)
+      if (ctx->loops->type[bp_pos] == LOOP_HAIRPIN)
       {
-         if (bp_pos == 0)
+         loop_size = ctx->BP_Order[bp_pos][1]-ctx->BP_Order[bp_pos][0]-1;
+         for (int bp_assign=0; bp_assign<6; bp_assign++)
          {
-            loop_size = BP_Order[bp_pos][1]-BP_Order[bp_pos][0]-1;
-            for (int bp_assign=0; bp_assign<6; bp_assign++)
-            {
-               BP2_2(bp_assign, bp_i, bp_j);
-               D[bp_pos][bp_assign] = Sum_MaxDouble3(BestHairpinLoopEnergy(bp_pos,loop_size, bp_i, bp_j), Zero_or_StemEndAU(bp_pos, bp_assign), PairPenalty(bp_pos, bp_i, bp_j));
-               //nothing is stored in the traceback, since there is no predecessor
-            }
+            BP2_2(bp_assign, bp_i, bp_j);
+            ctx->D[bp_pos][bp_assign] = Sum_MaxEnergy3(BestHairpinLoopEnergy(ctx, bp_pos,loop_size, bp_i, bp_j), Zero_or_StemEndAU(ctx, bp_pos, bp_assign), PairPenalty(ctx, bp_pos, bp_i, bp_j));
+            //nothing is stored in the traceback, since there is no predecessor
          }
-         else
-         {
-            if (BP_Order[bp_pos][1] < BP_Order[bp_pos-1][0]) //hairpin_loop
-            {
-               stem_ends.push_back(bp_pos-1); //previous BP is the last one in a stem
-               loop_size = BP_Order[bp_pos][1]-BP_Order[bp_pos][0]-1;
-               for (int bp_assign=0; bp_assign<6; bp_assign++)
-               {
-                  BP2_2(bp_assign, bp_i, bp_j);
-                  D[bp_pos][bp_assign] = Sum_MaxDouble3(BestHairpinLoopEnergy(bp_pos,loop_size, bp_i, bp_j), Zero_or_StemEndAU(bp_pos, bp_assign), PairPenalty(bp_pos, bp_i, bp_j));
-                  //nothing is stored in the traceback, since there is no predecessor
-               }
-            }
-
-            else //closing BP of a ML
-            {
-               MLBestEnergy(bp_pos, stem_ends);
-            }
-         } // else bp_pos == 0
-         new_stem = false;
+      }
+      else if (ctx->loops->type[bp_pos] == LOOP_MULTI) //closing BP of a ML
+      {
+         MLBestEnergy(ctx, bp_pos);
       }
       else
       {
-         left_loop_size = BP_Order[bp_pos-1][0] - BP_Order[bp_pos][0] - 1;
-         right_loop_size = BP_Order[bp_pos][1] - BP_Order[bp_pos-1][1] - 1;
+         left_loop_size = LoopUnpaired(ctx->loops, bp_pos)[0];
+         right_loop_size = LoopUnpaired(ctx->loops, bp_pos)[1];
 
          for (int bp_assign=0; bp_assign<6; bp_assign++)
          {
             BP2_2(bp_assign, bp_i, bp_j);
-            min = MAX_DOUBLE;
+            min = MAX_ENERGY;
             min_vorgaenger = -1;
 
             // Stack
@@ -307,20 +149,19 @@ float Recursion()
             {
                for (int bp_before=0; bp_before < 6; bp_before++)
                {
-                  energy_help = Sum_MaxDouble(StackingEnergy(bp_i, bp_j, bp_before),D[bp_pos-1][bp_before]);
+                  energy_help = Sum_MaxEnergy(StackingEnergy(bp_i, bp_j, bp_before),ctx->D[bp_pos-1][bp_before]);
                   if (min > energy_help)
                   {
                      min = energy_help;
                      min_vorgaenger = bp_before;
                   }
                }
-               D[bp_pos][bp_assign] = Sum_MaxDouble3(min, Zero_or_StemEndAU(bp_pos, bp_assign), PairPenalty(bp_pos, bp_i, bp_j));
-               Trace[bp_pos][bp_assign][0][0] = bp_pos-1;
-               //if all assignments of the predecessor are set to MAX_DOUBLE, choose an assignment of the predecessor randomly
-               if (min == MAX_DOUBLE)
-                  Trace[bp_pos][bp_assign][0][1] = RandomBasePair();
+               ctx->D[bp_pos][bp_assign] = Sum_MaxEnergy3(min, Zero_or_StemEndAU(ctx, bp_pos, bp_assign), PairPenalty(ctx, bp_pos, bp_i, bp_j));
+               //if all assignments of the predecessor are set to MAX_ENERGY, choose an assignment of the predecessor randomly
+               if (min == MAX_ENERGY)
+                  TraceAssign(ctx, bp_pos, bp_assign, 0) = RandomBasePair(ctx->rng);
                else
-                  Trace[bp_pos][bp_assign][0][1] = min_vorgaenger;
+                  TraceAssign(ctx, bp_pos, bp_assign, 0) = min_vorgaenger;
             }
 
             // left bulge
@@ -328,20 +169,19 @@ float Recursion()
             {
                for (int bp_before=0; bp_before < 6; bp_before++)
                {
-                  energy_help = Sum_MaxDouble(BulgeEnergy(left_loop_size, bp_i, bp_j, bp_before), D[bp_pos-1][bp_before]);
+                  energy_help = Sum_MaxEnergy(BulgeEnergy(left_loop_size, bp_i, bp_j, bp_before), ctx->D[bp_pos-1][bp_before]);
                   if (min > energy_help)
                   {
                      min = energy_help;
                      min_vorgaenger = bp_before;
                   }
                }
-               D[bp_pos][bp_assign] = Sum_MaxDouble3(min, Zero_or_StemEndAU(bp_pos, bp_assign), PairPenalty(bp_pos, bp_i, bp_j));
-               Trace[bp_pos][bp_assign][0][0] = bp_pos-1;
-               //if all assignments of the predecessor are set to MAX_DOUBLE, choose an assignment of the predecessor randomly
-               if (min == MAX_DOUBLE)
-                  Trace[bp_pos][bp_assign][0][1] = RandomBasePair();
+               ctx->D[bp_pos][bp_assign] = Sum_MaxEnergy3(min, Zero_or_StemEndAU(ctx, bp_pos, bp_assign), PairPenalty(ctx, bp_pos, bp_i, bp_j));
+               //if all assignments of the predecessor are set to MAX_ENERGY, choose an assignment of the predecessor randomly
+               if (min == MAX_ENERGY)
+                  TraceAssign(ctx, bp_pos, bp_assign, 0) = RandomBasePair(ctx->rng);
                else
-                  Trace[bp_pos][bp_assign][0][1] = min_vorgaenger;
+                  TraceAssign(ctx, bp_pos, bp_assign, 0) = min_vorgaenger;
             }
 
             // right bulge
@@ -349,20 +189,19 @@ float Recursion()
             {
                for (int bp_before=0; bp_before < 6; bp_before++)
                {
-                  energy_help = Sum_MaxDouble(BulgeEnergy(right_loop_size, bp_i, bp_j, bp_before), D[bp_pos-1][bp_before]);
+                  energy_help = Sum_MaxEnergy(BulgeEnergy(right_loop_size, bp_i, bp_j, bp_before), ctx->D[bp_pos-1][bp_before]);
                   if (min > energy_help)
                   {
                      min = energy_help;
                      min_vorgaenger = bp_before;
                   }
                }
-               D[bp_pos][bp_assign] = Sum_MaxDouble3(min, Zero_or_StemEndAU(bp_pos, bp_assign), PairPenalty(bp_pos, bp_i, bp_j));
-               Trace[bp_pos][bp_assign][0][0] = bp_pos-1;
-               //if all assignments of the predecessor are set to MAX_DOUBLE, choose an assignment of the predecessor randomly
-               if (min == MAX_DOUBLE)
-                  Trace[bp_pos][bp_assign][0][1] = RandomBasePair();
+               ctx->D[bp_pos][bp_assign] = Sum_MaxEnergy3(min, Zero_or_StemEndAU(ctx, bp_pos, bp_assign), PairPenalty(ctx, bp_pos, bp_i, bp_j));
+               //if all assignments of the predecessor are set to MAX_ENERGY, choose an assignment of the predecessor randomly
+               if (min == MAX_ENERGY)
+                  TraceAssign(ctx, bp_pos, bp_assign, 0) = RandomBasePair(ctx->rng);
                else
-                  Trace[bp_pos][bp_assign][0][1] = min_vorgaenger;
+                  TraceAssign(ctx, bp_pos, bp_assign, 0) = min_vorgaenger;
             }
 
             // interior loop
@@ -370,32 +209,29 @@ float Recursion()
             {
                for (int bp_before=0; bp_before < 6; bp_before++)
                {
-                  energy_help = Sum_MaxDouble(BestInteriorLoopEnergy(bp_pos, left_loop_size, right_loop_size, bp_i, bp_j, bp_before),D[bp_pos-1][bp_before]);
+                  energy_help = Sum_MaxEnergy(BestInteriorLoopEnergy(ctx, bp_pos, left_loop_size, right_loop_size, bp_i, bp_j, bp_before),ctx->D[bp_pos-1][bp_before]);
                   if (min > energy_help)
                   {
                      min = energy_help;
                      min_vorgaenger = bp_before;
                   }
                }
-               D[bp_pos][bp_assign] = Sum_MaxDouble3(min, Zero_or_StemEndAU(bp_pos, bp_assign), PairPenalty(bp_pos, bp_i, bp_j));
-               Trace[bp_pos][bp_assign][0][0] = bp_pos-1;
-               //if all assignments of the predecessor are set to MAX_DOUBLE, choose an assignment of the predecessor randomly
-               if (min == MAX_DOUBLE)
-                  Trace[bp_pos][bp_assign][0][1] = RandomBasePair();
+               ctx->D[bp_pos][bp_assign] = Sum_MaxEnergy3(min, Zero_or_StemEndAU(ctx, bp_pos, bp_assign), PairPenalty(ctx, bp_pos, bp_i, bp_j));
+               //if all assignments of the predecessor are set to MAX_ENERGY, choose an assignment of the predecessor randomly
+               if (min == MAX_ENERGY)
+                  TraceAssign(ctx, bp_pos, bp_assign, 0) = RandomBasePair(ctx->rng);
                else
-                  Trace[bp_pos][bp_assign][0][1] = min_vorgaenger;
+                  TraceAssign(ctx, bp_pos, bp_assign, 0) = min_vorgaenger;
             }
          } // end for bp_assign
-      } // end if else stem_end
-      if (StackEnd(bp_pos))
-         new_stem = true;
+      } // end if else loop type
    }
 
    /*************************************************************************/
    /* DANGLING ENDS*/
    //= external loop
 
-   externBestEnergy();
+   externBestEnergy(ctx);
 
    /*************************************************************************/
 
@@ -420,30 +256,31 @@ float Recursion()
       for (int j=0; j<6; j++)
       {
          cout << "(";
-         for (int k=0; k<Maximum(BP_Order[i][3],1); k++)
-            cout << "(" << Trace[i][j][k][0] << "," << Trace[i][j][k][1] << "),";
+         for (int k=0; k<Maximum(ctx->BP_Order[i][3],1); k++)
+            cout << "(" << LoopStemList(ctx->loops, i)[k] << "," << (int)TraceAssign(ctx, i, j, k) << "),";
          cout << ")  ";
       }
       cout << endl;
    }*/
 
-   best_int_seq = Traceback();
+   best_int_seq = Traceback(ctx);
 
    // all bases that are still set to -1 (after traceback), are free bases in a ML or external loop that are not adjacent to a stem
    // their assignments can be chosen randomly
-   for (int i=0; i<struct_len; i++)
+   for (int i=0; i<ctx->struct_len; i++)
       if (best_int_seq[i] == -1)
-         best_int_seq[i] = SetFreeBase(i);
+         best_int_seq[i] = SetFreeBase(ctx, i);
 
-   best_char_seq = (char*) malloc(sizeof(char)*(struct_len+1));
-   for (int i=0; i<struct_len; i++)
-      best_char_seq[i] = int2char(best_int_seq[i]);
-   best_char_seq[struct_len] = '\0';
+   ctx->best_char_seq = (char*) malloc(sizeof(char)*(ctx->struct_len+1));
+   for (int i=0; i<ctx->struct_len; i++)
+      ctx->best_char_seq[i] = int2char(best_int_seq[i]);
+   ctx->best_char_seq[ctx->struct_len] = '\0';
+   free(best_int_seq);
 
-   double* min_result;  //best value in D and its coordinate in the last row
-   min_result = MiniVec(D[numBP], 6);
+   int min_result[2];  //best value in D and its coordinate in the last row
+   MiniVec(ctx->D[ctx->numBP], 6, min_result);
 
-   return min_result[1];
+   return min_result[1]/100.0;
 }
 
 
@@ -455,66 +292,62 @@ float Recursion()
  *****************************************************************************
  ****************************************************************************/
 
-int* Traceback()
+int* Traceback(DesignContext* ctx)
 {
-   int seq_len = strlen(brackets);
+   int seq_len = strlen(ctx->brackets);
    int* int_seq;
    int_seq = (int*) malloc(sizeof(int)*seq_len);
    for (int i=0; i<seq_len; i++)
       int_seq[i] = -1;
 
-   double* min_result;  //best value in D and its coordinate in the last row
-   min_result = MiniVec(D[numBP], 6);
+   int min_result[2];  //best value in D and its coordinate in the last row
+   MiniVec(ctx->D[ctx->numBP], 6, min_result);
 
    int bp_assign, bp_assign_i, bp_assign_j, min_i=0, min_j=0, min_i2=0, min_j2=0, min1=0, min2=0, min3=0, min4=0;
    int bp_i, bp_j;
    bool hairpin_loop;       // indicates, whether we are at a pos. where a HL begins
    bool valid_hairpin_loop; // indicates, whether a valid assignment is found
    int left_loop_size, right_loop_size, hairpin_loop_size;
-   double energy, min=0;
+   int energy, min=0;
 
-   int pair_size, base_size;
-   unsigned int i;
-   vector< vector<int> > BaseConnections;     // contains all connections (conc. free bases)
-   vector< vector<int> > BasePairConnections; // contains all connections (conc. stems)
+   int pair_size, base_size, c;
+   const LoopIndex* loops = ctx->loops;
+   const int* base_connection;   // free bases of a connection of a ML or the external loop
+   const int* pair_connection;   // its stems
    int** bp_at_pair_connection;  // bp assignments for a connection
 
-   double base_energy, energy_help;
-
-   srand( time(NULL) );
+   int base_energy, energy_help;
 
    /*************************************************************************/
    /* DANGLING ENDS = external loop*/
    /*************************************************************************/
 
-   double min_dang;
+   int min_dang;
    int min_free_base;
-   //if in the last row all value are MAX_DOUBLE, a column is chosen randomly
-   if (min_result[0] == MAX_DOUBLE)
-      bp_assign = RandomBasePair();
+   //if in the last row all value are MAX_ENERGY, a column is chosen randomly
+   if (min_result[0] == MAX_ENERGY)
+      bp_assign = RandomBasePair(ctx->rng);
    else
       bp_assign = (int)min_result[0];
    BP2_2(bp_assign,bp_assign_i,bp_assign_j);
 
    // identify all predecessors and set assignments to int_seq
-   int* vorg;
-   vorg = (int*) malloc(sizeof(int)*BP_Order[numBP][3]);
-   for (int vg=0; vg<Maximum(BP_Order[numBP][3],1); vg++)
+   const int* vorg = LoopStemList(loops, ctx->numBP);
+   for (int vg=0; vg<Maximum(ctx->BP_Order[ctx->numBP][3],1); vg++)
    {
-      vorg[vg] = Trace[numBP][bp_assign][vg][0];
-      BP2_2(Trace[numBP][bp_assign][vg][1],bp_i,bp_j);
-      int_seq[BP_Order[vorg[vg]][0]] = bp_i;
-      int_seq[BP_Order[vorg[vg]][1]] = bp_j;
+      BP2_2(TraceAssign(ctx, ctx->numBP, bp_assign, vg),bp_i,bp_j);
+      int_seq[ctx->BP_Order[vorg[vg]][0]] = bp_i;
+      int_seq[ctx->BP_Order[vorg[vg]][1]] = bp_j;
    }
 
    // if there are free bases upstream to the first opening bracket:
-   if (BP_Order[numBP-1][0] > 0)
+   if (ctx->BP_Order[ctx->numBP-1][0] > 0)
    {
-      min_dang = MAX_DOUBLE;
+      min_dang = MAX_ENERGY;
       min_free_base = -1;
       for (int free_base = 0; free_base < 4; free_base++)
       {
-         base_energy = Sum_MaxDouble(single_base_stacking_energy[64+16*bp_assign_j+4*bp_assign_i+free_base],BasePenalty(BP_Order[numBP-1][0]-1,free_base));
+         base_energy = Sum_MaxEnergy(single_base_stacking_energy[64+16*bp_assign_j+4*bp_assign_i+free_base],BasePenalty(ctx, ctx->BP_Order[ctx->numBP-1][0]-1,free_base));
          if (min_dang > base_energy)
          {
             min_dang = base_energy;
@@ -522,21 +355,20 @@ int* Traceback()
          }
       }
 
-      int_seq[BP_Order[numBP-1][0]-1] = min_free_base;
+      int_seq[ctx->BP_Order[ctx->numBP-1][0]-1] = min_free_base;
       //if there are still free bases upstream:
-      if (BP_Order[numBP-1][0] > 1)
-         for (int vor=0; vor < BP_Order[numBP][0]-1; vor++)
-            int_seq[vor] = SetFreeBase(vor);
+      if (ctx->BP_Order[ctx->numBP-1][0] > 1)
+         for (int vor=0; vor < ctx->BP_Order[ctx->numBP][0]-1; vor++)
+            int_seq[vor] = SetFreeBase(ctx, vor);
    }
 
    // if there are free bases downstresm the last closing bracket:
-   if (BP_Order[numBP-1][1] < (int)strlen(brackets)-1)
+   if (ctx->BP_Order[ctx->numBP-1][1] < (int)strlen(ctx->brackets)-1)
    {
-         EndConnections(BP_Order[numBP][3], vorg, BaseConnections, BasePairConnections);
-
-         for (i=0; i<BaseConnections.size(); i++) //BaseConnections.size() == BasePairConnections.size()
+         for (c=loops->conn_start[ctx->numBP]; c<loops->conn_start[ctx->numBP+1]; c++)
          {
-            pair_size = BasePairConnections[i].size();
+            pair_size = ConnPairSize(loops, c);
+            pair_connection = ConnPairList(loops, c);
 
             bp_at_pair_connection = (int**) malloc(sizeof(int*)*pair_size);
             for (int a=0; a<pair_size; a++)
@@ -550,35 +382,30 @@ int* Traceback()
             for (int bp=0; bp<pair_size; bp++)
             {
                //find assignments already set to int_seq
-               bp_at_pair_connection[bp][0] = int_seq[BP_Order[BasePairConnections[i][bp]][0]];
-               bp_at_pair_connection[bp][1] = int_seq[BP_Order[BasePairConnections[i][bp]][1]];
+               bp_at_pair_connection[bp][0] = int_seq[ctx->BP_Order[pair_connection[bp]][0]];
+               bp_at_pair_connection[bp][1] = int_seq[ctx->BP_Order[pair_connection[bp]][1]];
             }
 
             int* best_end_connection_bases;
-            best_end_connection_bases = EndConnectionBestFreeBases(BaseConnections[i], BasePairConnections[i], (const int**) bp_at_pair_connection);
+            base_size = ConnBaseSize(loops, c);
+            base_connection = ConnBaseList(loops, c);
+            best_end_connection_bases = EndConnectionBestFreeBases(ctx, base_connection, base_size, pair_connection, pair_size, (const int**) bp_at_pair_connection);
 
-            base_size = BaseConnections[i].size();
             for (int pos=0; pos<base_size; pos++)
-               int_seq[BaseConnections[i][pos]] = best_end_connection_bases[pos];
-
-            for (int c=0; c<pair_size; c++)
-               free(bp_at_pair_connection[c]);
-
-         } // for i
+               int_seq[base_connection[pos]] = best_end_connection_bases[pos];
 
-         for (i=0; i<BaseConnections.size(); i++)
-            BaseConnections[i].clear();
-         BaseConnections.clear();
+            for (int a=0; a<pair_size; a++)
+               free(bp_at_pair_connection[a]);
+            free(bp_at_pair_connection);
+            free(best_end_connection_bases);
 
-         for (i=0; i<BasePairConnections.size(); i++)
-            BasePairConnections[i].clear();
-         BasePairConnections.clear();
+         } // for c
    }
 
    /*************************************************************************/
    /*************************************************************************/
 
-   for (int bp_pos=numBP-1; bp_pos>-1; bp_pos--)
+   for (int bp_pos=ctx->numBP-1; bp_pos>-1; bp_pos--)
    {
       /*Traceback is done stepwise, base pair per base pair. Usually, the previous BP in BP_Order
       is the predecessor of the current one, except for MLs! MLs have more than one predecessors.
@@ -592,20 +419,20 @@ int* Traceback()
 
       /*************************************************************************/
 
-      bp_assign = BP2int(int_seq[BP_Order[bp_pos][0]],int_seq[BP_Order[bp_pos][1]]);
+      bp_assign = BP2int(int_seq[ctx->BP_Order[bp_pos][0]],int_seq[ctx->BP_Order[bp_pos][1]]);
       hairpin_loop = false;
 
-      int bp_pos_i = BP_Order[bp_pos][0];
-      int bp_pos_j = BP_Order[bp_pos][1];
+      int bp_pos_i = ctx->BP_Order[bp_pos][0];
+      int bp_pos_j = ctx->BP_Order[bp_pos][1];
 
       //finding the assignments of the predecessors and store in int_seq
-      for (int vg=0; vg<Maximum(BP_Order[bp_pos][3],1); vg++)
+      for (int vg=0; vg<Maximum(ctx->BP_Order[bp_pos][3],1); vg++)
       {
-         if (Trace[bp_pos][bp_assign][vg][1] != -1) //i.e. it has a predecessor (no closing BP of a HL)
+         if (TraceAssign(ctx, bp_pos, bp_assign, vg) != -1) //i.e. it has a predecessor (no closing BP of a HL)
          {
-            BP2_2(Trace[bp_pos][bp_assign][vg][1], bp_i, bp_j);
-            int_seq[BP_Order[Trace[bp_pos][bp_assign][vg][0]][0]] = bp_i;
-            int_seq[BP_Order[Trace[bp_pos][bp_assign][vg][0]][1]] = bp_j;
+            BP2_2(TraceAssign(ctx, bp_pos, bp_assign, vg), bp_i, bp_j);
+            int_seq[ctx->BP_Order[LoopStemList(loops, bp_pos)[vg]][0]] = bp_i;
+            int_seq[ctx->BP_Order[LoopStemList(loops, bp_pos)[vg]][1]] = bp_j;
          }
          else //a HL follows
          {
@@ -624,7 +451,7 @@ int* Traceback()
       if (hairpin_loop)
       {
          //find loop size:
-         hairpin_loop_size = BP_Order[bp_pos][1] - BP_Order[bp_pos][0] - 1;
+         hairpin_loop_size = ctx->BP_Order[bp_pos][1] - ctx->BP_Order[bp_pos][0] - 1;
          if (hairpin_loop_size == 3)
          {
             // in case of a triloop, the energy only depends on the size (=3), exceptions: CCC => +1.4; GGG => -2.2
@@ -633,34 +460,34 @@ int* Traceback()
             {
                //finding an assignment
                for (int pos=1; pos<=3; pos++)
-                  int_seq[bp_pos_i+pos] = SetFreeBase(bp_pos_i+pos);
+                  int_seq[bp_pos_i+pos] = SetFreeBase(ctx, bp_pos_i+pos);
 
                //test, whether the assignment gives the energy that is stored in D (done for making the CCC-loop valid)
                //penalties for AU-closingBP and GU-closingBP and CCC-Loop, negative penalty for GGG-Loop (GGG missed out, since also done in Vienna Package)
                energy = loop_destabilizing_energies[3*hairpin_loop_size-1];
 
                // not energy fragment for the closing BP, but penalties for it and the bases in the loop
-               energy_help = Sum_MaxDouble4(BasePenalty(bp_pos_i+1,int_seq[bp_pos_i+1]), BasePenalty(bp_pos_i+2,int_seq[bp_pos_i+2]), BasePenalty(bp_pos_i+3,int_seq[bp_pos_i+3]), PairPenalty(bp_pos, bp_assign_i, bp_assign_j));
+               energy_help = Sum_MaxEnergy4(BasePenalty(ctx, bp_pos_i+1,int_seq[bp_pos_i+1]), BasePenalty(ctx, bp_pos_i+2,int_seq[bp_pos_i+2]), BasePenalty(ctx, bp_pos_i+3,int_seq[bp_pos_i+3]), PairPenalty(ctx, bp_pos, bp_assign_i, bp_assign_j));
 
-               energy = Sum_MaxDouble(energy_help,energy);
+               energy = Sum_MaxEnergy(energy_help,energy);
 
                if ((bp_assign == 0) || (bp_assign == 3) || (bp_assign == 4) || (bp_assign == 5))
-                  energy = Sum_MaxDouble(energy,terminalAU);
+                  energy = Sum_MaxEnergy(energy,energy_tables.terminalAU);
 
                if ((int_seq[bp_pos_i+1] == 1) && (int_seq[bp_pos_i+2] == 1) && (int_seq[bp_pos_i+3] == 1))
-                  energy = Sum_MaxDouble(energy,Ctriloop);
+                  energy = Sum_MaxEnergy(energy,Ctriloop);
                //else if ((int_seq[BP_Order[bp_pos][0]+1] == 2) && (int_seq[BP_Order[bp_pos][0]+2] == 2) && (int_seq[BP_Order[bp_pos][0]+3] == 2))
-               //   energy = Sum_MaxDouble(energy,Gtriloop);
+               //   energy = Sum_MaxEnergy(energy,Gtriloop);
 
                //terminal mismatch energy, if the HLclosing BP is the last one in a stem
-               if ((StackEnd(bp_pos)) && ((bp_assign == 0) || (bp_assign == 3) || (bp_assign == 4) || (bp_assign == 5)))
-                  energy = Sum_MaxDouble(energy,terminalAU);
+               if ((StackEnd(ctx, bp_pos)) && ((bp_assign == 0) || (bp_assign == 3) || (bp_assign == 4) || (bp_assign == 5)))
+                  energy = Sum_MaxEnergy(energy,energy_tables.terminalAU);
 
                //test, whether HL is valid
-               if (D[bp_pos][bp_assign] == energy)
+               if (ctx->D[bp_pos][bp_assign] == energy)
                   valid_hairpin_loop = true;
                // dealing with GGG triloops, missed out, since also done in Vienna Package
-               /*else if (Sum_MaxDouble(D[bp_pos][bp_assign], Gtriloop) == energy)
+               /*else if (Sum_MaxEnergy(D[bp_pos][bp_assign], Gtriloop) == energy)
                {
                   int_seq[BP_Order[bp_pos][0]+1] = 2;
                   int_seq[BP_Order[bp_pos][0]+2] = 2;
@@ -671,12 +498,6 @@ int* Traceback()
          }
          else if (hairpin_loop_size == 4)
          {
-            //allocate memory and assign BP
-            char* tetra_plus_closing;
-            tetra_plus_closing = (char*) malloc(sizeof(char)*6);
-            tetra_plus_closing[0] = int2char(bp_assign_i);
-            tetra_plus_closing[5] = int2char(bp_assign_j);
-
             energy = loop_destabilizing_energies[3*hairpin_loop_size-1];
 
             // consider all cases of the tetraloop (4*4*4*4) and add term-mismatch and
@@ -687,27 +508,21 @@ int* Traceback()
             //     bp_i-bp_j
             //       .   .
 
-            min = MAX_DOUBLE;
+            min = MAX_ENERGY;
             for (int i=0; i<4; i++)
                for (int j=0; j<4; j++)
                   for (int i2=0; i2<4; i2++)
                      for (int j2=0; j2<4; j2++)
                      {
-                        energy_help = Sum_MaxDouble4(BasePenalty(bp_pos_i+1,i), BasePenalty(bp_pos_i+2,i2), BasePenalty(bp_pos_j-2,j2),BasePenalty(bp_pos_j-1,j));
-
-                        tetra_plus_closing[1] = int2char(i);
-                        tetra_plus_closing[2] = int2char(i2);
-                        tetra_plus_closing[3] = int2char(j2);
-                        tetra_plus_closing[4] = int2char(j);
-
-                        energy_help = Sum_MaxDouble3(energy_help, tetra_loop_energy(tetra_plus_closing), mismatch_energies_hairpin[64*bp_assign_i+16*i+4*bp_assign_j+j]);
+                        energy_help = Sum_MaxEnergy4(BasePenalty(ctx, bp_pos_i+1,i), BasePenalty(ctx, bp_pos_i+2,i2), BasePenalty(ctx, bp_pos_j-2,j2),BasePenalty(ctx, bp_pos_j-1,j));
+                        energy_help = Sum_MaxEnergy3(energy_help, tetra_loop_energy(TETRA_INDEX(bp_assign_i,i,i2,j2,j,bp_assign_j)), mismatch_energies_hairpin[64*bp_assign_i+16*i+4*bp_assign_j+j]);
 
                         // If the HPLoop would only consist of C's, a penalty of 0.3*size+1.6 has to be added.
                         // This means that just in case that all bases in the loop are restricted to C by the
                         // constraints the energy has to be corrected.
                         // NOT TAKEN INTO ACCOUNT, SINCE THIS IS NOT TAKEN INTO ACCOUNT IN THE VIENNA PACKAGE AS WELL.
                         //if ((i==1) && (i2==1) && (j2==1) && (j==1))
-                        //   energy_help = Sum_MaxDouble(energy_help,0.3*hairpin_loop_size+1.6);
+                        //   energy_help = Sum_MaxEnergy(energy_help,0.3*hairpin_loop_size+1.6);
 
                         if (energy_help < min)
                         {
@@ -719,16 +534,15 @@ int* Traceback()
                         }
                      }
 
-            energy = Sum_MaxDouble(energy,min);
+            energy = Sum_MaxEnergy(energy,min);
             int_seq[bp_pos_i+1] = min_i;
             int_seq[bp_pos_i+2] = min_i2;
             int_seq[bp_pos_j-2] = min_j2;
             int_seq[bp_pos_j-1] = min_j;
-            free(tetra_plus_closing);
 
             //terminal mismatch energy, if the HLclosing BP is the last one in a stem
-            if ((StackEnd(bp_pos)) && ((bp_assign == 0) || (bp_assign == 3) || (bp_assign == 4) || (bp_assign == 5)))
-               energy = Sum_MaxDouble(energy,terminalAU);
+            if ((StackEnd(ctx, bp_pos)) && ((bp_assign == 0) || (bp_assign == 3) || (bp_assign == 4) || (bp_assign == 5)))
+               energy = Sum_MaxEnergy(energy,energy_tables.terminalAU);
          }
          else //>4
          {
@@ -736,14 +550,14 @@ int* Traceback()
             {
                energy = loop_destabilizing_energies[3*Minimum(hairpin_loop_size,30)-1];
                if (hairpin_loop_size > 30)
-                  energy += 1.75*RT*log((double)(hairpin_loop_size/30.0));
+                  energy += LoopExtrapolation(hairpin_loop_size);
 
-               min = MAX_DOUBLE;
+               min = MAX_ENERGY;
                for (int i=0; i<4; i++)
                   for (int j=0; j<4; j++)
                   {
                      // no energy fragment by the closing BP, but penalties have to be taken into account
-                     energy_help = Sum_MaxDouble4(BasePenalty(bp_pos_i+1,i), BasePenalty(bp_pos_j-1,j), PairPenalty(bp_pos, bp_assign_i, bp_assign_j), mismatch_energies_hairpin[64*bp_assign_i+16*i+4*bp_assign_j+j]);
+                     energy_help = Sum_MaxEnergy4(BasePenalty(ctx, bp_pos_i+1,i), BasePenalty(ctx, bp_pos_j-1,j), PairPenalty(ctx, bp_pos, bp_assign_i, bp_assign_j), mismatch_energies_hairpin[64*bp_assign_i+16*i+4*bp_assign_j+j]);
 
                      if (energy_help < min)
                      {
@@ -753,14 +567,14 @@ int* Traceback()
                      }
                   }
 
-               energy = Sum_MaxDouble(energy,min);
+               energy = Sum_MaxEnergy(energy,min);
                int_seq[bp_pos_i+1] = min_i;
                int_seq[bp_pos_j-1] = min_j;
 
                //find an assignment for the loop (the first and the last base are fixed by min. terminal mismatch,
                //thus, starting at the second pos. end at the last but one pos.
                for (int pos=2; pos<=hairpin_loop_size-1; pos++)
-                  int_seq[bp_pos_i+pos] = SetFreeBase(bp_pos_i+pos);
+                  int_seq[bp_pos_i+pos] = SetFreeBase(ctx, bp_pos_i+pos);
 
                // If the HPLoop would only consist of C's, a penalty of 0.3*size+1.6 has to be added.
                // NOT TAKEN INTO ACCOUNT, SINCE THIS IS NOT TAKEN INTO ACCOUNT IN THE VIENNA PACKAGE AS WELL.
@@ -774,13 +588,13 @@ int* Traceback()
                //    }
 
                // if (onlyCs)
-               //    energy = Sum_MaxDouble(energy,0.3*hairpin_loop_size+1.6);
+               //    energy = Sum_MaxEnergy(energy,0.3*hairpin_loop_size+1.6);
 
                //terminal mismatch energy, if the HLclosing BP is the last one in a stem
-               if ((StackEnd(bp_pos)) && ((bp_assign == 0) || (bp_assign == 3) || (bp_assign == 4) || (bp_assign == 5)))
-                  energy = Sum_MaxDouble(energy,terminalAU);
+               if ((StackEnd(ctx, bp_pos)) && ((bp_assign == 0) || (bp_assign == 3) || (bp_assign == 4) || (bp_assign == 5)))
+                  energy = Sum_MaxEnergy(energy,energy_tables.terminalAU);
 
-               if (D[bp_pos][bp_assign] == energy)
+               if (ctx->D[bp_pos][bp_assign] == energy)
                   valid_hairpin_loop = true;
             }
          }
@@ -791,20 +605,13 @@ int* Traceback()
       //MULTILOOP
       //*****************
       //fixed the assignments of the free bases in the ML
-      else if (BP_Order[bp_pos][3] > 1)
+      else if (ctx->BP_Order[bp_pos][3] > 1)
       {
-         int* ML_vorgaenger; // pos. in BP_Order of the BPs in the ML, = predecessors of the closing BP
-
-         // finding all stem ends of the ML (stored in the information in Trace)
-         vector <int> stem_ends;
-         for (int vg=BP_Order[bp_pos][3]-1; vg>=0; vg--)
-            stem_ends.push_back(Trace[bp_pos][bp_assign][vg][0]);
-
-         ML_vorgaenger = MultiLoopConnections(BP_Order[bp_pos][3], stem_ends, bp_pos, BaseConnections, BasePairConnections);
-
-         for (i=0; i<BaseConnections.size(); i++) //BaseConnections.size() == BasePairConnections.size()
+         // the connections of the ML are given by the loop index, the assignments of its stem ends are stored in int_seq
+         for (c=loops->conn_start[bp_pos]; c<loops->conn_start[bp_pos+1]; c++)
          {
-            pair_size = BasePairConnections[i].size();
+            pair_size = ConnPairSize(loops, c);
+            pair_connection = ConnPairList(loops, c);
 
             bp_at_pair_connection = (int**) malloc(sizeof(int*)*pair_size);
             for (int a=0; a<pair_size; a++)
@@ -817,37 +624,32 @@ int* Traceback()
             /* for bp_at_pair_connection choose the assignment given in Trace*/
             for (int bp=0; bp<pair_size; bp++)
             {
-               if (BasePairConnections[i][bp] == bp_pos)
+               if (pair_connection[bp] == bp_pos)
                {
                   bp_at_pair_connection[bp][0] = bp_assign_i;
                   bp_at_pair_connection[bp][1] = bp_assign_j;
                }
                else
                {
-                  bp_at_pair_connection[bp][0] = int_seq[BP_Order[BasePairConnections[i][bp]][0]];
-                  bp_at_pair_connection[bp][1] = int_seq[BP_Order[BasePairConnections[i][bp]][1]];
+                  bp_at_pair_connection[bp][0] = int_seq[ctx->BP_Order[pair_connection[bp]][0]];
+                  bp_at_pair_connection[bp][1] = int_seq[ctx->BP_Order[pair_connection[bp]][1]];
                }
             }
 
             int* best_connection_bases;
-            best_connection_bases = ConnectionBestFreeBases(BaseConnections[i], BasePairConnections[i], (const int**) bp_at_pair_connection);
+            base_size = ConnBaseSize(loops, c);
+            base_connection = ConnBaseList(loops, c);
+            best_connection_bases = ConnectionBestFreeBases(ctx, base_connection, base_size, pair_connection, pair_size, (const int**) bp_at_pair_connection);
 
-            base_size = BaseConnections[i].size();
             for (int pos=0; pos<base_size; pos++)
-               int_seq[BaseConnections[i][pos]] = best_connection_bases[pos];
-
-            for (int c=0; c<pair_size; c++)
-               free(bp_at_pair_connection[c]);
+               int_seq[base_connection[pos]] = best_connection_bases[pos];
 
-         } // for i
-
-         for (i=0; i<BaseConnections.size(); i++)
-            BaseConnections[i].clear();
-         BaseConnections.clear();
+            for (int a=0; a<pair_size; a++)
+               free(bp_at_pair_connection[a]);
+            free(bp_at_pair_connection);
+            free(best_connection_bases);
 
-         for (i=0; i<BasePairConnections.size(); i++)
-            BasePairConnections[i].clear();
-         BasePairConnections.clear();
+         } // for c
       }
 
       //*******************************************************************************************
@@ -856,8 +658,8 @@ int* Traceback()
       //************************************************************
       else if (bp_pos > 0) //then there are predecessors and BL or IL can arise
       {
-         left_loop_size = BP_Order[bp_pos-1][0] - BP_Order[bp_pos][0] - 1;
-         right_loop_size = BP_Order[bp_pos][1] - BP_Order[bp_pos-1][1] - 1;
+         left_loop_size = ctx->BP_Order[bp_pos-1][0] - ctx->BP_Order[bp_pos][0] - 1;
+         right_loop_size = ctx->BP_Order[bp_pos][1] - ctx->BP_Order[bp_pos-1][1] - 1;
 
          //STACK (do nothing, since there are no free bases)
          //*************
@@ -871,7 +673,7 @@ int* Traceback()
          {
             //whatever assignments of the bases in the BL ==> Constraints checked in SetFreeBase
             for (int pos=1; pos<=left_loop_size; pos++)
-               int_seq[BP_Order[bp_pos][0]+pos] = SetFreeBase(BP_Order[bp_pos][0]+pos);
+               int_seq[ctx->BP_Order[bp_pos][0]+pos] = SetFreeBase(ctx, ctx->BP_Order[bp_pos][0]+pos);
          }
 
          // RIGHT BULGE
@@ -880,7 +682,7 @@ int* Traceback()
          {
             //whatever assignments of the bases in the BL ==> Constraints checked in SetFreeBase
             for (int pos=1; pos<=right_loop_size; pos++)
-               int_seq[BP_Order[bp_pos-1][1]+pos] = SetFreeBase(BP_Order[bp_pos-1][1]+pos);
+               int_seq[ctx->BP_Order[bp_pos-1][1]+pos] = SetFreeBase(ctx, ctx->BP_Order[bp_pos-1][1]+pos);
          }
 
 
@@ -888,10 +690,10 @@ int* Traceback()
          //****************
          else
          {
-            int bp_before = Trace[bp_pos][bp_assign][0][1];
+            int bp_before = TraceAssign(ctx, bp_pos, bp_assign, 0);
             int bp_before_i, bp_before_j;
             BP2_2(bp_before,bp_before_i,bp_before_j);
-            min = MAX_DOUBLE;
+            min = MAX_ENERGY;
 
             // special cases:
             //****************************************************
@@ -900,7 +702,7 @@ int* Traceback()
                for (int x=0; x<4; x++)
                   for (int y=0; y<4; y++)
                   {
-                     energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+1,x), BasePenalty(bp_pos_j-1,y), interior_loop_1_1_energy[96*bp_assign+24*x+4*bp_before+y]);
+                     energy_help = Sum_MaxEnergy3(BasePenalty(ctx, bp_pos_i+1,x), BasePenalty(ctx, bp_pos_j-1,y), interior_loop_1_1_energy[96*bp_assign+24*x+4*bp_before+y]);
                      if (energy_help < min)
                      {
                         min = energy_help;
@@ -917,7 +719,7 @@ int* Traceback()
                   for (int y=0; y<4; y++)
                      for (int z=0; z<4; z++)
                      {
-                        energy_help = Sum_MaxDouble4(BasePenalty(bp_pos_i+1,x), BasePenalty(bp_pos_j-1,y), BasePenalty(bp_pos_j-2,z), interior_loop_1_2_energy[384*bp_assign+96*z+24*x+4*bp_before+y]);
+                        energy_help = Sum_MaxEnergy4(BasePenalty(ctx, bp_pos_i+1,x), BasePenalty(ctx, bp_pos_j-1,y), BasePenalty(ctx, bp_pos_j-2,z), interior_loop_1_2_energy[384*bp_assign+96*z+24*x+4*bp_before+y]);
                         if (energy_help < min)
                         {
                            min = energy_help;
@@ -936,7 +738,7 @@ int* Traceback()
                   for (int y=0; y<4; y++)
                      for (int z=0; z<4; z++)
                      {
-                        energy_help = Sum_MaxDouble4(BasePenalty(bp_pos_i+1,z), BasePenalty(bp_pos_i+2,y), BasePenalty(bp_pos_j-1,x), interior_loop_1_2_energy[384*bp_before+96*z+24*x+4*bp_assign+y]);
+                        energy_help = Sum_MaxEnergy4(BasePenalty(ctx, bp_pos_i+1,z), BasePenalty(ctx, bp_pos_i+2,y), BasePenalty(ctx, bp_pos_j-1,x), interior_loop_1_2_energy[384*bp_before+96*z+24*x+4*bp_assign+y]);
                         if (energy_help < min)
                         {
                            min = energy_help;
@@ -956,8 +758,8 @@ int* Traceback()
                      for (int y1=0; y1<4; y1++)
                         for (int y2=0; y2<4; y2++)
                         {
-                           energy_help = Sum_MaxDouble4(BasePenalty(bp_pos_i+1,x1), BasePenalty(bp_pos_i+2,y1), BasePenalty(bp_pos_j-1,x2), BasePenalty(bp_pos_j-2,y2));
-                           energy_help = Sum_MaxDouble(energy_help, interior_loop_2_2_energy[1536*bp_assign+256*bp_before+64*x1+16*x2+4*y1+y2]);
+                           energy_help = Sum_MaxEnergy4(BasePenalty(ctx, bp_pos_i+1,x1), BasePenalty(ctx, bp_pos_i+2,y1), BasePenalty(ctx, bp_pos_j-1,x2), BasePenalty(ctx, bp_pos_j-2,y2));
+                           energy_help = Sum_MaxEnergy(energy_help, interior_loop_2_2_energy[1536*bp_assign+256*bp_before+64*x1+16*x2+4*y1+y2]);
                            if (energy_help < min)
                            {
                               min = energy_help;
@@ -989,9 +791,9 @@ int* Traceback()
                      for (int i2=0; i2<4; i2++)
                        for (int i3=0; i3<4; i3++)
                        {
-                          energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+1,i1), BasePenalty(bp_pos_j-right_loop_size,i2), BasePenalty(bp_pos_j-1,i3));
+                          energy_help = Sum_MaxEnergy3(BasePenalty(ctx, bp_pos_i+1,i1), BasePenalty(ctx, bp_pos_j-right_loop_size,i2), BasePenalty(ctx, bp_pos_j-1,i3));
 
-                          energy_help = Sum_MaxDouble3(energy_help, mismatch_energies_interior[64*bp_before_j+16*i2+4*bp_before_i+i1],
+                          energy_help = Sum_MaxEnergy3(energy_help, mismatch_energies_interior[64*bp_before_j+16*i2+4*bp_before_i+i1],
                           mismatch_energies_interior[64*bp_assign_i+16*i1+4*bp_assign_j+i3]);
 
                           if (energy_help < min)
@@ -1009,7 +811,7 @@ int* Traceback()
 
                    //remaining bases are assigned randomly
                   for (int i=2; i<=right_loop_size-1; i++)
-                     int_seq[bp_pos_j-i] = SetFreeBase(bp_pos_j-i);
+                     int_seq[bp_pos_j-i] = SetFreeBase(ctx, bp_pos_j-i);
                }
 
                else if (right_loop_size == 1)//          bp_before_i - bp_before_j
@@ -1020,9 +822,9 @@ int* Traceback()
                      for (int i2=0; i2<4; i2++)
                         for (int i3=0; i3<4; i3++)
                         {
-                           energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+left_loop_size,i1), BasePenalty(bp_pos_i+1,i2), BasePenalty(bp_pos_j-1,i3));
+                           energy_help = Sum_MaxEnergy3(BasePenalty(ctx, bp_pos_i+left_loop_size,i1), BasePenalty(ctx, bp_pos_i+1,i2), BasePenalty(ctx, bp_pos_j-1,i3));
 
-                           energy_help = Sum_MaxDouble3(energy_help, mismatch_energies_interior[64*bp_before_j+16*i3+4*bp_before_i+i1], mismatch_energies_interior[64*bp_assign_i+16*i2+4*bp_assign_j+i3]);
+                           energy_help = Sum_MaxEnergy3(energy_help, mismatch_energies_interior[64*bp_before_j+16*i3+4*bp_before_i+i1], mismatch_energies_interior[64*bp_assign_i+16*i2+4*bp_assign_j+i3]);
 
                            if (energy_help < min)
                            {
@@ -1039,7 +841,7 @@ int* Traceback()
 
                    //remaining bases are assigned randomly
                   for (int i=2; i<=left_loop_size-1; i++)
-                     int_seq[bp_pos_i+i] = SetFreeBase(bp_pos_i+i);
+                     int_seq[bp_pos_i+i] = SetFreeBase(ctx, bp_pos_i+i);
                }
 
                else                    //        bp_before_i - bp_before_j
@@ -1049,7 +851,7 @@ int* Traceback()
                   for (int i1=0; i1<4; i1++)
                      for ( int i3=0; i3<4; i3++)
                      {
-                        energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+left_loop_size,i1), BasePenalty(bp_pos_j-right_loop_size,i3), mismatch_energies_interior[64*bp_before_j+16*i3+4*bp_before_i+i1]);
+                        energy_help = Sum_MaxEnergy3(BasePenalty(ctx, bp_pos_i+left_loop_size,i1), BasePenalty(ctx, bp_pos_j-right_loop_size,i3), mismatch_energies_interior[64*bp_before_j+16*i3+4*bp_before_i+i1]);
                         if (energy_help < min)
                         {
                            min = energy_help;
@@ -1057,14 +859,14 @@ int* Traceback()
                            min3 = i3;
                         }
                      }
-                  int_seq[BP_Order[bp_pos-1][0]-1] = min1;
-                  int_seq[BP_Order[bp_pos-1][1]+1] = min3;
+                  int_seq[ctx->BP_Order[bp_pos-1][0]-1] = min1;
+                  int_seq[ctx->BP_Order[bp_pos-1][1]+1] = min3;
 
-                  min = MAX_DOUBLE;
+                  min = MAX_ENERGY;
                   for (int i2=0; i2<4; i2++)
                      for ( int i4=0; i4<4; i4++)
                      {
-                        energy_help = Sum_MaxDouble3(BasePenalty(bp_pos_i+1,i2), BasePenalty(bp_pos_j-1,i4), mismatch_energies_interior[64*bp_assign_i+16*i2+4*bp_assign_j+i4]);
+                        energy_help = Sum_MaxEnergy3(BasePenalty(ctx, bp_pos_i+1,i2), BasePenalty(ctx, bp_pos_j-1,i4), mismatch_energies_interior[64*bp_assign_i+16*i2+4*bp_assign_j+i4]);
                         if (energy_help < min)
                         {
                            min = energy_help;
@@ -1077,9 +879,9 @@ int* Traceback()
 
                   //remaining bases are assigned randomly
                   for (int i=2; i<=left_loop_size-1; i++)
-                     int_seq[bp_pos_i+i] = SetFreeBase(bp_pos_i+i);
+                     int_seq[bp_pos_i+i] = SetFreeBase(ctx, bp_pos_i+i);
                   for (int i=2; i<=right_loop_size-1; i++)
-                     int_seq[bp_pos_j-i] = SetFreeBase(bp_pos_j-i);
+                     int_seq[bp_pos_j-i] = SetFreeBase(ctx, bp_pos_j-i);
                }
             }
          }
@@ -1093,31 +895,31 @@ int* Traceback()
 /* Random initialization                                 */
 /*********************************************************/
 
-double Random_Init()
+double Random_Init(DesignContext* ctx)
 {
    double min_en;
    int bp_i, bp_j;
    int sum_constraints, rand_base, rand_pair;
    
-   best_char_seq = (char*) malloc(sizeof(char)*(struct_len+1));
-   best_char_seq[struct_len] = '\0';
+   ctx->best_char_seq = (char*) malloc(sizeof(char)*(ctx->struct_len+1));
+   ctx->best_char_seq[ctx->struct_len] = '\0';
    
    int* bpTable;  // stores for each pos. the bound pos. in the BP (or -1 if unbound)
-   bpTable = make_BasePair_Table(brackets);
+   bpTable = make_BasePair_Table(ctx->brackets);
    
-   for (int i=0; i<struct_len; i++)
+   for (int i=0; i<ctx->struct_len; i++)
    {
       if (bpTable[i] == -1)
       {
          cout << "seq_constr[i]: ";
          for (int h=0; h<4; h++)
-            cout << seq_constraints[i][h] << " ";
+            cout << ctx->seq_constraints[i][h] << " ";
          cout << endl;
          
-         sum_constraints = SumVec(seq_constraints[i], 4);
+         sum_constraints = SumVec(ctx->seq_constraints[i], 4);
          cout << "sum_constr: " << sum_constraints << endl;
          
-         rand_base = RandomBase(sum_constraints) + 1;
+         rand_base = RandomBase(ctx->rng, sum_constraints) + 1;
          cout << "rand_base: " << rand_base << endl;
          
          int ones = 0;
@@ -1125,11 +927,11 @@ double Random_Init()
          while (ones < rand_base)
          {
             column++;
-            if (seq_constraints[i][column] == 1)
+            if (ctx->seq_constraints[i][column] == 1)
               ones++;
          }
          //column is the randomly chosen base assignment (0=A, 1=C, 2=G, 3=U)
-         best_char_seq[i] = int2char(column);         
+         ctx->best_char_seq[i] = int2char(column);         
       }
       else if (bpTable[i] > i)
       {
@@ -1138,17 +940,17 @@ double Random_Init()
          for (int bp=0; bp<6; bp++)
             bp_constraints[bp] = 0;
          // finding allowed pairs
-         if ((seq_constraints[i][0] == 1) && (seq_constraints[bpTable[i]][3] == 1))
+         if ((ctx->seq_constraints[i][0] == 1) && (ctx->seq_constraints[bpTable[i]][3] == 1))
             bp_constraints[0] = 1;
-         if ((seq_constraints[i][1] == 1) && (seq_constraints[bpTable[i]][2] == 1))
+         if ((ctx->seq_constraints[i][1] == 1) && (ctx->seq_constraints[bpTable[i]][2] == 1))
             bp_constraints[1] = 1;
-         if ((seq_constraints[i][2] == 1) && (seq_constraints[bpTable[i]][1] == 1))
+         if ((ctx->seq_constraints[i][2] == 1) && (ctx->seq_constraints[bpTable[i]][1] == 1))
             bp_constraints[2] = 1;
-         if ((seq_constraints[i][3] == 1) && (seq_constraints[bpTable[i]][0] == 1))
+         if ((ctx->seq_constraints[i][3] == 1) && (ctx->seq_constraints[bpTable[i]][0] == 1))
             bp_constraints[3] = 1;
-         if ((seq_constraints[i][2] == 1) && (seq_constraints[bpTable[i]][3] == 1))
+         if ((ctx->seq_constraints[i][2] == 1) && (ctx->seq_constraints[bpTable[i]][3] == 1))
             bp_constraints[4] = 1;
-         if ((seq_constraints[i][3] == 1) && (seq_constraints[bpTable[i]][2] == 1))
+         if ((ctx->seq_constraints[i][3] == 1) && (ctx->seq_constraints[bpTable[i]][2] == 1))
             bp_constraints[5] = 1;
             
          cout << "bp_constr: ";
@@ -1159,7 +961,7 @@ double Random_Init()
          sum_constraints = SumVec(bp_constraints, 6);
          cout << "sum_constr: " << sum_constraints << endl;
          
-         rand_pair = RandomBasePair(sum_constraints) + 1;
+         rand_pair = RandomBasePair(ctx->rng, sum_constraints) + 1;
          cout << "rand_pair: " << rand_pair << endl;
          
          int ones = 0;
@@ -1172,16 +974,18 @@ double Random_Init()
          }
          //column is the randomly chosen base pair assignment (0=AU, 1=CG, 2=GC, 3=UA, 4=GU, 5=UG)
          BP2_2(column, bp_i, bp_j);
-         best_char_seq[i] = int2char(bp_i);
-         best_char_seq[bpTable[i]] = int2char(bp_j);
+         ctx->best_char_seq[i] = int2char(bp_i);
+         ctx->best_char_seq[bpTable[i]] = int2char(bp_j);
       }
    }
    
    char* test_str, *string;
-   test_str = (char*) malloc(sizeof(char)*(struct_len+1));
-   string = (char*) malloc(sizeof(char)*(struct_len+1));
-   strcpy(string, best_char_seq);
-   min_en = fold(string, test_str);
+   test_str = (char*) malloc(sizeof(char)*(ctx->struct_len+1));
+   string = (char*) malloc(sizeof(char)*(ctx->struct_len+1));
+   strcpy(string, ctx->best_char_seq);
+   min_en = fold_engine_fold(ctx->folder, string, test_str, 'F');
+   free(test_str);
+   free(string);
    return min_en;
 }
 
@@ -9,11 +9,10 @@
 
 using namespace std;
 
-void getOrder(char* structure);
-int* StemsInML(int first_pos, int BP_start_pos);
-float Recursion();
-int* Traceback();
-double Random_Init();
+void getOrder(DesignContext* ctx, char* structure);
+float Recursion(DesignContext* ctx);
+int* Traceback(DesignContext* ctx);
+double Random_Init(DesignContext* ctx);
 
 #endif   // _INVERSE_
 
@@ -0,0 +1,158 @@
+
+#include "loop_index.h"
+#include "basics.h"
+
+/*********************************************************/
+
+static int* Copy_List(const vector<int>& list)
+{
+   int* copy = (int*) malloc(sizeof(int)*Maximum((int)list.size(),1));
+   if (copy == NULL)
+   {
+      cerr << "Not enough memory for the loop index!\n";
+      exit(1);
+   }
+   for (unsigned int i=0; i<list.size(); i++)
+      copy[i] = list[i];
+   return copy;
+}
+
+/*********************************************************
+ decomposes the structure into its loops (BP_Order has to
+ be set), the numbers of free bases and stems of the MLs
+ and the external loop are written to BP_Order[][2] and
+ BP_Order[][3]
+*********************************************************/
+
+LoopIndex* Build_LoopIndex(DesignContext* ctx, int* bpTable)
+{
+   int bp, i, j, p, run, stems, free_bases, first_run;
+   unsigned int c;
+   int numBP = ctx->numBP;
+   int* order_pos;               // pos. in BP_Order of each opening pos.
+   LoopIndex* loops;
+   vector<int> stem_start(1,0), stem_list, unpaired;
+   vector<int> conn_start(1,0), base_start(1,0), conn_bases, pair_start(1,0), conn_pairs;
+   vector< vector<int> > BaseConnections, BasePairConnections;
+   vector<int> stem_ends;
+
+   loops = (LoopIndex*) malloc(sizeof(LoopIndex));
+   order_pos = (int*) malloc(sizeof(int)*(ctx->struct_len+1));
+   if ((loops == NULL) || (order_pos == NULL))
+   {
+      cerr << "Not enough memory for the loop index!\n";
+      exit(1);
+   }
+   loops->type = (unsigned char*) malloc(sizeof(unsigned char)*(numBP+1));
+   loops->stem_end = (bool*) calloc(numBP+1, sizeof(bool));
+
+   for (bp=0; bp<numBP; bp++)
+      order_pos[ctx->BP_Order[bp][0]] = bp;
+
+   for (bp=0; bp<=numBP; bp++)
+   {
+      // enclosed BPs and free bases, each pos. is only visited by the loop it belongs to
+      i = (bp < numBP) ? ctx->BP_Order[bp][0] : -1;
+      j = (bp < numBP) ? ctx->BP_Order[bp][1] : ctx->struct_len;
+      run = 0;
+      first_run = 0;
+      free_bases = 0;
+      for (p=i+1; p<j; )
+      {
+         if (bpTable[p] > p)
+         {
+            if ((int)stem_list.size() == stem_start[bp])
+               first_run = run;
+            stem_list.push_back(order_pos[p]);
+            unpaired.push_back(run);
+            free_bases += run;
+            run = 0;
+            p = bpTable[p]+1;
+         }
+         else
+         {
+            run++;
+            p++;
+         }
+      }
+      unpaired.push_back(run);
+      free_bases += run;
+      stem_start.push_back(stem_list.size());
+      stems = stem_start[bp+1] - stem_start[bp];
+
+      if (bp == numBP)
+         loops->type[bp] = LOOP_EXTERNAL;
+      else if (stems == 0)
+         loops->type[bp] = LOOP_HAIRPIN;
+      else if (stems > 1)
+         loops->type[bp] = LOOP_MULTI;
+      else if ((first_run == 0) && (run == 0))
+         loops->type[bp] = LOOP_STACK;
+      else if ((first_run == 0) || (run == 0))
+         loops->type[bp] = LOOP_BULGE;
+      else
+         loops->type[bp] = LOOP_INTERIOR;
+
+      if ((loops->type[bp] == LOOP_MULTI) || (loops->type[bp] == LOOP_EXTERNAL))
+      {
+         ctx->BP_Order[bp][2] = free_bases;
+         ctx->BP_Order[bp][3] = stems;
+
+         // the stems leaving the loop end here
+         for (p=stem_start[bp]; p<stem_start[bp+1]; p++)
+            loops->stem_end[stem_list[p]] = true;
+
+         // connections of the free bases and the stems
+         if (loops->type[bp] == LOOP_MULTI)
+         {
+            for (p=stem_start[bp+1]-1; p>=stem_start[bp]; p--)  // MultiLoopConnections takes them from the back
+               stem_ends.push_back(stem_list[p]);
+            free(MultiLoopConnections(ctx, stems, stem_ends, bp, BaseConnections, BasePairConnections));
+         }
+         else if (stems > 0)
+            EndConnections(ctx, stems, &stem_list[stem_start[bp]], BaseConnections, BasePairConnections);
+
+         for (c=0; c<BaseConnections.size(); c++) //BaseConnections.size() == BasePairConnections.size()
+         {
+            conn_bases.insert(conn_bases.end(), BaseConnections[c].begin(), BaseConnections[c].end());
+            conn_pairs.insert(conn_pairs.end(), BasePairConnections[c].begin(), BasePairConnections[c].end());
+            base_start.push_back(conn_bases.size());
+            pair_start.push_back(conn_pairs.size());
+         }
+         BaseConnections.clear();
+         BasePairConnections.clear();
+      }
+      conn_start.push_back(base_start.size()-1);
+   }
+
+   loops->stem_start = Copy_List(stem_start);
+   loops->stems = Copy_List(stem_list);
+   loops->unpaired = Copy_List(unpaired);
+   loops->conn_start = Copy_List(conn_start);
+   loops->base_start = Copy_List(base_start);
+   loops->conn_bases = Copy_List(conn_bases);
+   loops->pair_start = Copy_List(pair_start);
+   loops->conn_pairs = Copy_List(conn_pairs);
+
+   free(order_pos);
+   return loops;
+}
+
+/*********************************************************/
+
+void Free_LoopIndex(LoopIndex* loops)
+{
+   if (loops == NULL)
+      return;
+   free(loops->type);
+   free(loops->stem_end);
+   free(loops->stem_start);
+   free(loops->stems);
+   free(loops->unpaired);
+   free(loops->conn_start);
+   free(loops->base_start);
+   free(loops->conn_bases);
+   free(loops->pair_start);
+   free(loops->conn_pairs);
+   free(loops);
+}
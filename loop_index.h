@@ -0,0 +1,81 @@
+#ifndef _LOOP_INDEX__
+#define _LOOP_INDEX__
+
+#include <stdlib.h>
+#include "context.h"
+
+using namespace std;
+
+/**********************************************************************************
+*  Loop decomposition of the target structure, built once by getOrder. Each BP    *
+*  of BP_Order closes one loop, the additional row numBP is the external loop.    *
+*  For each loop the index stores its type, the enclosed BPs (the first BPs of    *
+*  the stems leaving it, 5' to 3'), the free bases in front of each of them and   *
+*  after the last one, and for multiloops and the external loop the connections   *
+*  of the free bases and the stems (see MultiLoopConnections, EndConnections).    *
+*  The lists of all loops are stored one after the other (start arrays below).    *
+**********************************************************************************/
+
+enum LoopType
+{
+   LOOP_HAIRPIN,
+   LOOP_STACK,
+   LOOP_BULGE,
+   LOOP_INTERIOR,
+   LOOP_MULTI,
+   LOOP_EXTERNAL
+};
+
+struct LoopIndex
+{
+   unsigned char* type;   // LoopType of each loop
+   bool* stem_end;        // true, if the BP is the last one of its stem (it is enclosed by a ML or the external loop)
+   int* stem_start;       // enclosed BPs of loop bp: stems[stem_start[bp]..stem_start[bp+1]-1]
+   int* stems;
+   int* unpaired;         // free bases in front of the enclosed BPs and after the last one: unpaired[stem_start[bp]+bp..]
+   int* conn_start;       // connections of loop bp: conn_start[bp]..conn_start[bp+1]-1
+   int* base_start;       // free bases of connection c: conn_bases[base_start[c]..base_start[c+1]-1]
+   int* conn_bases;
+   int* pair_start;       // BPs of connection c: conn_pairs[pair_start[c]..pair_start[c+1]-1]
+   int* conn_pairs;
+};
+
+LoopIndex* Build_LoopIndex(DesignContext* ctx, int* bpTable);
+void Free_LoopIndex(LoopIndex* loops);
+
+inline int LoopStems(const LoopIndex* loops, int bp)
+{
+   return loops->stem_start[bp+1] - loops->stem_start[bp];
+}
+
+inline const int* LoopStemList(const LoopIndex* loops, int bp)
+{
+   return loops->stems + loops->stem_start[bp];
+}
+
+inline const int* LoopUnpaired(const LoopIndex* loops, int bp)
+{
+   return loops->unpaired + loops->stem_start[bp] + bp;
+}
+
+inline int ConnBaseSize(const LoopIndex* loops, int c)
+{
+   return loops->base_start[c+1] - loops->base_start[c];
+}
+
+inline const int* ConnBaseList(const LoopIndex* loops, int c)
+{
+   return loops->conn_bases + loops->base_start[c];
+}
+
+inline int ConnPairSize(const LoopIndex* loops, int c)
+{
+   return loops->pair_start[c+1] - loops->pair_start[c];
+}
+
+inline const int* ConnPairList(const LoopIndex* loops, int c)
+{
+   return loops->conn_pairs + loops->pair_start[c];
+}
+
+#endif   // _LOOP_INDEX_
@@ -0,0 +1,69 @@
+
+#include "loop_memo.h"
+
+// number of entries of each memo table (6 BPs, 16 masks per loop position)
+static const int memo_size[MEMO_KINDS] = { 6*6*16*16,
+                                           6*6*16*16*16,
+                                           6*6*16*16*16,
+                                           6*6*16*16*16*16,
+                                           6*16*16,
+                                           6*16*16*16*16 };
+
+static int* memo[MEMO_KINDS];
+static bool memos_set = false;
+
+/*********************************************************
+ allocates the memo tables (all entries unset), done by
+ the first design, designs may run in parallel
+*********************************************************/
+
+void Init_LoopMemos()
+{
+   #pragma omp critical(loop_memo)
+   if (!memos_set)
+   {
+      for (int kind=0; kind<MEMO_KINDS; kind++)
+      {
+         memo[kind] = (int*) calloc(memo_size[kind], sizeof(int));
+         if (memo[kind] == NULL)
+         {
+            cerr << "Not enough memory for the loop memo tables!\n";
+            exit(1);
+         }
+      }
+      memos_set = true;
+   }
+}
+
+/*********************************************************/
+
+void Free_LoopMemos()
+{
+   #pragma omp critical(loop_memo)
+   if (memos_set)
+   {
+      for (int kind=0; kind<MEMO_KINDS; kind++)
+      {
+         free(memo[kind]);
+         memo[kind] = NULL;
+      }
+      memos_set = false;
+   }
+}
+
+/*********************************************************/
+
+int* LoopMemo(int kind)
+{
+   return memo[kind];
+}
+
+/*********************************************************
+ bit mask of the bases allowed at pos in the current step
+ (bit b set = base b allowed)
+*********************************************************/
+
+int AllowedMask(DesignContext* ctx, int pos)
+{
+   return ctx->allowed_mask[ctx->step-1][pos];
+}
@@ -0,0 +1,56 @@
+#ifndef _LOOP_MEMO__
+#define _LOOP_MEMO__
+
+#include <stdlib.h>
+#include "basics.h"
+#include "constraints.h"
+
+using namespace std;
+
+/**********************************************************************************
+*  Memo tables of the loop minimizers of the initializing step. The minimal       *
+*  energy of a small loop only depends on the assignments of the closing BPs and  *
+*  the allowed bases of the loop positions (allowed_mask), thus it is computed    *
+*  once for each such key and shared by all loops of all designs (batch mode).    *
+**********************************************************************************/
+
+enum LoopMemoKind
+{
+   MEMO_INTERIOR_1_1,   // key: closing BP, BP before, masks of i+1, j-1
+   MEMO_INTERIOR_1_2,   // key: closing BP, BP before, masks of i+1, j-1, j-2
+   MEMO_INTERIOR_2_1,   // key: closing BP, BP before, masks of i+1, i+2, j-1
+   MEMO_INTERIOR_2_2,   // key: closing BP, BP before, masks of i+1, i+2, j-1, j-2
+   MEMO_HAIRPIN,        // key: closing BP, masks of i+1, j-1 (terminal mismatch, size > 4)
+   MEMO_TETRA_LOOP,     // key: closing BP, masks of i+1, i+2, j-2, j-1
+   MEMO_KINDS
+};
+
+// value of an entry that is not computed yet (no energy is that low), the tables
+// store energy+MAX_ENERGY, thus a zeroed table (calloc) has all entries unset
+#define MEMO_UNSET (-MAX_ENERGY)
+
+void Init_LoopMemos();
+void Free_LoopMemos();
+int* LoopMemo(int kind);
+int AllowedMask(DesignContext* ctx, int pos);
+
+/***********************************************************
+ designs running in parallel may compute the same entry,
+ both write the same value
+***********************************************************/
+
+inline int Memo_Get(const int* memo, int key)
+{
+   int energy;
+   #pragma omp atomic read
+   energy = memo[key];
+   return energy - MAX_ENERGY;
+}
+
+inline void Memo_Set(int* memo, int key, int energy)
+{
+   #pragma omp atomic write
+   memo[key] = energy + MAX_ENERGY;
+}
+
+#endif   // _LOOP_MEMO_
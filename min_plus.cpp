@@ -0,0 +1,148 @@
+
+#include "min_plus.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MINPLUS_X86
+#endif
+
+/*********************************************************/
+
+static int Min_Plus_Scalar(const int* a, const int* b, int len, int bound)
+{
+   int t, e;
+
+   for (t=0; t<len; t++)
+   {
+      e = a[t]+b[t];
+      if (e < bound)
+         bound = e;
+   }
+   return bound;
+}
+
+#ifdef MINPLUS_X86
+
+__attribute__((target("sse4.1")))
+static int Min_Plus_SSE41(const int* a, const int* b, int len, int bound)
+{
+   __m128i m = _mm_set1_epi32(bound);
+   int t;
+
+   for (t=0; t+4<=len; t+=4)
+      m = _mm_min_epi32(m, _mm_add_epi32(_mm_loadu_si128((const __m128i*)(a+t)), _mm_loadu_si128((const __m128i*)(b+t))));
+   m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1,0,3,2)));
+   m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2,3,0,1)));
+   return Min_Plus_Scalar(a+t, b+t, len-t, _mm_cvtsi128_si32(m));
+}
+
+__attribute__((target("avx2")))
+static int Min_Plus_AVX2(const int* a, const int* b, int len, int bound)
+{
+   __m256i m0 = _mm256_set1_epi32(bound), m1 = m0;
+   __m128i m;
+   int t;
+
+   // two accumulators hide the latency of the min
+   for (t=0; t+16<=len; t+=16)
+   {
+      m0 = _mm256_min_epi32(m0, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(a+t)), _mm256_loadu_si256((const __m256i*)(b+t))));
+      m1 = _mm256_min_epi32(m1, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(a+t+8)), _mm256_loadu_si256((const __m256i*)(b+t+8))));
+   }
+   if (t+8 <= len)
+   {
+      m0 = _mm256_min_epi32(m0, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(a+t)), _mm256_loadu_si256((const __m256i*)(b+t))));
+      t += 8;
+   }
+   m0 = _mm256_min_epi32(m0, m1);
+   m = _mm_min_epi32(_mm256_castsi256_si128(m0), _mm256_extracti128_si256(m0, 1));
+   m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1,0,3,2)));
+   m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2,3,0,1)));
+   return Min_Plus_Scalar(a+t, b+t, len-t, _mm_cvtsi128_si32(m));
+}
+
+__attribute__((target("avx512f")))
+static int Min_Plus_AVX512(const int* a, const int* b, int len, int bound)
+{
+   __m512i m = _mm512_set1_epi32(bound);
+   __mmask16 lanes = 0xFFFF;
+   int t, lane[16];
+
+   // the masked forms keep gcc from reading an undefined source operand
+   for (t=0; t+16<=len; t+=16)
+      m = _mm512_mask_min_epi32(m, lanes, m, _mm512_add_epi32(_mm512_loadu_si512(a+t), _mm512_loadu_si512(b+t)));
+   if (t < len)
+   {
+      // the lanes after the end keep the bound
+      lanes = (__mmask16)((1u << (len-t)) - 1);
+      m = _mm512_mask_min_epi32(m, lanes, m, _mm512_add_epi32(_mm512_maskz_loadu_epi32(lanes, a+t), _mm512_maskz_loadu_epi32(lanes, b+t)));
+   }
+   _mm512_storeu_si512(lane, m);
+   for (t=0; t<16; t++)
+      if (lane[t] < bound)
+         bound = lane[t];
+   return bound;
+}
+
+#endif
+
+/*********************************************************/
+
+static const char* kernel_names[MINPLUS_KERNELS] = {"scalar", "sse4.1", "avx2", "avx512"};
+
+static const MinPlusKernel kernels[MINPLUS_KERNELS] =
+{
+   Min_Plus_Scalar,
+#ifdef MINPLUS_X86
+   Min_Plus_SSE41, Min_Plus_AVX2, Min_Plus_AVX512
+#else
+   NULL, NULL, NULL
+#endif
+};
+
+
+const char* MinPlus_Name(int level)
+{
+   return ((level >= 0) && (level < MINPLUS_KERNELS)) ? kernel_names[level] : NULL;
+}
+
+
+int MinPlus_Supported(int level)
+{
+   if ((level < 0) || (level >= MINPLUS_KERNELS) || (kernels[level] == NULL))
+      return 0;
+#ifdef MINPLUS_X86
+   __builtin_cpu_init();
+   if (level == MINPLUS_SSE41)
+      return __builtin_cpu_supports("sse4.1");
+   if (level == MINPLUS_AVX2)
+      return __builtin_cpu_supports("avx2");
+   if (level == MINPLUS_AVX512)
+      return __builtin_cpu_supports("avx512f");
+#endif
+   return 1;
+}
+
+
+static int Best_MinPlus()
+{
+   int level = MINPLUS_KERNELS-1;
+
+   while (!MinPlus_Supported(level))
+      level--;
+   return level;
+}
+
+
+int Select_MinPlus(int level)
+{
+   if (level < 0)
+      level = Best_MinPlus();
+   if (!MinPlus_Supported(level))
+      return -1;
+   Min_Plus = kernels[level];
+   return level;
+}
+
+
+MinPlusKernel Min_Plus = kernels[Best_MinPlus()];
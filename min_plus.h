@@ -0,0 +1,34 @@
+#ifndef _MIN_PLUS__
+#define _MIN_PLUS__
+
+#include <stdlib.h>
+
+using namespace std;
+
+/**********************************************************************************
+*  Min-plus reduction of the native fold: min(bound, a[t]+b[t] for 0 <= t < len)  *
+*  over two contiguous ranges (multiloop decompositions). The kernels use the     *
+*  widest integer vectors the CPU supports (SSE4.1, AVX2, AVX-512), chosen once   *
+*  at the start, with the scalar loop as fallback. The sums must fit an int.      *
+**********************************************************************************/
+
+enum MinPlusLevel
+{
+   MINPLUS_SCALAR,
+   MINPLUS_SSE41,
+   MINPLUS_AVX2,
+   MINPLUS_AVX512,
+   MINPLUS_KERNELS
+};
+
+typedef int (*MinPlusKernel)(const int* a, const int* b, int len, int bound);
+
+extern MinPlusKernel Min_Plus;   // kernel used by the native fold
+
+const char* MinPlus_Name(int level);
+int MinPlus_Supported(int level);
+
+// uses the kernel of the given level (-1 = best supported), returns the level or -1 if it isn't supported
+int Select_MinPlus(int level);
+
+#endif   // _MIN_PLUS_
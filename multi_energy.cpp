@@ -13,10 +13,10 @@
  Return: vector including BPs in the ML (= predecessors of the closing BP of the ML)
 *******************************************************/
 
-int* MultiLoopConnections(int stem_num, vector<int> & stem_ends, int order_pos_of_closing_bp, vector< vector<int> > & BaseConnections, vector< vector<int> > & BasePairConnections)
+int* MultiLoopConnections(DesignContext* ctx, int stem_num, vector<int> & stem_ends, int order_pos_of_closing_bp, vector< vector<int> > & BaseConnections, vector< vector<int> > & BasePairConnections)
 {
    int* ml_stem_ends = (int*) malloc(sizeof(int)*stem_num);      //stem ends in the ML
-   int* ml_between_stems = (int*) malloc(sizeof(int)*stem_num+1);  //contains the number of bases between the stems (in each coord. the bases "before" the
+   int* ml_between_stems = (int*) malloc(sizeof(int)*(stem_num+1));  //contains the number of bases between the stems (in each coord. the bases "before" the
                                                                     //stem, only at the last coord. of bases_between_stems the free bases after
                                                                     //the last stem and before the closing BP are stored
 
@@ -31,17 +31,17 @@ int* MultiLoopConnections(int stem_num, vector<int> & stem_ends, int order_pos_o
    }
 
    // number of free bases between the stem-ending base pairs
-   ml_between_stems[0] = BP_Order[ml_stem_ends[0]][0] - BP_Order[order_pos_of_closing_bp][0] - 1;
+   ml_between_stems[0] = ctx->BP_Order[ml_stem_ends[0]][0] - ctx->BP_Order[order_pos_of_closing_bp][0] - 1;
    for (int i=1; i<stem_num; i++)
-      ml_between_stems[i] = BP_Order[ml_stem_ends[i]][0] - BP_Order[ml_stem_ends[i-1]][1] - 1;
-   ml_between_stems[stem_num] = BP_Order[order_pos_of_closing_bp][1] - BP_Order[ml_stem_ends[stem_num-1]][1] - 1;
+      ml_between_stems[i] = ctx->BP_Order[ml_stem_ends[i]][0] - ctx->BP_Order[ml_stem_ends[i-1]][1] - 1;
+   ml_between_stems[stem_num] = ctx->BP_Order[order_pos_of_closing_bp][1] - ctx->BP_Order[ml_stem_ends[stem_num-1]][1] - 1;
 
    // finding all connections: (concerning free bases):
    //*****************************************************
 
    // if there's at least one free base upstream the first stem
    if (ml_between_stems[0] != 0)
-      one_connection.push_back(BP_Order[order_pos_of_closing_bp][0]+1);
+      one_connection.push_back(ctx->BP_Order[order_pos_of_closing_bp][0]+1);
 
    for (int i=0; i<stem_num; i++)
    {
@@ -49,16 +49,16 @@ int* MultiLoopConnections(int stem_num, vector<int> & stem_ends, int order_pos_o
       if (ml_between_stems[i] == 1)
       {
          if (ml_between_stems[i+1] != 0)
-            one_connection.push_back(BP_Order[ml_stem_ends[i]][1]+1);
+            one_connection.push_back(ctx->BP_Order[ml_stem_ends[i]][1]+1);
       }
       else
       {
          BaseConnections.push_back(one_connection);
          one_connection.clear();
          if (ml_between_stems[i] != 0)
-            one_connection.push_back(BP_Order[ml_stem_ends[i]][0]-1);
+            one_connection.push_back(ctx->BP_Order[ml_stem_ends[i]][0]-1);
          if (ml_between_stems[i+1] != 0)
-            one_connection.push_back(BP_Order[ml_stem_ends[i]][1]+1);
+            one_connection.push_back(ctx->BP_Order[ml_stem_ends[i]][1]+1);
       }
    }
 
@@ -73,7 +73,7 @@ int* MultiLoopConnections(int stem_num, vector<int> & stem_ends, int order_pos_o
       one_connection.clear();
       if (ml_between_stems[stem_num] != 0)
       {
-         one_connection.push_back(BP_Order[order_pos_of_closing_bp][1]-1);
+         one_connection.push_back(ctx->BP_Order[order_pos_of_closing_bp][1]-1);
       }
       // one_connection might be empty, but this is done to ensure that BaseConnections and BasePairConnections
       // are always of the same size
@@ -113,142 +113,13 @@ int* MultiLoopConnections(int stem_num, vector<int> & stem_ends, int order_pos_o
       one_connection.clear();
    }
 
+   free(ml_between_stems);
    return ml_stem_ends;
 }
 
 
 
 
-/*******************************************************
- identifies connections concerning the closing base pairs
- of the stems and concerning the free bases adjacent to them
- (similar to the other MultiLoopConnections-function, but without
- using C++ vectors)
-
- stem_ends = contains all stem ends of leaving stems and their positions in BP_Order
- order_pos_of_closing_bp = pos. of the closing BP in BP_Order
- BaseConnections = contains row-wise the connections concerning bases
- BasePairConnections = contains row-wise the connections concerning base pairs
- EndBaseSizes = sizes of the EndBaseConnections
- EndBasePairSizes = sizes of the EndBasePairConnections
-*******************************************************/
-
-void MultiLoopConnections(int* stem_ends, int order_pos_of_closing_bp, int** BaseConnections, int *BaseSizes, int** BasePairConnections, int* BasePairSizes)
-{
-   int i;
-   int stem_num = BP_Order[order_pos_of_closing_bp][3];
-   int num_bp_con = 0;   //current number of BasePairConnections
-   int num_base_con = 0; //current number of BaseConnections
-   int bp, base;         //current position in the current connection
-
-   int* ml_stem_ends = (int*) malloc(sizeof(int)*stem_num);  //stem ends of the ML
-   int* ml_between_stems = (int*) malloc(sizeof(int)*stem_num+1);  //contains the number of bases between the stems (in each coord. the bases "before" the
-                                                                   //stem, only at the last coord. of bases_between_stems the free bases after
-                                                                   //the last stem and before the closing BP are stored
-
-   // get just the interesting stem ends from stem_ends and erase them there,
-   // thereby their order is reversed. BPs (i,j) having a small i are first now
-   for (i=0; i<stem_num; i++)
-      ml_stem_ends[i] = stem_ends[i];
-
-   // number of free bases between the stem-ending base pairs
-   ml_between_stems[0] = BP_Order[ml_stem_ends[0]][0] - BP_Order[order_pos_of_closing_bp][0] - 1;
-   for (i=1; i<stem_num; i++)
-      ml_between_stems[i] = BP_Order[ml_stem_ends[i]][0] - BP_Order[ml_stem_ends[i-1]][1] - 1;
-   ml_between_stems[stem_num] = BP_Order[order_pos_of_closing_bp][1] - BP_Order[ml_stem_ends[stem_num-1]][1] - 1;
-
-
-   // finding all connections: (concerning free bases):
-   //*****************************************************
-
-   bp = 0;
-   base = 0;
-
-   // if there's at least one free base upstream the first stem
-   if (ml_between_stems[0] != 0)
-      BaseConnections[num_base_con][base++] = BP_Order[order_pos_of_closing_bp][0]+1;
-
-
-   for (i=0; i<stem_num; i++)
-   {
-      // if there is only one free base between the stems and if there is at least one free base after the next stem
-      if (ml_between_stems[i] == 1)
-      {
-         if (ml_between_stems[i+1] != 0)
-            BaseConnections[num_base_con][base++] = BP_Order[ml_stem_ends[i]][1]+1;
-      }
-      else
-      {
-         BaseSizes[num_base_con] = base;
-         num_base_con++;
-         base = 0;
-         if (ml_between_stems[i] != 0)
-            BaseConnections[num_base_con][base++] = BP_Order[ml_stem_ends[i]][0]-1;
-         if (ml_between_stems[i+1] != 0)
-            BaseConnections[num_base_con][base++] = BP_Order[ml_stem_ends[i]][1]+1;
-      }
-   }
-
-   if (ml_between_stems[stem_num] == 1)
-   {
-      BaseSizes[num_base_con] = base;
-      num_base_con++;
-      base = 0;
-   }
-   else
-   {
-      BaseSizes[num_base_con] = base;
-      num_base_con++;
-      base = 0;
-      if (ml_between_stems[stem_num] != 0)
-         BaseConnections[num_base_con][base++] = BP_Order[order_pos_of_closing_bp][1]-1;
-      // one_connection might be empty, but this is done to ensure that BaseConnections and BasePairConnections
-      // are always of the same size
-      BaseSizes[num_base_con] = base;
-      num_base_con++;
-      base = 0;
-   }
-
-   // finding all connections: (concerning stems):
-   //************************************************
-
-   BasePairConnections[num_bp_con][bp++] = order_pos_of_closing_bp;
-
-   for (i=0; i<stem_num; i++)
-   {
-      if (ml_between_stems[i] == 1)
-         BasePairConnections[num_bp_con][bp++] = ml_stem_ends[i];
-      else
-      {
-         BasePairSizes[num_bp_con] = bp;
-         num_bp_con++;
-         bp = 0;
-         BasePairConnections[num_bp_con][bp++] = ml_stem_ends[i];
-      }
-   }
-
-   if (ml_between_stems[stem_num] == 1)
-   {
-      BasePairConnections[num_bp_con][bp++] = order_pos_of_closing_bp;
-      BasePairSizes[num_bp_con] = bp;
-      num_bp_con++;
-      bp = 0;
-   }
-   else
-   {
-      BasePairSizes[num_bp_con] = bp;
-      num_bp_con++;
-      bp = 0;
-      BasePairConnections[num_bp_con][bp++] = order_pos_of_closing_bp;
-      BasePairSizes[num_bp_con] = bp;
-      num_bp_con++;
-      bp = 0;
-   }
-}
-
-
-
-
 /******************************************************
 gives the MINIMAL (=best) free energy for a connection of the
 ML if the base pair assignments of the stem-ending
@@ -259,11 +130,11 @@ pair_connection = a connection concerning stem-ending base pairs
 bp_at_pair_connection = a BP assignment of pair_connection
 ******************************************************/
 
-double BestConnectionEnergy(const vector<int> & base_connection, const vector<int> & pair_connection, const int** bp_at_pair_connection)
+int BestConnectionEnergy(DesignContext* ctx, const vector<int> & base_connection, const vector<int> & pair_connection, const int** bp_at_pair_connection)
 {
-   double energy = 0.0;
-   double min = MAX_DOUBLE;
-   double base_energy;
+   int energy = 0;
+   int min = MAX_ENERGY;
+   int base_energy;
 
    for (int i=0; i<(int)base_connection.size(); i++)
    {
@@ -271,15 +142,15 @@ double BestConnectionEnergy(const vector<int> & base_connection, const vector<in
 
       //bases in base_connection[i] may be neighbored to base pairs in
       //pair_connection[i-1] [i] or/and [i+1] => testing (and also whether the respecting field in the vector exists)
-      min = MAX_DOUBLE;
+      min = MAX_ENERGY;
 
       if (i-1 >= 0)  /*case BP_Order[pair_connection[i-1]][0] not possible*/
       {
          // usual case: base is located right of (= after) the stem
-         if (BP_Order[pair_connection[i-1]][1]+1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i-1]][1]+1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[16*bp_at_pair_connection[i-1][1]+4*bp_at_pair_connection[i-1][0]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[16*bp_at_pair_connection[i-1][1]+4*bp_at_pair_connection[i-1][0]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                   min = base_energy;
             }
@@ -288,37 +159,37 @@ double BestConnectionEnergy(const vector<int> & base_connection, const vector<in
       if (i < (int)pair_connection.size())
       {
          // if the left stem is the closingBP
-         if (BP_Order[pair_connection[i]][0]+1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i]][0]+1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[16*bp_at_pair_connection[i][0]+4*bp_at_pair_connection[i][1]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[16*bp_at_pair_connection[i][0]+4*bp_at_pair_connection[i][1]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                   min = base_energy;
             }
 
          // usual case: base is located left of (= before) the stem
-         if (BP_Order[pair_connection[i]][0]-1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i]][0]-1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[64+16*bp_at_pair_connection[i][1]+4*bp_at_pair_connection[i][0]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[64+16*bp_at_pair_connection[i][1]+4*bp_at_pair_connection[i][0]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                   min = base_energy;
             }
 
          // usual case: base is located right of (= after) the stem
-         if (BP_Order[pair_connection[i]][1]+1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i]][1]+1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[16*bp_at_pair_connection[i][1]+4*bp_at_pair_connection[i][0]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[16*bp_at_pair_connection[i][1]+4*bp_at_pair_connection[i][0]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                   min = base_energy;
             }
 
          // if the right stem is the closingBP
-         if (BP_Order[pair_connection[i]][1]-1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i]][1]-1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[64+16*bp_at_pair_connection[i][0]+4*bp_at_pair_connection[i][1]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[64+16*bp_at_pair_connection[i][0]+4*bp_at_pair_connection[i][1]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                   min = base_energy;
             }
@@ -328,24 +199,24 @@ double BestConnectionEnergy(const vector<int> & base_connection, const vector<in
       if ( i+1 < (int)pair_connection.size())
       {
          // usual case: base is located left of (= before) the stem
-         if (BP_Order[pair_connection[i+1]][0]-1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i+1]][0]-1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[64+16*bp_at_pair_connection[i+1][1]+4*bp_at_pair_connection[i+1][0]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[64+16*bp_at_pair_connection[i+1][1]+4*bp_at_pair_connection[i+1][0]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                   min = base_energy;
             }
 
          // usual case: base is located right of (= after) the stem
-         if (BP_Order[pair_connection[i+1]][1]-1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i+1]][1]-1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[64+16*bp_at_pair_connection[i+1][0]+4*bp_at_pair_connection[i+1][1]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[64+16*bp_at_pair_connection[i+1][0]+4*bp_at_pair_connection[i+1][1]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                   min = base_energy;
             }
       }
-      energy = Sum_MaxDouble(energy,min);
+      energy = Sum_MaxEnergy(energy,min);
    }
    return energy;
 }
@@ -362,11 +233,11 @@ base_connection = a connection concerning free bases
 pair_connection = a connection concerning stem-ending base pairs
 ******************************************************/
 
-double ConnectionEnergy(const int* base_connection, int base_size, const int* pair_connection, int bp_size, int* int_seq)
+int ConnectionEnergy(DesignContext* ctx, const int* base_connection, int base_size, const int* pair_connection, int bp_size, int* int_seq)
 {
-   double energy = 0.0;
+   int energy = 0;
    int i;
-   double min;
+   int min;
 
    for (i=0; i<base_size; i++)
    {
@@ -374,53 +245,53 @@ double ConnectionEnergy(const int* base_connection, int base_size, const int* pa
 
       //bases in base_connection[i] may be neighbored to base pairs in
       //pair_connection[i-1] [i] or/and [i+1] => testing (and also whether the respecting field in the vector exists)
-      min = MAX_DOUBLE;
+      min = MAX_ENERGY;
 
       if (i-1 >= 0)  /*case BP_Order[pair_connection[i-1]][0] not possible*/
       {
          // usual case: base is located right of (= after) the stem
-         if (BP_Order[pair_connection[i-1]][1]+1 == base_connection[i])
-            if (single_base_stacking_energy[16*int_seq[BP_Order[pair_connection[i-1]][1]]+4*int_seq[BP_Order[pair_connection[i-1]][0]]+int_seq[base_connection[i]]] < min)
-               min = single_base_stacking_energy[16*int_seq[BP_Order[pair_connection[i-1]][1]]+4*int_seq[BP_Order[pair_connection[i-1]][0]]+int_seq[base_connection[i]]];
+         if (ctx->BP_Order[pair_connection[i-1]][1]+1 == base_connection[i])
+            if (single_base_stacking_energy[16*int_seq[ctx->BP_Order[pair_connection[i-1]][1]]+4*int_seq[ctx->BP_Order[pair_connection[i-1]][0]]+int_seq[base_connection[i]]] < min)
+               min = single_base_stacking_energy[16*int_seq[ctx->BP_Order[pair_connection[i-1]][1]]+4*int_seq[ctx->BP_Order[pair_connection[i-1]][0]]+int_seq[base_connection[i]]];
       }
 
       if (i < bp_size)
       {
          // if the left stem is the closingBP
-         if (BP_Order[pair_connection[i]][0]+1 == base_connection[i])
-            if (single_base_stacking_energy[16*int_seq[BP_Order[pair_connection[i]][0]]+4*int_seq[BP_Order[pair_connection[i]][1]]+int_seq[base_connection[i]]] < min)
-               min = single_base_stacking_energy[16*int_seq[BP_Order[pair_connection[i]][0]]+4*int_seq[BP_Order[pair_connection[i]][1]]+int_seq[base_connection[i]]];
+         if (ctx->BP_Order[pair_connection[i]][0]+1 == base_connection[i])
+            if (single_base_stacking_energy[16*int_seq[ctx->BP_Order[pair_connection[i]][0]]+4*int_seq[ctx->BP_Order[pair_connection[i]][1]]+int_seq[base_connection[i]]] < min)
+               min = single_base_stacking_energy[16*int_seq[ctx->BP_Order[pair_connection[i]][0]]+4*int_seq[ctx->BP_Order[pair_connection[i]][1]]+int_seq[base_connection[i]]];
 
          // usual case: base is located left of (=before) the stem
-         if (BP_Order[pair_connection[i]][0]-1 == base_connection[i])
-            if (single_base_stacking_energy[64+16*int_seq[BP_Order[pair_connection[i]][1]]+4*int_seq[BP_Order[pair_connection[i]][0]]+int_seq[base_connection[i]]] < min)
-               min = single_base_stacking_energy[64+16*int_seq[BP_Order[pair_connection[i]][1]]+4*int_seq[BP_Order[pair_connection[i]][0]]+int_seq[base_connection[i]]];
+         if (ctx->BP_Order[pair_connection[i]][0]-1 == base_connection[i])
+            if (single_base_stacking_energy[64+16*int_seq[ctx->BP_Order[pair_connection[i]][1]]+4*int_seq[ctx->BP_Order[pair_connection[i]][0]]+int_seq[base_connection[i]]] < min)
+               min = single_base_stacking_energy[64+16*int_seq[ctx->BP_Order[pair_connection[i]][1]]+4*int_seq[ctx->BP_Order[pair_connection[i]][0]]+int_seq[base_connection[i]]];
 
          // usual case: base is located right of (= after) the stem
-         if (BP_Order[pair_connection[i]][1]+1 == base_connection[i])
-            if (single_base_stacking_energy[16*int_seq[BP_Order[pair_connection[i]][1]]+4*int_seq[BP_Order[pair_connection[i]][0]]+int_seq[base_connection[i]]] < min)
-               min = single_base_stacking_energy[16*int_seq[BP_Order[pair_connection[i]][1]]+4*int_seq[BP_Order[pair_connection[i]][0]]+int_seq[base_connection[i]]];
+         if (ctx->BP_Order[pair_connection[i]][1]+1 == base_connection[i])
+            if (single_base_stacking_energy[16*int_seq[ctx->BP_Order[pair_connection[i]][1]]+4*int_seq[ctx->BP_Order[pair_connection[i]][0]]+int_seq[base_connection[i]]] < min)
+               min = single_base_stacking_energy[16*int_seq[ctx->BP_Order[pair_connection[i]][1]]+4*int_seq[ctx->BP_Order[pair_connection[i]][0]]+int_seq[base_connection[i]]];
 
          // if the right stem is the closingBP
-         if (BP_Order[pair_connection[i]][1]-1 == base_connection[i])
-            if (single_base_stacking_energy[64+16*int_seq[BP_Order[pair_connection[i]][0]]+4*int_seq[BP_Order[pair_connection[i]][1]]+int_seq[base_connection[i]]] < min)
-               min = single_base_stacking_energy[64+16*int_seq[BP_Order[pair_connection[i]][0]]+4*int_seq[BP_Order[pair_connection[i]][1]]+int_seq[base_connection[i]]];
+         if (ctx->BP_Order[pair_connection[i]][1]-1 == base_connection[i])
+            if (single_base_stacking_energy[64+16*int_seq[ctx->BP_Order[pair_connection[i]][0]]+4*int_seq[ctx->BP_Order[pair_connection[i]][1]]+int_seq[base_connection[i]]] < min)
+               min = single_base_stacking_energy[64+16*int_seq[ctx->BP_Order[pair_connection[i]][0]]+4*int_seq[ctx->BP_Order[pair_connection[i]][1]]+int_seq[base_connection[i]]];
       }
 
       if ( i+1 < bp_size)
       {
          // usual case: base is located left of (=before) the stem
-         if (BP_Order[pair_connection[i+1]][0]-1 == base_connection[i])
-            if (single_base_stacking_energy[64+16*int_seq[BP_Order[pair_connection[i+1]][1]]+4*int_seq[BP_Order[pair_connection[i+1]][0]]+int_seq[base_connection[i]]] < min)
-               min = single_base_stacking_energy[64+16*int_seq[BP_Order[pair_connection[i+1]][1]]+4*int_seq[BP_Order[pair_connection[i+1]][0]]+int_seq[base_connection[i]]];
+         if (ctx->BP_Order[pair_connection[i+1]][0]-1 == base_connection[i])
+            if (single_base_stacking_energy[64+16*int_seq[ctx->BP_Order[pair_connection[i+1]][1]]+4*int_seq[ctx->BP_Order[pair_connection[i+1]][0]]+int_seq[base_connection[i]]] < min)
+               min = single_base_stacking_energy[64+16*int_seq[ctx->BP_Order[pair_connection[i+1]][1]]+4*int_seq[ctx->BP_Order[pair_connection[i+1]][0]]+int_seq[base_connection[i]]];
 
          // if the right stem is the closingBP
-         if (BP_Order[pair_connection[i+1]][1]-1 == base_connection[i])
-            if (single_base_stacking_energy[64+16*int_seq[BP_Order[pair_connection[i+1]][0]]+4*int_seq[BP_Order[pair_connection[i+1]][1]]+int_seq[base_connection[i]]] < min)
-               min = single_base_stacking_energy[64+16*int_seq[BP_Order[pair_connection[i+1]][0]]+4*int_seq[BP_Order[pair_connection[i+1]][1]]+int_seq[base_connection[i]]];
+         if (ctx->BP_Order[pair_connection[i+1]][1]-1 == base_connection[i])
+            if (single_base_stacking_energy[64+16*int_seq[ctx->BP_Order[pair_connection[i+1]][0]]+4*int_seq[ctx->BP_Order[pair_connection[i+1]][1]]+int_seq[base_connection[i]]] < min)
+               min = single_base_stacking_energy[64+16*int_seq[ctx->BP_Order[pair_connection[i+1]][0]]+4*int_seq[ctx->BP_Order[pair_connection[i+1]][1]]+int_seq[base_connection[i]]];
       }
       //base penalty
-      energy = Sum_MaxDouble3(energy, min, BasePenalty(base_connection[i],int_seq[base_connection[i]]));
+      energy = Sum_MaxEnergy3(energy, min, BasePenalty(ctx, base_connection[i],int_seq[base_connection[i]]));
    }
    return energy;
 }
@@ -429,205 +300,335 @@ double ConnectionEnergy(const int* base_connection, int base_size, const int* pa
 
 
 
-/****************************************************************************************
+/******************************************************
+cases of BestConnectionEnergy in which a free base is
+adjacent to the stem pair_connection[s] (rel = s - index
+of the base in the connection), for each case the offset
+in single_base_stacking_energy for the assignment bp of
+the stem is written to idx
 
-calculates the MINIMAL (=best) free energy of the ML, values are stored in D and Trace
+Return: number of cases
+******************************************************/
 
-****************************************************************************************/
+static int StemBaseCases(DesignContext* ctx, int base, int stem, int rel, int bp, int* idx)
+{
+   int b0, b1;
+   int num_idx = 0;
+
+   BP2_2(bp, b0, b1);
+   if ((rel == 0) && (ctx->BP_Order[stem][0]+1 == base))
+      idx[num_idx++] = 16*b0+4*b1;
+   if ((rel >= 0) && (ctx->BP_Order[stem][0]-1 == base))
+      idx[num_idx++] = 64+16*b1+4*b0;
+   if ((rel <= 0) && (ctx->BP_Order[stem][1]+1 == base))
+      idx[num_idx++] = 16*b1+4*b0;
+   if ((rel >= 0) && (ctx->BP_Order[stem][1]-1 == base))
+      idx[num_idx++] = 64+16*b0+4*b1;
+   return num_idx;
+}
 
-void MLBestEnergy(int bp_pos, vector<int> & stem_ends)
+// minimal energy of the free base next to the stem with assignment bp (pen = BasePenalties of the base)
+static int StemBaseEnergy(DesignContext* ctx, int base, int stem, int rel, int bp, const int* pen)
 {
-   double min = MAX_DOUBLE;
-   double MLenergy, energy;
-   double offset = 3.4;
-   double free_base_penalty = 0.0;
-   double helix_penalty = 0.4;
-   double energy_help = 0.0, energy_unbound, energy_stems;
-   int bp_i, bp_j;
-   int pair_size, base_size;
-   unsigned int i;
-   int* ML_vorgaenger; // BP_Order pos. of the stems in the ML
-   vector< vector<int> > BaseConnections;     // all connections conc. free bases
-   vector< vector<int> > BasePairConnections; // all connections conc. stems
+   int min = MAX_ENERGY;
+   int base_energy;
+   int idx[4];        // offsets in single_base_stacking_energy of the cases that apply
+   int num_idx = StemBaseCases(ctx, base, stem, rel, bp, idx);
 
-   int** bp_at_pair_connection;      // base pair assignment for a connection
-   int** MIN_bp_at_pair_connection;  // base pair assignment for a connection with min. free energy
+   for (int c=0; c<num_idx; c++)
+      for (int j=0; j<4; j++)
+      {
+         base_energy = Sum_MaxEnergy(single_base_stacking_energy[idx[c]+j],pen[j]);
+         if (base_energy < min)
+            min = base_energy;
+      }
+   return min;
+}
 
-   stem_ends.push_back(bp_pos-1);    //previous BP is a stem ending BP in the ML
-   //BP_Order[bp_pos][3]+1, since also closingBP-stems counts
-   MLenergy = offset + free_base_penalty * BP_Order[bp_pos][2] + helix_penalty * (BP_Order[bp_pos][3]+1);
-   ML_vorgaenger = MultiLoopConnections(BP_Order[bp_pos][3], stem_ends, bp_pos, BaseConnections, BasePairConnections);
 
-   // since the closing BP of the ML can be included in two connections, its assignment is fixed before testing the assignments of the other BPs
-   for (int bp_assign=0; bp_assign<6; bp_assign++)
-   {
-      //store predecessors in Trace, assignment still unknown
-      for (int vg=0; vg<BP_Order[bp_pos][3]; vg++)
-         Trace[bp_pos][bp_assign][vg][0] = ML_vorgaenger[vg];
+/******************************************************
+adds the energies of the free bases of a connection to
+the terms of the chain of its stems: a base adjacent to
+one stem k gives a term unary[k][a], a base between the
+stems k and k+1 a term pair[k][a][b] (a, b = assignments
+of the stems). A base cannot touch two stems that are
+not neighbored in the connection, unless one of them is
+fixed (fixed[k] != -1), then its term is unary, too.
+
+Return: false, if a base is adjacent to no stem (then
+no assignment gives a finite energy)
+******************************************************/
 
-      energy = MLenergy;  // energy
+bool ChainConnectionTerms(DesignContext* ctx, const int* base_connection, int base_size, const int* pair_connection, int pair_size, const int* fixed, int (*unary)[6], int (*pair)[6][6])
+{
+   const int* pen;
+   int g[2][6];     // energies of the base for the (at most two) stems it touches
+   int touched[2];
+   int num_touched;
+   int idx[4];
+   int x, y;
 
-      for (i=0; i<BaseConnections.size(); i++) //BaseConnections.size() == BasePairConnections.size()
-      {
-         pair_size = BasePairConnections[i].size();
-         base_size = BaseConnections[i].size();
+   for (int i=0; i<base_size; i++)
+   {
+      pen = BasePenalties(ctx, base_connection[i]);
 
-         bp_at_pair_connection = (int**) malloc(sizeof(int*)*pair_size);
-         MIN_bp_at_pair_connection = (int**) malloc(sizeof(int*)*pair_size);
-         for (int a=0; a<pair_size; a++)
+      num_touched = 0;
+      for (int s=Maximum(0,i-1); s<=i+1 && s<pair_size; s++)
+         if (StemBaseCases(ctx, base_connection[i], pair_connection[s], s-i, 0, idx) > 0)
          {
-            bp_at_pair_connection[a] = (int*) malloc(sizeof(int)*2);
-            MIN_bp_at_pair_connection[a] = (int*) malloc(sizeof(int)*2);
-            for (int b=0; b<2; b++)
+            if (num_touched == 2)
             {
-                bp_at_pair_connection[a][b] = 0;
-                MIN_bp_at_pair_connection[a][b] = 0;
+               cerr << "Free base " << base_connection[i] << " is adjacent to more than two stems!" << endl;
+               exit(1);
             }
+            for (int a=0; a<6; a++)
+               g[num_touched][a] = StemBaseEnergy(ctx, base_connection[i], pair_connection[s], s-i, a, pen);
+            touched[num_touched++] = s;
          }
 
-         /* for bp_at_pair_connection, each possible assignment has to be tested. Thereto a vector of size 'pair_size' is generated
+      if (num_touched == 0)
+         return false;
+
+      x = touched[0];
+      if (num_touched == 1)
+      {
+         for (int a=0; a<6; a++)
+            unary[x][a] = Sum_MaxEnergy(unary[x][a], g[0][a]);
+         continue;
+      }
+
+      y = touched[1];
+      if (y == x+1)
+      {
+         for (int a=0; a<6; a++)
+            for (int b=0; b<6; b++)
+               pair[x][a][b] = Sum_MaxEnergy(pair[x][a][b], Minimum(g[0][a], g[1][b]));
+      }
+      else if (fixed[y] != -1)
+      {
+         for (int a=0; a<6; a++)
+            unary[x][a] = Sum_MaxEnergy(unary[x][a], Minimum(g[0][a], g[1][fixed[y]]));
+      }
+      else if (fixed[x] != -1)
+      {
+         for (int b=0; b<6; b++)
+            unary[y][b] = Sum_MaxEnergy(unary[y][b], Minimum(g[0][fixed[x]], g[1][b]));
+      }
+      else
+      {
+         cerr << "Free base " << base_connection[i] << " is adjacent to two stems that are not neighbored!" << endl;
+         exit(1);
+      }
+   }
+   return true;
+}
+
 
-         the assignments are generated by generating an integer value that count up to the number of possible assignments (6^pair_size)
-         and then evaluated the representation in the 6-Number-System, e.g.: 345 = 0*6^4+1*6^3+3*6^2+3*6^1+3*6^0 ^= 01333*/
+// v is the minimum min of the chain
+static bool Chain_AtMin(int v, int min)
+{
+   return (min != MAX_ENERGY) && (v == min);
+}
 
-         // before, it is tested whether the last BP (conc. BP_Order) is included in this connection. Since this is already fixed,
-         // no further variation is needed (if the last BP is included in the connection, then at the first pos.)
 
-         int start_pos; // if the closing BP is the first one in the connection, start_pos for assigning bp_at_pair_connection
-                        // is not 0, but 1
-         int start_power;  // if the closing BP is the last in the connection, start_power for assigning bp_at_pair_connection
-                           // is not size-1, but size-2, since then the last position is already fixed
-         if (BasePairConnections[i][0] == bp_pos)
-         {
-            start_pos = 1;
-            BP2_2(bp_assign, bp_i, bp_j);
-            bp_at_pair_connection[0][0] = bp_i;
-            bp_at_pair_connection[0][1] = bp_j;
+/******************************************************
+minimal energy of a chain of m stems
 
-            if (BasePairConnections[i][pair_size-1] == bp_pos)
-            {
-               start_power = pair_size-3;
-               bp_at_pair_connection[pair_size-1][0] = bp_i;
-               bp_at_pair_connection[pair_size-1][1] = bp_j;
-            }
-            else
-               start_power = pair_size-2;
+   sum over k of unary[k][a_k] + pair[k][a_k][a_k+1]
+
+over the assignments a_k of the stems (fixed[k] != -1
+fixes the assignment of stem k), with one 6x6 step for
+each pair of neighbored stems instead of testing all
+6^m assignments. suffix[k][a] is the minimal energy of
+the stems k..m-1 with a_k = a (m rows, filled here).
+
+Return: minimal energy (MAX_ENERGY if no finite one)
+******************************************************/
+
+int ChainMinimum(int m, const int* fixed, int (*unary)[6], int (*pair)[6][6], int (*suffix)[6])
+{
+   int min, rest;
+
+   for (int k=m-1; k>=0; k--)
+      for (int a=0; a<6; a++)
+      {
+         if ((fixed[k] != -1) && (fixed[k] != a))
+         {
+            suffix[k][a] = MAX_ENERGY;
+            continue;
          }
-         else
+         rest = 0;
+         if (k < m-1)
          {
-            start_pos = 0;
-            if (BasePairConnections[i][pair_size-1] == bp_pos)
-            {
-               start_power = pair_size-2;
-               BP2_2(bp_assign, bp_i, bp_j);
-               bp_at_pair_connection[pair_size-1][0] = bp_i;
-               bp_at_pair_connection[pair_size-1][1] = bp_j;
-            }
-            else
-               start_power = pair_size-1;
+            rest = MAX_ENERGY;
+            for (int b=0; b<6; b++)
+               rest = Minimum(rest, Sum_MaxEnergy(pair[k][a][b], suffix[k+1][b]));
          }
+         suffix[k][a] = Sum_MaxEnergy(unary[k][a], rest);
+      }
 
-         min = MAX_DOUBLE;
+   min = MAX_ENERGY;
+   for (int a=0; a<6; a++)
+      min = Minimum(min, suffix[0][a]);
+   return min;
+}
 
-         //this is the case, if the connection only consists of the closing BP, then the following for-loop is not done.
-         //Nevertheless, an adjacent free base has to be analyzed.
-         if ((pair_size == 1) && (start_power == pair_size-3))
-         {
-            if (base_size == 0)
-               min = 0;
-            else
-            {
-               // energy of a connection with fixed bp-assignments of the stems (only the energy of the free bases is added here)
-               energy_unbound = BestConnectionEnergy(BaseConnections[i], BasePairConnections[i], (const int**) bp_at_pair_connection);
-               min = energy_unbound;
-            }
-         }
 
-         for (unsigned long int int_anz = 0; int_anz < (unsigned long int)pow(6,(double)(start_power+1)); int_anz++)
-         {
-            int power = start_power;
-            int value = int_anz;
-            int pos = start_pos;
-            int bp_help;
+/******************************************************
+enumerates the assignments of a chain (see ChainMinimum)
+that have the minimal energy min, in the order of the
+enumeration of all 6^m assignments (stem 0 = most
+significant digit): first = true gives the first one,
+otherwise assign is advanced to the next one
 
-            // create an assignment
-            while (power >= 0)
-            {
-               bp_help = value/(int)pow(6,(double)power);
+Return: false, if there is no further assignment
+******************************************************/
 
-               BP2_2(bp_help, bp_i, bp_j);
-               bp_at_pair_connection[pos][0]=bp_i;
-               bp_at_pair_connection[pos][1]=bp_j;
+bool ChainNextAssignment(int m, const int* fixed, int (*unary)[6], int (*pair)[6][6], int (*suffix)[6], int min, int* assign, bool first)
+{
+   int prefix, v;
+   int k = first ? 0 : m-1;
+   int from = first ? 0 : assign[m-1]+1;
+   int b;
 
-               value = (int)fmod((double)value,pow(6,(double)power));
+   while (k >= 0)
+   {
+      // energy of the stems 0..k-1 and the couplings between them
+      prefix = 0;
+      for (int t=0; t<k; t++)
+      {
+         prefix = Sum_MaxEnergy(prefix, unary[t][assign[t]]);
+         if (t < k-1)
+            prefix = Sum_MaxEnergy(prefix, pair[t][assign[t]][assign[t+1]]);
+      }
 
-               power--;
-               pos++;
-            }
+      for (b=from; b<6; b++)
+      {
+         v = Sum_MaxEnergy(prefix, suffix[k][b]);
+         if (k > 0)
+            v = Sum_MaxEnergy(v, pair[k-1][assign[k-1]][b]);
+         if (Chain_AtMin(v, min))
+            break;
+      }
 
-            // energy of a connection with fixed bp-assignments of the stems (only the energy of the free bases is added here, energy of 
-            // the stem will be added later
-            energy_unbound = BestConnectionEnergy(BaseConnections[i], BasePairConnections[i], (const int**) bp_at_pair_connection);
+      if (b < 6)
+      {
+         assign[k++] = b;
+         from = 0;
+         if (k == m)
+            return true;
+      }
+      else if (--k >= 0)
+         from = assign[k]+1;
+   }
+   return false;
+}
 
-            // add the energy of the stems (depending on the the closing BP), BUT: not closing BP!
-            energy_stems = 0.0;
-            for (int j=0; j<pair_size; j++)
-               if (BasePairConnections[i][j] != bp_pos)
-                  energy_stems = Sum_MaxDouble(energy_stems,D[BasePairConnections[i][j]][BP2int(bp_at_pair_connection[j][0],bp_at_pair_connection[j][1])]);
 
-            energy_help = Sum_MaxDouble(energy_stems, energy_unbound);
+/****************************************************************************************
+
+calculates the MINIMAL (=best) free energy of the ML, values are stored in D and Trace
 
-            if (min > energy_help)
+****************************************************************************************/
+
+void MLBestEnergy(DesignContext* ctx, int bp_pos)
+{
+   int min = MAX_ENERGY;
+   int MLenergy, energy;
+   int offset = energy_tables.ML_closing;
+   int free_base_penalty = energy_tables.ML_base;
+   int helix_penalty = energy_tables.ML_intern;
+   int min_chain;
+   int bp_i, bp_j;
+   int pair_size, base_size, max_pairs;
+   int c;
+   const LoopIndex* loops = ctx->loops;
+   const int* ML_vorgaenger = LoopStemList(loops, bp_pos); // BP_Order pos. of the stems in the ML
+   const int* base_connection;       // free bases of a connection
+   const int* pair_connection;       // stems of a connection
+
+   int* min_assign;                  // base pair assignment for a connection with min. free energy
+   int* fixed;                       // fixed assignments of the connection (closing BP), otherwise -1
+   int (*unary)[6];                  // terms of the chain of the stems of a connection (see ChainConnectionTerms)
+   int (*pair)[6][6];
+   int (*suffix)[6];
+
+   //BP_Order[bp_pos][3]+1, since also closingBP-stems counts
+   MLenergy = offset + free_base_penalty * ctx->BP_Order[bp_pos][2] + helix_penalty * (ctx->BP_Order[bp_pos][3]+1);
+
+   max_pairs = 1;
+   for (c=loops->conn_start[bp_pos]; c<loops->conn_start[bp_pos+1]; c++)
+      max_pairs = Maximum(max_pairs, ConnPairSize(loops, c));
+
+   min_assign = (int*) malloc(sizeof(int)*max_pairs);
+   fixed = (int*) malloc(sizeof(int)*max_pairs);
+   unary = (int (*)[6]) malloc(sizeof(int[6])*max_pairs);
+   pair = (int (*)[6][6]) malloc(sizeof(int[6][6])*max_pairs);
+   suffix = (int (*)[6]) malloc(sizeof(int[6])*max_pairs);
+
+   // since the closing BP of the ML can be included in two connections, its assignment is fixed before minimizing over the assignments of the other BPs
+   for (int bp_assign=0; bp_assign<6; bp_assign++)
+   {
+      energy = MLenergy;  // energy
+
+      for (c=loops->conn_start[bp_pos]; c<loops->conn_start[bp_pos+1]; c++)
+      {
+         pair_size = ConnPairSize(loops, c);
+         pair_connection = ConnPairList(loops, c);
+         base_size = ConnBaseSize(loops, c);
+         base_connection = ConnBaseList(loops, c);
+
+         // the stems of a connection form a chain: each free base is adjacent to at most two neighbored stems. The stem
+         // energies and the energies of the bases next to one stem are unary terms, a base between two stems couples them.
+         // The closing BP (first and/or last in the connection) is fixed to bp_assign.
+         for (int a=0; a<pair_size; a++)
+         {
+            fixed[a] = (pair_connection[a] == bp_pos) ? bp_assign : -1;
+            for (int b=0; b<6; b++)
             {
-               min = energy_help;
-               for (int a=0; a<pair_size; a++)
-               {
-                   MIN_bp_at_pair_connection[a][0] = bp_at_pair_connection[a][0];
-                   MIN_bp_at_pair_connection[a][1] = bp_at_pair_connection[a][1];
-               }
+               unary[a][b] = (fixed[a] == -1) ? ctx->D[pair_connection[a]][b] : 0;
+               for (int c=0; c<6; c++)
+                  pair[a][b][c] = 0;
             }
-         }// for int_anz
+         }
+
+         min_chain = MAX_ENERGY;
+         if (ChainConnectionTerms(ctx, base_connection, base_size, pair_connection, pair_size, fixed, unary, pair))
+            min_chain = ChainMinimum(pair_size, fixed, unary, pair, suffix);
+
+         // the minimum of the chain is exact, its first minimal assignment (in the order of testing all assignments)
+         // is the one that testing all assignments would choose
+         min = MAX_ENERGY;
+         if ((min_chain != MAX_ENERGY) && ChainNextAssignment(pair_size, fixed, unary, pair, suffix, min_chain, min_assign, true))
+            min = min_chain;
 
          // if no valid assignment was found, set a random one (this is the case, if in the loop a BP exists, that has no valid assignment
          // concerning the constraints --> usually this error is filtered before)
-         if (min == MAX_DOUBLE)
+         if (min == MAX_ENERGY)
             for (int a=0; a<pair_size; a++)
-            {
-               int rand_bp = RandomBasePair();
-               BP2_2(rand_bp, MIN_bp_at_pair_connection[a][0], MIN_bp_at_pair_connection[a][1]);
-            }
+               min_assign[a] = RandomBasePair(ctx->rng);
 
          // add minimal energy that arises because of the free bases in the ML
-         energy = Sum_MaxDouble(energy,min);
+         energy = Sum_MaxEnergy(energy,min);
 
          // store best assignment of the predecessors in the traceback
          for (int a=0; a<pair_size; a++)
-            if (BasePairConnections[i][a] != bp_pos)
-               for (int vg = 0; vg<BP_Order[bp_pos][3]; vg++)
-                  if (BasePairConnections[i][a] == Trace[bp_pos][bp_assign][vg][0])
-                     Trace[bp_pos][bp_assign][vg][1] = BP2int(MIN_bp_at_pair_connection[a][0], MIN_bp_at_pair_connection[a][1]);
-
-         for (int c=0; c<pair_size; c++)
-         {
-            free(bp_at_pair_connection[c]);
-            free(MIN_bp_at_pair_connection[c]);
-         }
-         free(bp_at_pair_connection);
-         free(MIN_bp_at_pair_connection);
-      } // for i
+            if (pair_connection[a] != bp_pos)
+               for (int vg = 0; vg<ctx->BP_Order[bp_pos][3]; vg++)
+                  if (pair_connection[a] == ML_vorgaenger[vg])
+                     TraceAssign(ctx, bp_pos, bp_assign, vg) = min_assign[a];
+      } // for c
       
       BP2_2(bp_assign, bp_i, bp_j);
-      D[bp_pos][bp_assign] = Sum_MaxDouble3(energy, Zero_or_StemEndAU(bp_pos, bp_assign),PairPenalty(bp_pos, bp_i, bp_j));
+      ctx->D[bp_pos][bp_assign] = Sum_MaxEnergy3(energy, Zero_or_StemEndAU(ctx, bp_pos, bp_assign),PairPenalty(ctx, bp_pos, bp_i, bp_j));
 
    } //for bp_assign
 
-   for (i=0; i<BaseConnections.size(); i++)
-      BaseConnections[i].clear();
-   BaseConnections.clear();
-
-   for (i=0; i<BasePairConnections.size(); i++)
-      BasePairConnections[i].clear();
-   BasePairConnections.clear();
+   free(min_assign);
+   free(fixed);
+   free(unary);
+   free(pair);
+   free(suffix);
 }
 
 
@@ -640,117 +641,35 @@ for the difference of two assignments of it)
 
 ****************************************************************************************/
 
-double MLEnergy(int bp_pos, int* int_seq)
+int MLEnergy(DesignContext* ctx, int bp_pos, int* int_seq)
 {
-   double energy = 0.0;
-   //double offset = 3.4;
-   //double free_base_penalty = 0.0;
-   //double helix_penalty = 0.4;
-   double energy_unbound;
-   int pair_size, base_size;
-   unsigned int i, j;
-   int** BaseConnections;     // all connections, concerning free bases
-   int** BasePairConnections; // all connections, concerning stems
-   int* BaseSizes;            // sizes of the base connections
-   int* BasePairSizes;        // sizes of the stem connections
-
+   int energy = 0;
+   //int offset = 340;
+   //int free_base_penalty = 0;
+   //int helix_penalty = 40;
+   int energy_unbound;
+   int c;
    int bp_assign; // assignment of the closing BP
-   int num_conns;
-   int* stem_ends;
-   unsigned int con_size = BP_Order[bp_pos][3]+2; // in order that base and basepairconn. have the same size, no conn. can be bigger than #stems+2 and all together
-                                                  // there can not be more (since only adjacent free base are taken into account)
-   stem_ends = FindStemEnds(bp_pos);
-
-   BaseConnections = (int**) malloc(sizeof(int*)*con_size);
-   BaseSizes = (int*) malloc(sizeof(int)*con_size);
-   for (i=0; i<con_size; i++)
-   {
-      BaseConnections[i] = (int*) malloc(sizeof(int) * con_size);
-      BaseSizes[i] = -1;
-      for (j=0;j<con_size; j++)
-         BaseConnections[i][j] = -1;
-   }
-
-   BasePairConnections = (int**) malloc(sizeof(int*)*con_size);
-   BasePairSizes = (int*) malloc(sizeof(int) * con_size);
-   for (i=0; i<con_size; i++)
-   {
-      BasePairConnections[i] = (int*) malloc(sizeof(int) * con_size);
-      BasePairSizes[i] = -1;
-      for (j=0;j<con_size; j++)
-         BasePairConnections[i][j] = -1;
-   }
+   const LoopIndex* loops = ctx->loops;
 
    //BP_Order[bp_pos][3]+1, since also the closing BP counts
    //energy = offset + free_base_penalty * BP_Order[bp_pos][2] + helix_penalty * (BP_Order[bp_pos][3]+1);
-   MultiLoopConnections(stem_ends, bp_pos, BaseConnections, BaseSizes, BasePairConnections, BasePairSizes);
-   bp_assign = BP2int(int_seq[BP_Order[bp_pos][0]], int_seq[BP_Order[bp_pos][1]]);
+   bp_assign = BP2int(int_seq[ctx->BP_Order[bp_pos][0]], int_seq[ctx->BP_Order[bp_pos][1]]);
 
-   //count the existing connections:
-   num_conns = 0;
-   for (i=0; i<con_size; i++)
+   for (c=loops->conn_start[bp_pos]; c<loops->conn_start[bp_pos+1]; c++)
    {
-      if ((BaseConnections[i][0] != -1) || (BasePairConnections[i][0] != -1))
-         num_conns++;
-      else
-         break;
-   }
-
-   for (i=0; i<(unsigned int)num_conns; i++) //BaseConnections.size() == BasePairConnections.size()
-   {
-      pair_size = BasePairSizes[i];
-      base_size = BaseSizes[i];
-
       // energy of one connection (just energy of the free bases)
-      energy_unbound = ConnectionEnergy(BaseConnections[i], base_size, BasePairConnections[i], pair_size, int_seq);
-      energy = Sum_MaxDouble(energy, energy_unbound);
-   } // for i
+      energy_unbound = ConnectionEnergy(ctx, ConnBaseList(loops, c), ConnBaseSize(loops, c), ConnPairList(loops, c), ConnPairSize(loops, c), int_seq);
+      energy = Sum_MaxEnergy(energy, energy_unbound);
+   } // for c
 
    //base pair penalty only for the closingBP
-   energy = Sum_MaxDouble3(energy, PairPenalty(bp_pos,int_seq[BP_Order[bp_pos][0]],int_seq[BP_Order[bp_pos][1]]), Zero_or_StemEndAU(bp_pos, bp_assign));
-
-   for (i=0; i<con_size; i++)
-      free(BaseConnections[i]);
-   free(BaseConnections);
-
-   for (i=0; i<con_size; i++)
-      free(BasePairConnections[i]);
-   free(BasePairConnections);
+   energy = Sum_MaxEnergy3(energy, PairPenalty(ctx, bp_pos,int_seq[ctx->BP_Order[bp_pos][0]],int_seq[ctx->BP_Order[bp_pos][1]]), Zero_or_StemEndAU(ctx, bp_pos, bp_assign));
 
    return energy;
 }
 
 
-
-/*****************************************************************
-
-Finds all BPs that are stems ends in a ML
-
-*****************************************************************/
-
-int* FindStemEnds(int closingBP)
-{
-   int i, bp_j;
-   int* stem_ends;
-   stem_ends = (int*) malloc(sizeof(int)*BP_Order[closingBP][3]);
-
-   //previous base pair in BP_Order is a closingBP
-   stem_ends[0] = closingBP - 1;
-
-   for (i=1; i<BP_Order[closingBP][3]; i++)
-   {
-      bp_j = BP_Order[stem_ends[i-1]][1]+1;
-      while (brackets[bp_j] != '(')
-         bp_j++;
-      stem_ends[i] = BP_Pos_Nr[bp_j];
-   }
-   return stem_ends;
-}
-
-
-
-
-
 /******************************************************
 
 finds the assignment with minimal free energy for the 
@@ -764,11 +683,10 @@ bp_at_pair_connection = BP assignment for pair_connection
 
 ******************************************************/
 
-int* ConnectionBestFreeBases(const vector<int> & base_connection, const vector<int> & pair_connection, const int** bp_at_pair_connection)
+int* ConnectionBestFreeBases(DesignContext* ctx, const int* base_connection, int base_size, const int* pair_connection, int pair_size, const int** bp_at_pair_connection)
 {
-   double min = MAX_DOUBLE;
-   double base_energy;
-   int base_size = (int)base_connection.size();
+   int min = MAX_ENERGY;
+   int base_energy;
    int min_base=0;
    int* min_bases;
    min_bases = (int*) malloc(sizeof(int)*base_size);
@@ -781,15 +699,15 @@ int* ConnectionBestFreeBases(const vector<int> & base_connection, const vector<i
 
       //bases in base_connection[i] may be neighbored to base pairs in
       //pair_connection[i-1] [i] or/and [i+1] => testing (and also whether the respecting field in the vector exists)
-      min = MAX_DOUBLE;
+      min = MAX_ENERGY;
 
       if (i-1 >= 0)  /*case BP_Order[pair_connection[i-1]][0] not possible*/
       {
          // usual case: base is located right of (= after) the stem
-         if (BP_Order[pair_connection[i-1]][1]+1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i-1]][1]+1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[16*bp_at_pair_connection[i-1][1]+4*bp_at_pair_connection[i-1][0]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[16*bp_at_pair_connection[i-1][1]+4*bp_at_pair_connection[i-1][0]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                {
                   min = base_energy;
@@ -798,13 +716,13 @@ int* ConnectionBestFreeBases(const vector<int> & base_connection, const vector<i
             }
       }
 
-      if (i < (int)pair_connection.size())
+      if (i < pair_size)
       {
          // if the left stem is the closing BP
-         if (BP_Order[pair_connection[i]][0]+1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i]][0]+1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[16*bp_at_pair_connection[i][0]+4*bp_at_pair_connection[i][1]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[16*bp_at_pair_connection[i][0]+4*bp_at_pair_connection[i][1]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                {
                   min = base_energy;
@@ -813,10 +731,10 @@ int* ConnectionBestFreeBases(const vector<int> & base_connection, const vector<i
             }
 
          // usual case: base is located left of (= before) the stem
-         if (BP_Order[pair_connection[i]][0]-1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i]][0]-1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[64+16*bp_at_pair_connection[i][1]+4*bp_at_pair_connection[i][0]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[64+16*bp_at_pair_connection[i][1]+4*bp_at_pair_connection[i][0]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                {
                   min = base_energy;
@@ -825,10 +743,10 @@ int* ConnectionBestFreeBases(const vector<int> & base_connection, const vector<i
             }
 
          // usual case: base is located right of (= after) the stem
-         if (BP_Order[pair_connection[i]][1]+1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i]][1]+1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[16*bp_at_pair_connection[i][1]+4*bp_at_pair_connection[i][0]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[16*bp_at_pair_connection[i][1]+4*bp_at_pair_connection[i][0]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                {
                   min = base_energy;
@@ -837,10 +755,10 @@ int* ConnectionBestFreeBases(const vector<int> & base_connection, const vector<i
             }
 
          // if the right stem is the closing BP
-         if (BP_Order[pair_connection[i]][1]-1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i]][1]-1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[64+16*bp_at_pair_connection[i][0]+4*bp_at_pair_connection[i][1]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[64+16*bp_at_pair_connection[i][0]+4*bp_at_pair_connection[i][1]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                {
                   min = base_energy;
@@ -849,13 +767,13 @@ int* ConnectionBestFreeBases(const vector<int> & base_connection, const vector<i
             }
       }
 
-      if ( i+1 < (int)pair_connection.size())
+      if ( i+1 < pair_size)
       {
          // usual case: base is located left of (= before) the stem
-         if (BP_Order[pair_connection[i+1]][0]-1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i+1]][0]-1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[64+16*bp_at_pair_connection[i+1][1]+4*bp_at_pair_connection[i+1][0]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[64+16*bp_at_pair_connection[i+1][1]+4*bp_at_pair_connection[i+1][0]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                {
                   min = base_energy;
@@ -864,10 +782,10 @@ int* ConnectionBestFreeBases(const vector<int> & base_connection, const vector<i
             }
 
          // if the right stem is the closing BP
-         if (BP_Order[pair_connection[i+1]][1]-1 == base_connection[i])
+         if (ctx->BP_Order[pair_connection[i+1]][1]-1 == base_connection[i])
             for (int j=0; j<4; j++)
             {
-               base_energy = Sum_MaxDouble(single_base_stacking_energy[64+16*bp_at_pair_connection[i+1][0]+4*bp_at_pair_connection[i+1][1]+j],BasePenalty(base_connection[i],j));
+               base_energy = Sum_MaxEnergy(single_base_stacking_energy[64+16*bp_at_pair_connection[i+1][0]+4*bp_at_pair_connection[i+1][1]+j],BasePenalty(ctx, base_connection[i],j));
                if (base_energy < min)
                {
                   min = base_energy;
@@ -7,16 +7,18 @@
 
 using namespace std;
 
-int* MultiLoopConnections(int stem_num, vector<int> & stem_ends, int order_pos_of_closing_bp, vector< vector<int> > & BaseConnections, vector< vector<int> > & BasePairConnections);
-void MultiLoopConnections(int* stem_ends, int order_pos_of_closing_bp, int** BaseConnections, int *BaseSizes, int** BasePairConnections, int* BasePairSizes);
 
-double BestConnectionEnergy(const vector<int> & base_connection, const vector<int> & pair_connection, const int** bp_at_pair_connection);
-double ConnectionEnergy(const int* base_connection, int base_size, const int* pair_connection, int bp_size, int* int_seq);
+int* MultiLoopConnections(DesignContext* ctx, int stem_num, vector<int> & stem_ends, int order_pos_of_closing_bp, vector< vector<int> > & BaseConnections, vector< vector<int> > & BasePairConnections);
 
-void MLBestEnergy(int bp_pos, vector<int> & stem_ends);
-double MLEnergy(int bp_pos, int* int_seq);
-int* FindStemEnds(int closingBP);
+int BestConnectionEnergy(DesignContext* ctx, const vector<int> & base_connection, const vector<int> & pair_connection, const int** bp_at_pair_connection);
+int ConnectionEnergy(DesignContext* ctx, const int* base_connection, int base_size, const int* pair_connection, int bp_size, int* int_seq);
+bool ChainConnectionTerms(DesignContext* ctx, const int* base_connection, int base_size, const int* pair_connection, int pair_size, const int* fixed, int (*unary)[6], int (*pair)[6][6]);
+int ChainMinimum(int m, const int* fixed, int (*unary)[6], int (*pair)[6][6], int (*suffix)[6]);
+bool ChainNextAssignment(int m, const int* fixed, int (*unary)[6], int (*pair)[6][6], int (*suffix)[6], int min, int* assign, bool first);
 
-int* ConnectionBestFreeBases(const vector<int> & base_connection, const vector<int> & pair_connection, const int** bp_at_pair_connection);
+void MLBestEnergy(DesignContext* ctx, int bp_pos);
+int MLEnergy(DesignContext* ctx, int bp_pos, int* int_seq);
+
+int* ConnectionBestFreeBases(DesignContext* ctx, const int* base_connection, int base_size, const int* pair_connection, int pair_size, const int** bp_at_pair_connection);
 
 #endif   // _MULTI_ENERGY_
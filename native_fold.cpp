@@ -0,0 +1,917 @@
+
+#include "native_fold.h"
+#include "min_plus.h"
+
+const int NF_TURN = 3;      // minimal size of a hairpin loop
+const int NF_MAXLOOP = 30;  // maximal size of interior loops and bulges during the folding
+const int NF_BLOCK = 64;    // side of the blocks of cells filled by one thread (wavefront)
+
+/**********************************************************************************
+*  energy parameters in dcal/mol, copied once from the tables in ./data           *
+**********************************************************************************/
+
+struct NativeParams
+{
+   int stack[256];
+   int mismatchH[256];
+   int mismatchI[256];
+   int dangle[128];
+   int int11[576];
+   int int12[2304];
+   int int22[9216];
+   int hairpin[31];
+   int bulge[31];
+   int interior[31];
+   int tetra[4096];
+   double lxc;
+   int ML_closing;
+   int ML_intern;
+   int ML_base;
+   int TerminalAU;
+   int ninio;
+   int max_ninio;
+};
+
+static NativeParams P;
+static bool params_set = false;
+
+// pair type of two bases (0=AU, 1=CG, 2=GC, 3=UA, 4=GU, 5=UG, -1 = no pair)
+static const int pair_type[4][4] = { {-1,-1,-1, 0},
+                                     {-1,-1, 1,-1},
+                                     {-1, 2,-1, 4},
+                                     { 3,-1, 5,-1} };
+
+static void set_native_params()
+{
+   int i;
+
+   for (i=0; i<256; i++)
+   {
+      P.stack[i] = stacking_energies[i];
+      P.mismatchH[i] = mismatch_energies_hairpin[i];
+      P.mismatchI[i] = mismatch_energies_interior[i];
+   }
+   for (i=0; i<128; i++)
+      P.dangle[i] = single_base_stacking_energy[i];
+   for (i=0; i<576; i++)
+      P.int11[i] = interior_loop_1_1_energy[i];
+   for (i=0; i<2304; i++)
+      P.int12[i] = interior_loop_1_2_energy[i];
+   for (i=0; i<9216; i++)
+      P.int22[i] = interior_loop_2_2_energy[i];
+
+   P.interior[0] = P.bulge[0] = P.hairpin[0] = NATIVE_INF;
+   for (i=1; i<=30; i++)
+   {
+      P.interior[i] = loop_destabilizing_energies[3*(i-1)];
+      P.bulge[i] = loop_destabilizing_energies[3*(i-1)+1];
+      P.hairpin[i] = loop_destabilizing_energies[3*(i-1)+2];
+   }
+   P.lxc = energy_tables.lxc;
+
+   // tetraloop boni, indexed by the hexamer (closing BP included) with 2 bits per base (TETRA_INDEX)
+   for (i=0; i<4096; i++)
+      P.tetra[i] = tetra_loop_energy(i);
+
+   // multiloop parameters as used in MLBestEnergy
+   P.ML_closing = energy_tables.ML_closing;
+   P.ML_intern = energy_tables.ML_intern;
+   P.ML_base = energy_tables.ML_base;
+
+   P.TerminalAU = energy_tables.terminalAU;
+   P.ninio = energy_tables.ninio;
+   P.max_ninio = energy_tables.max_ninio;
+
+   params_set = true;
+}
+
+// the parameters are set by the first design that needs them, designs may run in parallel (batch mode)
+static void native_params()
+{
+   #pragma omp critical(native_params)
+   if (!params_set)
+      set_native_params();
+}
+
+// the energy tables were changed (parameter file), the next design copies them again
+void native_fold_params_changed()
+{
+   #pragma omp critical(native_params)
+   params_set = false;
+}
+
+/**********************************************************************************
+*                         loop energies of the model                              *
+**********************************************************************************/
+
+static inline int encode_base(char c)
+{
+   switch (toupper(c))
+   {
+      case 'C': return 1;
+      case 'G': return 2;
+      case 'U':
+      case 'T': return 3;
+      default : return 0;
+   }
+}
+
+static inline int AU_penalty(int type)
+{
+   if ((type == 0) || (type == 3) || (type == 4) || (type == 5))
+      return P.TerminalAU;
+   return 0;
+}
+
+static inline int loop_size_energy(const int* tab, int size)
+{
+   if (size <= 30)
+      return tab[size];
+   return tab[30] + (int)(P.lxc*log((double)size/30.0));
+}
+
+static int E_hairpin(const int* S, int i, int j, int type)
+{
+   int size = j-i-1;
+   int e;
+
+   if (size < NF_TURN)
+      return NATIVE_INF;
+
+   e = loop_size_energy(P.hairpin, size);
+   // triloops: terminal AU only, Vienna 1.x has no triloop bonus (the C3 penalty of the initializing step isn't used)
+   if (size == 3)
+      return e + AU_penalty(type);
+   e += P.mismatchH[64*S[i]+16*S[i+1]+4*S[j]+S[j-1]];
+   if (size == 4)
+      e += P.tetra[TETRA_INDEX(S[i], S[i+1], S[i+2], S[i+3], S[i+4], S[i+5])];
+   return e;
+}
+
+// stack, bulge or interior loop closed by (i,j) (type) and (p,q) (type2)
+static int E_interior(const int* S, int i, int j, int p, int q, int type, int type2)
+{
+   int u1 = p-i-1;
+   int u2 = j-q-1;
+   int e, asym;
+
+   if ((u1 == 0) && (u2 == 0))
+      return P.stack[64*S[i]+16*S[p]+4*S[j]+S[q]];
+
+   if ((u1 == 0) || (u2 == 0))
+   {
+      e = loop_size_energy(P.bulge, u1+u2);
+      if (u1+u2 == 1)
+         e += P.stack[64*S[i]+16*S[p]+4*S[j]+S[q]];
+      else
+         e += AU_penalty(type) + AU_penalty(type2);
+      return e;
+   }
+
+   if ((u1 == 1) && (u2 == 1))
+      return P.int11[96*type+24*S[i+1]+4*type2+S[j-1]];
+   if ((u1 == 1) && (u2 == 2))
+      return P.int12[384*type+96*S[j-2]+24*S[i+1]+4*type2+S[j-1]];
+   if ((u1 == 2) && (u2 == 1))
+      return P.int12[384*type2+96*S[i+1]+24*S[j-1]+4*type+S[i+2]];
+   if ((u1 == 2) && (u2 == 2))
+      return P.int22[1536*type+256*type2+64*S[i+1]+16*S[j-1]+4*S[i+2]+S[j-2]];
+
+   e = loop_size_energy(P.interior, u1+u2);
+   asym = P.ninio*abs(u1-u2);
+   if (asym > P.max_ninio)
+      asym = P.max_ninio;
+   e += asym;
+   e += P.mismatchI[64*S[i]+16*S[i+1]+4*S[j]+S[j-1]] + P.mismatchI[64*S[q]+16*S[q+1]+4*S[p]+S[p-1]];
+   return e;
+}
+
+// stem (i,j) in the exterior loop or in a multiloop, dangles on both sides (-d2)
+static inline int E_stem(const int* S, int n, int i, int j, int type)
+{
+   int e = AU_penalty(type);
+   if (i>0)
+      e += P.dangle[64+16*S[j]+4*S[i]+S[i-1]];
+   if (j<n-1)
+      e += P.dangle[16*S[j]+4*S[i]+S[j+1]];
+   return e;
+}
+
+static inline int E_ml_closing(const int* S, int i, int j, int type)
+{
+   return P.ML_closing + P.ML_intern + AU_penalty(type) + P.dangle[16*S[i]+4*S[j]+S[i+1]] + P.dangle[64+16*S[i]+4*S[j]+S[j-1]];
+}
+
+/**********************************************************************************
+*                             filling the matrices                                *
+**********************************************************************************/
+
+/*****************************************************************
+ FMc and FM1c hold FM and FM1 column by column, so that both
+ operands of the multiloop decompositions are contiguous and
+ their minimum is taken by the vector kernel (Min_Plus); FM1 is
+ only kept in columns
+*****************************************************************/
+
+// FM1(i,j) from FM1(i,j-1) and C(i,j) = c
+static inline int FM1_cell(const NativeFold* nf, const int* S, int i, int j, int c)
+{
+   int best = nf->FM1c[nf->jindx[j-1]+i] + P.ML_base;
+   int e;
+
+   if (c < NATIVE_INF)
+   {
+      e = c + P.ML_intern + E_stem(S, nf->len, i, j, pair_type[S[i]][S[j]]);
+      if (e < best)
+         best = e;
+   }
+   return (best < NATIVE_INF) ? best : NATIVE_INF;
+}
+
+static void fill_cell(const NativeFold* nf, const int* S, int i, int j)
+{
+   const int* iindx = nf->iindx;
+   const int* jindx = nf->jindx;
+   int *C = nf->C, *FM = nf->FM, *FMc = nf->FMc, *FM1c = nf->FM1c;
+   int n = nf->len;
+   int ij = iindx[i]+j;
+   int type = pair_type[S[i]][S[j]];
+   int c = NATIVE_INF;
+   int e, p, q, k, u1, minq, type2, best, len;
+
+   if (type >= 0)
+   {
+      c = E_hairpin(S, i, j, type);
+
+      // stacks, bulges and interior loops
+      for (p=i+1; (p<=i+NF_MAXLOOP+1) && (p<j-NF_TURN-1); p++)
+      {
+         u1 = p-i-1;
+         minq = j-1-(NF_MAXLOOP-u1);
+         if (minq < p+NF_TURN+1)
+            minq = p+NF_TURN+1;
+         for (q=j-1; q>=minq; q--)
+         {
+            type2 = pair_type[S[p]][S[q]];
+            if ((type2 < 0) || (C[iindx[p]+q] >= NATIVE_INF))
+               continue;
+            e = E_interior(S, i, j, p, q, type, type2) + C[iindx[p]+q];
+            if (e < c)
+               c = e;
+         }
+      }
+
+      // multiloop: FM(i+1,k) + FM1(k+1,j-1) for k = i+NF_TURN+2..j-NF_TURN-3
+      k = i+NF_TURN+2;
+      len = j-NF_TURN-3 - k + 1;
+      best = (len > 0) ? Min_Plus(FM+iindx[i+1]+k, FM1c+jindx[j-1]+k+1, len, NATIVE_INF) : NATIVE_INF;
+      if (best < NATIVE_INF)
+      {
+         e = best + E_ml_closing(S, i, j, type);
+         if (e < c)
+            c = e;
+      }
+   }
+   C[ij] = c;
+
+   // exactly one stem starting at i
+   FM1c[jindx[j]+i] = FM1_cell(nf, S, i, j, c);
+
+   // at least one stem
+   best = FM[iindx[i+1]+j] + P.ML_base;
+   e = FM[ij-1] + P.ML_base;
+   if (e < best)
+      best = e;
+   if (c < NATIVE_INF)
+   {
+      e = c + P.ML_intern + E_stem(S, n, i, j, type);
+      if (e < best)
+         best = e;
+   }
+   // FM(i,k) + FM(k+1,j) for k = i+NF_TURN+1..j-NF_TURN-2
+   k = i+NF_TURN+1;
+   len = j-NF_TURN-2 - k + 1;
+   if (len > 0)
+      best = Min_Plus(FM+iindx[i]+k, FMc+jindx[j]+k+1, len, best);
+   FM[ij] = FMc[jindx[j]+i] = (best < NATIVE_INF) ? best : NATIVE_INF;
+}
+
+
+/*****************************************************************
+ fills the cells (i,j) with i < rows and j >= first[i] (first[i]
+ < 0: row i is not filled). All cells that a cell depends on
+ are shorter, so the matrices are cut into blocks of NF_BLOCK x
+ NF_BLOCK cells (that stay in the cache while they are filled):
+ the blocks of one anti-diagonal of blocks only depend on the
+ blocks of the anti-diagonals before and on themselves, they
+ are filled in parallel (each block row by row from the bottom)
+*****************************************************************/
+
+static void fill_block(const NativeFold* nf, const int* S, int rows, const int* first, int bi, int bj)
+{
+   int i, j, from;
+   int last_i = Minimum(rows, (bi+1)*NF_BLOCK) - 1;
+   int last_j = Minimum(nf->len, (bj+1)*NF_BLOCK) - 1;
+
+   for (i=last_i; i>=bi*NF_BLOCK; i--)
+   {
+      if (first[i] < 0)
+         continue;
+      from = Maximum(Maximum(first[i], i+NF_TURN+1), bj*NF_BLOCK);
+      for (j=from; j<=last_j; j++)
+         fill_cell(nf, S, i, j);
+   }
+}
+
+static void fill_rows(const NativeFold* nf, const int* S, int rows, const int* first)
+{
+   int n = nf->len;
+   int blocks = (n+NF_BLOCK-1)/NF_BLOCK;
+   int row_blocks = (rows+NF_BLOCK-1)/NF_BLOCK;
+   int i, j;
+
+   if (n <= NF_BLOCK)
+   {
+      for (i=rows-1; i>=0; i--)
+      {
+         if (first[i] < 0)
+            continue;
+         for (j=Maximum(first[i], i+NF_TURN+1); j<n; j++)
+            fill_cell(nf, S, i, j);
+      }
+      return;
+   }
+
+   #pragma omp parallel num_threads(nf->threads) if (nf->threads > 1)
+   for (int d=0; d<blocks; d++)
+   {
+      #pragma omp for schedule(dynamic,1)
+      for (int bi=0; bi<Minimum(row_blocks, blocks-d); bi++)
+         fill_block(nf, S, rows, first, bi, bi+d);
+   }
+}
+
+
+static void fill_F5(const NativeFold* nf, const int* S, int from)
+{
+   const int* iindx = nf->iindx;
+   const int* C = nf->C;
+   int* F5 = nf->F5;
+   int n = nf->len;
+   int j, k, f, e;
+
+   for (j=from; j<n; j++)
+   {
+      f = (j>0) ? F5[j-1] : 0;
+      for (k=0; k<j-NF_TURN; k++)
+      {
+         if (C[iindx[k]+j] >= NATIVE_INF)
+            continue;
+         e = ((k>0) ? F5[k-1] : 0) + C[iindx[k]+j] + E_stem(S, n, k, j, pair_type[S[k]][S[j]]);
+         if (e < f)
+            f = e;
+      }
+      F5[j] = f;
+   }
+}
+
+/**********************************************************************************
+*                                  traceback                                      *
+*  sectors: 0 = exterior loop [0..j], 1 = (i,j) paired, 2 = FM(i,j), 3 = FM1(i,j) *
+**********************************************************************************/
+
+static void native_backtrack(const NativeFold* nf, const int* S, char backtrack, char* structure)
+{
+   const int* iindx = nf->iindx;
+   const int* jindx = nf->jindx;
+   const int *C = nf->C, *FM = nf->FM, *FM1c = nf->FM1c, *F5 = nf->F5;
+   int n = nf->len;
+   int* sector = nf->sector;
+   int s = 0;
+   int i, j, kind, ij, k, p, q, u1, minq, type, type2, e, found;
+
+   for (k=0; k<n; k++)
+      structure[k] = '.';
+   structure[n] = '\0';
+   if (n == 0)
+      return;
+
+   sector[s++] = 0;
+   sector[s++] = n-1;
+   sector[s++] = (backtrack == 'C') ? 1 : ((backtrack == 'M') ? 2 : 0);
+
+   while (s > 0)
+   {
+      kind = sector[--s];
+      j = sector[--s];
+      i = sector[--s];
+      ij = iindx[i]+j;
+
+      if (kind == 0)
+      {
+         if (j <= NF_TURN)
+            continue;
+         if (F5[j] == F5[j-1])
+         {
+            sector[s++] = 0; sector[s++] = j-1; sector[s++] = 0;
+            continue;
+         }
+         for (k=0; k<j-NF_TURN; k++)
+         {
+            if (C[iindx[k]+j] >= NATIVE_INF)
+               continue;
+            e = ((k>0) ? F5[k-1] : 0) + C[iindx[k]+j] + E_stem(S, n, k, j, pair_type[S[k]][S[j]]);
+            if (e == F5[j])
+            {
+               sector[s++] = k; sector[s++] = j; sector[s++] = 1;
+               if (k > 0)
+               {
+                  sector[s++] = 0; sector[s++] = k-1; sector[s++] = 0;
+               }
+               break;
+            }
+         }
+      }
+      else if (kind == 1)
+      {
+         if (C[ij] >= NATIVE_INF)
+            continue;
+         structure[i] = '(';
+         structure[j] = ')';
+         type = pair_type[S[i]][S[j]];
+
+         if (C[ij] == E_hairpin(S, i, j, type))
+            continue;
+
+         found = 0;
+         for (p=i+1; (p<=i+NF_MAXLOOP+1) && (p<j-NF_TURN-1) && (!found); p++)
+         {
+            u1 = p-i-1;
+            minq = j-1-(NF_MAXLOOP-u1);
+            if (minq < p+NF_TURN+1)
+               minq = p+NF_TURN+1;
+            for (q=j-1; q>=minq; q--)
+            {
+               type2 = pair_type[S[p]][S[q]];
+               if ((type2 < 0) || (C[iindx[p]+q] >= NATIVE_INF))
+                  continue;
+               if (C[ij] == E_interior(S, i, j, p, q, type, type2) + C[iindx[p]+q])
+               {
+                  sector[s++] = p; sector[s++] = q; sector[s++] = 1;
+                  found = 1;
+                  break;
+               }
+            }
+         }
+         if (found)
+            continue;
+
+         e = C[ij] - E_ml_closing(S, i, j, type);
+         for (k=i+NF_TURN+2; k<=j-NF_TURN-3; k++)
+            if (FM[iindx[i+1]+k] + FM1c[jindx[j-1]+k+1] == e)
+            {
+               sector[s++] = i+1; sector[s++] = k; sector[s++] = 2;
+               sector[s++] = k+1; sector[s++] = j-1; sector[s++] = 3;
+               break;
+            }
+      }
+      else if (kind == 2)
+      {
+         if ((j-i <= NF_TURN) || (FM[ij] >= NATIVE_INF))
+            continue;
+         if (FM[ij] == FM[iindx[i+1]+j] + P.ML_base)
+         {
+            sector[s++] = i+1; sector[s++] = j; sector[s++] = 2;
+            continue;
+         }
+         if (FM[ij] == FM[ij-1] + P.ML_base)
+         {
+            sector[s++] = i; sector[s++] = j-1; sector[s++] = 2;
+            continue;
+         }
+         if ((C[ij] < NATIVE_INF) && (FM[ij] == C[ij] + P.ML_intern + E_stem(S, n, i, j, pair_type[S[i]][S[j]])))
+         {
+            sector[s++] = i; sector[s++] = j; sector[s++] = 1;
+            continue;
+         }
+         for (k=i+NF_TURN+1; k<=j-NF_TURN-2; k++)
+            if (FM[ij] == FM[iindx[i]+k] + FM[iindx[k+1]+j])
+            {
+               sector[s++] = i; sector[s++] = k; sector[s++] = 2;
+               sector[s++] = k+1; sector[s++] = j; sector[s++] = 2;
+               break;
+            }
+      }
+      else
+      {
+         if ((j-i <= NF_TURN) || (FM1c[jindx[j]+i] >= NATIVE_INF))
+            continue;
+         if (FM1c[jindx[j]+i] == FM1c[jindx[j-1]+i] + P.ML_base)
+         {
+            sector[s++] = i; sector[s++] = j-1; sector[s++] = 3;
+         }
+         else
+         {
+            sector[s++] = i; sector[s++] = j; sector[s++] = 1;
+         }
+      }
+   }
+}
+
+/**********************************************************************************
+*                     allocation and sequence handling                            *
+**********************************************************************************/
+
+static void* nf_alloc(size_t size)
+{
+   void* p = malloc(size);
+   if (p == NULL)
+   {
+      cerr << "Not enough memory for the native folding engine!\n";
+      exit(1);
+   }
+   return p;
+}
+
+NativeFold* native_fold_alloc(int max_len, int threads)
+{
+   NativeFold* nf;
+   size_t cells = ((size_t)max_len*(max_len+1))/2 + 1;
+
+   native_params();
+
+   nf = (NativeFold*) nf_alloc(sizeof(NativeFold));
+   nf->max_len = max_len;
+   nf->threads = threads;
+   nf->len = 0;
+   nf->iindx = (int*) nf_alloc(sizeof(int)*(max_len+1));
+   nf->jindx = (int*) nf_alloc(sizeof(int)*(max_len+1));
+
+   nf->seq = (char*) nf_alloc(sizeof(char)*(max_len+1));
+   nf->S = (int*) nf_alloc(sizeof(int)*(max_len+1));
+   nf->C = (int*) nf_alloc(sizeof(int)*cells);
+   nf->FM = (int*) nf_alloc(sizeof(int)*cells);
+   nf->FMc = (int*) nf_alloc(sizeof(int)*cells);
+   nf->FM1c = (int*) nf_alloc(sizeof(int)*cells);
+   nf->F5 = (int*) nf_alloc(sizeof(int)*(max_len+1));
+
+   // the cells recomputed for one or two mutated positions (at most (n+4)^2/3)
+   nf->save_size = ((size_t)(max_len+4)*(max_len+4))/3 + 1;
+   nf->cand_seq = (char*) nf_alloc(sizeof(char)*(max_len+1));
+   nf->cand_S = (int*) nf_alloc(sizeof(int)*(max_len+1));
+   nf->saveC = (int*) nf_alloc(sizeof(int)*nf->save_size);
+   nf->saveFM = (int*) nf_alloc(sizeof(int)*nf->save_size);
+   nf->saveF5 = (int*) nf_alloc(sizeof(int)*(max_len+1));
+   nf->cand_first = (int*) nf_alloc(sizeof(int)*(max_len+1));
+   nf->cand_rows = 0;
+   nf->cand_pending = 0;
+
+   nf->diff = (int*) nf_alloc(sizeof(int)*(max_len+1));
+   nf->sector = (int*) nf_alloc(sizeof(int)*3*(2*max_len+2));
+   nf->work = (int*) nf_alloc(sizeof(int)*2*(max_len+1));
+   nf->seq[0] = nf->cand_seq[0] = '\0';
+   nf->evaluations = 0;
+   nf->cells = 0;
+   return nf;
+}
+
+
+void native_fold_free(NativeFold* nf)
+{
+   if (nf == NULL)
+      return;
+   free(nf->iindx); free(nf->jindx);
+   free(nf->seq); free(nf->S);
+   free(nf->C); free(nf->FM); free(nf->F5);
+   free(nf->FMc); free(nf->FM1c);
+   free(nf->cand_seq); free(nf->cand_S);
+   free(nf->saveC); free(nf->saveFM); free(nf->saveF5);
+   free(nf->cand_first);
+   free(nf->diff);
+   free(nf->sector);
+   free(nf->work);
+   free(nf);
+}
+
+
+static int result_energy(const NativeFold* nf, char backtrack)
+{
+   int n = nf->len;
+   // as in Vienna's fold(): the energy of the backtracked part is returned
+   if (backtrack == 'C')
+      return nf->C[nf->iindx[0]+n-1];
+   else if (backtrack == 'M')
+      return nf->FM[nf->iindx[0]+n-1];
+   return nf->F5[n-1];
+}
+
+// fills all cells of the matrices for the sequence S
+static void fill_all(NativeFold* nf, const int* S)
+{
+   int i;
+
+   for (i=0; i<nf->len; i++)
+      nf->cand_first[i] = i;
+   fill_rows(nf, S, nf->len, nf->cand_first);
+   fill_F5(nf, S, 0);
+}
+
+/*****************************************************************
+ the matrices hold the last candidate: the recomputed cells get
+ the values of the committed sequence back, C and FM from the
+ saved region, FMc from FM and FM1 (only kept in columns) from C
+ (O(1) per cell); a candidate whose region didn't fit into the
+ save buffers is undone by folding the committed sequence again
+*****************************************************************/
+
+static void native_rollback(NativeFold* nf)
+{
+   int i, j, off, cnt;
+   int n = nf->len;
+   size_t pos = 0;
+
+   if (nf->cand_pending == 0)
+      return;
+   if (nf->cand_pending == 2)
+   {
+      fill_all(nf, nf->S);
+      nf->cand_pending = 0;
+      return;
+   }
+   for (i=0; i<nf->cand_rows; i++)
+      if (nf->cand_first[i] >= 0)
+      {
+         off = nf->iindx[i]+nf->cand_first[i];
+         cnt = n-nf->cand_first[i];
+         memcpy(nf->C+off, nf->saveC+pos, sizeof(int)*cnt);
+         memcpy(nf->FM+off, nf->saveFM+pos, sizeof(int)*cnt);
+         pos += cnt;
+         for (j=Maximum(nf->cand_first[i], i+NF_TURN+1); j<n; j++)
+         {
+            nf->FMc[nf->jindx[j]+i] = nf->FM[nf->iindx[i]+j];
+            nf->FM1c[nf->jindx[j]+i] = FM1_cell(nf, nf->S, i, j, nf->C[nf->iindx[i]+j]);
+         }
+      }
+   memcpy(nf->F5, nf->saveF5, sizeof(int)*n);
+   nf->cand_pending = 0;
+}
+
+/*****************************************************************
+ folds seq from scratch, seq becomes the committed sequence
+*****************************************************************/
+
+int native_fold_init(NativeFold* nf, const char* seq, char* structure, char backtrack)
+{
+   int n = (int)strlen(seq);
+   int i, j, ij;
+
+   if (n > nf->max_len)
+   {
+      cerr << "Sequence too long for the native folding engine!\n";
+      exit(1);
+   }
+
+   nf->len = n;
+   for (i=0; i<n; i++)
+   {
+      nf->iindx[i] = i*n - (i*(i-1))/2 - i;
+      nf->jindx[i] = (i*(i+1))/2;
+   }
+   for (i=0; i<n; i++)
+      nf->S[i] = encode_base(seq[i]);
+   strcpy(nf->seq, seq);
+
+   for (i=0; i<n; i++)
+      for (j=i; (j<n) && (j-i<=NF_TURN); j++)
+      {
+         ij = nf->iindx[i]+j;
+         nf->C[ij] = nf->FM[ij] = NATIVE_INF;
+         nf->FMc[nf->jindx[j]+i] = nf->FM1c[nf->jindx[j]+i] = NATIVE_INF;
+      }
+   fill_all(nf, nf->S);
+
+   memcpy(nf->cand_S, nf->S, sizeof(int)*n);
+   strcpy(nf->cand_seq, seq);
+   nf->cand_pending = 0;
+   nf->cand_rows = 0;
+
+   nf->evaluations++;
+   nf->cells += ((size_t)n*(n+1))/2;
+
+   if (structure != NULL)
+      native_backtrack(nf, nf->S, backtrack, structure);
+   return result_energy(nf, backtrack);
+}
+
+/*****************************************************************
+ folds a candidate that differs from the committed sequence in
+ a few positions: only cells (i,j) with i-1 <= pos <= j+1 for a
+ mutated pos are recomputed (in place, their committed values
+ are saved before), all others are taken over. For a point
+ mutation at p these are about (p+2)*(n-p) cells, but the
+ longest ones: in the middle of the sequence an eval costs about
+ half of a complete fold, near the ends much less
+*****************************************************************/
+
+int native_fold_eval(NativeFold* nf, const char* seq, char* structure, char backtrack)
+{
+   int n = nf->len;
+   int i, d, m, rows, first, off, cnt;
+   size_t region;
+
+   if ((int)strlen(seq) != n)
+   {
+      fprintf(stderr, "%s\n%s\n", seq, nf->seq);
+      nrerror("native_fold_eval: candidate and current sequence have unequal length");
+   }
+
+   native_rollback(nf);
+
+   m = 0;
+   for (i=0; i<n; i++)
+   {
+      nf->cand_S[i] = encode_base(seq[i]);
+      if (nf->cand_S[i] != nf->S[i])
+         nf->diff[m++] = i;
+   }
+
+   if (m > 0)
+   {
+      rows = Minimum(n, nf->diff[m-1]+2);
+      region = 0;
+      for (i=d=0; i<rows; i++)
+      {
+         while ((d<m) && (nf->diff[d] < i-1))
+            d++;
+         nf->cand_first[i] = (d<m) ? Maximum(i, nf->diff[d]-1) : -1;
+         if (nf->cand_first[i] >= 0)
+            region += n-nf->cand_first[i];
+      }
+
+      if (region <= nf->save_size)
+      {
+         region = 0;
+         for (i=0; i<rows; i++)
+            if (nf->cand_first[i] >= 0)
+            {
+               off = nf->iindx[i]+nf->cand_first[i];
+               cnt = n-nf->cand_first[i];
+               memcpy(nf->saveC+region, nf->C+off, sizeof(int)*cnt);
+               memcpy(nf->saveFM+region, nf->FM+off, sizeof(int)*cnt);
+               region += cnt;
+            }
+         memcpy(nf->saveF5, nf->F5, sizeof(int)*n);
+         nf->cand_pending = 1;
+      }
+      else
+         nf->cand_pending = 2;   // many mutated positions, the rollback folds the committed sequence
+
+      fill_rows(nf, nf->cand_S, rows, nf->cand_first);
+      for (i=0; i<rows; i++)
+      {
+         first = Maximum(nf->cand_first[i], i+NF_TURN+1);
+         if ((nf->cand_first[i] >= 0) && (n > first))
+            nf->cells += n-first;
+      }
+      fill_F5(nf, nf->cand_S, Maximum(0, nf->diff[0]-1));
+      nf->cand_rows = rows;
+   }
+   strcpy(nf->cand_seq, seq);
+   nf->evaluations++;
+
+   if (structure != NULL)
+      native_backtrack(nf, nf->cand_S, backtrack, structure);
+   return result_energy(nf, backtrack);
+}
+
+/*****************************************************************
+ makes seq the committed sequence (it is evaluated first, if it
+ is not the last evaluated candidate), the matrices already hold
+ it
+*****************************************************************/
+
+void native_fold_accept(NativeFold* nf, const char* seq)
+{
+   if (strcmp(seq, nf->cand_seq) != 0)
+      native_fold_eval(nf, seq, NULL, 'F');
+
+   nf->cand_pending = 0;
+   memcpy(nf->S, nf->cand_S, sizeof(int)*nf->len);
+   strcpy(nf->seq, nf->cand_seq);
+}
+
+/**********************************************************************************
+*                  evaluation of a given structure, BP distance                   *
+**********************************************************************************/
+
+static void pair_table(const char* structure, int n, int* pt)
+{
+   int i, top = -1;   // the open brackets are linked through their entries in pt
+
+   for (i=0; i<n; i++)
+   {
+      pt[i] = -1;
+      if (structure[i] == '(')
+      {
+         pt[i] = top;
+         top = i;
+      }
+      else if (structure[i] == ')')
+      {
+         if (top < 0)
+            nrerror("unbalanced brackets in pair_table");
+         pt[i] = top;
+         top = pt[top];
+         pt[pt[i]] = i;
+      }
+   }
+   if (top != -1)
+      nrerror("unbalanced brackets in pair_table");
+}
+
+/*****************************************************************
+ energy of a structure (dcal/mol) in the model of the native
+ engine; a structure with a non-canonical BP gets NATIVE_INF
+*****************************************************************/
+
+int native_energy_of_struct(NativeFold* nf, const char* seq, const char* structure)
+{
+   int n = (int)strlen(seq);
+   int *S = nf->work, *pt = nf->work+nf->max_len+1;
+   int i, j, k, p, q, type, type2, stems, ml, energy = 0;
+
+   native_params();
+   for (i=0; i<n; i++)
+      S[i] = encode_base(seq[i]);
+   pair_table(structure, n, pt);
+
+   for (i=0; i<n; i++)
+      if ((pt[i] > i) && (pair_type[S[i]][S[pt[i]]] < 0))
+         return NATIVE_INF;
+
+   // exterior loop
+   for (i=0; i<n; i++)
+      if (pt[i] > i)
+      {
+         energy += E_stem(S, n, i, pt[i], pair_type[S[i]][S[pt[i]]]);
+         i = pt[i];
+      }
+
+   // loops closed by each BP
+   for (i=0; i<n; i++)
+   {
+      if (pt[i] <= i)
+         continue;
+      j = pt[i];
+      type = pair_type[S[i]][S[j]];
+      stems = 0;
+      p = q = -1;
+      ml = 0;
+      for (k=i+1; k<j; k++)
+         if (pt[k] > k)
+         {
+            if (stems == 0)
+            {
+               p = k;
+               q = pt[k];
+            }
+            stems++;
+            ml += P.ML_intern + E_stem(S, n, k, pt[k], pair_type[S[k]][S[pt[k]]]);
+            k = pt[k];
+         }
+
+      if (stems == 0)
+         energy += E_hairpin(S, i, j, type);
+      else if (stems == 1)
+      {
+         type2 = pair_type[S[p]][S[q]];
+         energy += E_interior(S, i, j, p, q, type, type2);
+      }
+      else
+         energy += E_ml_closing(S, i, j, type) + ml;
+   }
+
+   return energy;
+}
+
+
+int native_bp_distance(NativeFold* nf, const char* str1, const char* str2)
+{
+   int n = Minimum((int)strlen(str1), (int)strlen(str2));
+   int* pt1 = nf->work;
+   int* pt2 = nf->work+nf->max_len+1;
+   int i, dist = 0;
+
+   pair_table(str1, n, pt1);
+   pair_table(str2, n, pt2);
+
+   for (i=0; i<n; i++)
+      if (pt1[i] != pt2[i])
+      {
+         if (pt1[i] > i)
+            dist++;
+         if (pt2[i] > i)
+            dist++;
+      }
+   return dist;
+}
@@ -0,0 +1,68 @@
+#ifndef _NATIVE_FOLD__
+#define _NATIVE_FOLD__
+
+#include <stdlib.h>
+#include "basics.h"
+
+using namespace std;
+
+/**********************************************************************************
+*  Native MFE folding (Zuker recursions on the energy tables of energy.h, dangles *
+*  treated like Vienna's -d2). The matrices of the current sequence are kept, so  *
+*  that a candidate with a point or pair mutation only recomputes the cells whose *
+*  subsequence (plus one neighbor on each side) contains a mutated position, in   *
+*  place; the former values of these cells are saved for the rollback.            *
+*  The cells are filled in blocks along the anti-diagonals (wavefront), so that   *
+*  a single long sequence can be folded by several threads.                       *
+**********************************************************************************/
+
+const int NATIVE_INF = 10000000;  // energies are given in dcal/mol
+
+struct NativeFold
+{
+   int max_len;      // allocated sequence length
+   int threads;      // threads filling the matrices of one sequence (wavefront of blocks)
+   int len;          // length of the current sequence
+   int* iindx;       // row offsets of the triangular matrices: cell (i,j) = iindx[i]+j
+   int* jindx;       // column offsets of FMc, FM1c: cell (i,j) = jindx[j]+i
+
+   char* seq;        // committed sequence
+   int* S;
+   int* C;           // matrices of the last evaluated candidate (or of the committed sequence):
+   int* FM;          // C: (i,j) closes a loop, FM: part of a multiloop with at least one stem
+   int* F5;          // exterior loop of the prefix [0..j]
+   int* FMc;         // FM and FM1 (exactly one stem starting at i) column by column
+   int* FM1c;        // (min-plus kernels, min_plus.h)
+
+   char* cand_seq;   // last evaluated candidate
+   int* cand_S;
+   size_t save_size; // cells of saveC, saveFM
+   int* saveC;       // committed values of the cells the candidate recomputed, row by row
+   int* saveFM;
+   int* saveF5;
+   int* cand_first;  // first recomputed column of each row (-1 if the row is untouched)
+   int cand_rows;    // rows 0..cand_rows-1 may contain recomputed cells
+   int cand_pending; // 1: the matrices hold the candidate (rollback from the saved cells),
+                     // 2: the same, its cells didn't fit in the save buffers (rollback by folding)
+
+   int* diff;        // mutated positions of the candidate
+   int* sector;      // stack for the traceback
+   int* work;        // pair tables and encoded sequence of native_energy_of_struct, native_bp_distance
+
+   long evaluations; // number of evaluated candidates
+   long cells;       // number of recomputed cells
+};
+
+NativeFold* native_fold_alloc(int max_len, int threads);
+void native_fold_free(NativeFold* nf);
+
+int native_fold_init(NativeFold* nf, const char* seq, char* structure, char backtrack);
+int native_fold_eval(NativeFold* nf, const char* seq, char* structure, char backtrack);
+void native_fold_accept(NativeFold* nf, const char* seq);
+
+int native_energy_of_struct(NativeFold* nf, const char* seq, const char* structure);
+int native_bp_distance(NativeFold* nf, const char* str1, const char* str2);
+
+void native_fold_params_changed();
+
+#endif   // _NATIVE_FOLD_
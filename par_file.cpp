@@ -0,0 +1,515 @@
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include "par_file.h"
+
+// type of Vienna (1=CG, 2=GC, 3=GU, 4=UG, 5=AU, 6=UA) of the BPs 0=AU, 1=CG, 2=GC, 3=UA, 4=GU, 5=UG
+static const int vienna_type[6] = {5, 1, 2, 6, 3, 4};
+
+struct ParSection
+{
+   string name;
+   vector<string> values;   // all tokens of the section, comments removed
+};
+
+/*********************************************************
+ splits the file into its sections ("# name" up to the
+ next "#"), returns false if it is no parameter file
+*********************************************************/
+
+static bool Read_Sections(const char* file, vector<ParSection> & sections)
+{
+   ifstream in(file);
+   string line, token;
+   bool header = false, comment = false;
+   size_t p;
+
+   if (!in)
+   {
+      cerr << "Can't open the parameter file " << file << "!\n";
+      return false;
+   }
+   while (getline(in, line))
+   {
+      // remove the comments /* ... */ (may continue on the next lines)
+      string text;
+      for (p=0; p<line.size(); p++)
+      {
+         if (comment && line.compare(p, 2, "*/") == 0)
+         {
+            comment = false;
+            p++;
+         }
+         else if (!comment && line.compare(p, 2, "/*") == 0)
+         {
+            comment = true;
+            p++;
+         }
+         else if (!comment)
+            text += line[p];
+      }
+
+      istringstream words(text);
+      if (!(words >> token))
+         continue;
+      if (!header)
+      {
+         if (text.find("## RNAfold parameter file") != 0)
+         {
+            cerr << file << " is not a parameter file of the Vienna package (missing header line)!\n";
+            return false;
+         }
+         header = true;
+         continue;
+      }
+      if (token[0] == '#')
+      {
+         ParSection s;
+         if ((token.size() > 1) || !(words >> s.name))
+            s.name = token.substr(1);
+         if (s.name == "END")
+            break;
+         sections.push_back(s);
+         continue;
+      }
+      if (sections.empty())
+      {
+         cerr << "Parameter file " << file << ": values before the first section!\n";
+         return false;
+      }
+      do
+         sections.back().values.push_back(token);
+      while (words >> token);
+   }
+   if (!header)
+   {
+      cerr << file << " is not a parameter file of the Vienna package (missing header line)!\n";
+      return false;
+   }
+   return true;
+}
+
+/*********************************************************
+ value of a token: INF is MAX_ENERGY, DEF keeps value,
+ returns false if the token is no number
+*********************************************************/
+
+static bool Par_Value(const string& token, int& value)
+{
+   char* end;
+   long v;
+
+   if (token == "INF")
+      value = MAX_ENERGY;
+   else if (token != "DEF")
+   {
+      v = strtol(token.c_str(), &end, 10);
+      if (*end != '\0')
+         return false;
+      value = (int)v;
+   }
+   return true;
+}
+
+static bool Par_Value(const string& token, double& value)
+{
+   char* end;
+   double v;
+
+   if (token == "DEF")
+      return true;
+   v = strtod(token.c_str(), &end);
+   if (*end != '\0')
+      return false;
+   value = v;
+   return true;
+}
+
+/*********************************************************
+ number of types (6 = CG..UA, 7 with the non-standard
+ type, 8 with the type "no pair" in front) of a section
+ of n values: blocks of size block for each type (dims=1)
+ or each pair of types (dims=2), -1 if n doesn't fit
+*********************************************************/
+
+static int Par_Types(int n, int block, int dims)
+{
+   for (int t=6; t<=8; t++)
+      if (n == block*((dims == 1)? t : t*t))
+         return t;
+   return -1;
+}
+
+// row of the Vienna type of BP bp in a section with types rows
+#define TYPE_ROW(bp, types) (vienna_type[bp] - ((types == 8)? 0 : 1))
+
+/*********************************************************
+ the sections, each sets the entries of the tables for
+ the 6 BPs and the bases A, C, G, U (Vienna has N=0 in
+ front of them), the inner BP (p,q) of a loop closed by
+ (i,j) has the type of (q,p) in Vienna
+*********************************************************/
+
+static bool Set_Stack(int* table, const vector<string>& v)
+{
+   int types = Par_Types(v.size(), 1, 2);
+   int i, j, p, q;
+
+   if (types < 0)
+      return false;
+   for (int bp=0; bp<6; bp++)
+      for (int bp_in=0; bp_in<6; bp_in++)
+      {
+         BP2_2(bp, i, j);
+         BP2_2(bp_in, p, q);
+         if (!Par_Value(v[TYPE_ROW(bp,types)*types + TYPE_ROW(BP2int(q,p),types)], table[64*i+16*p+4*j+q]))
+            return false;
+      }
+   return true;
+}
+
+static bool Set_Mismatch(int* table, const vector<string>& v)
+{
+   int types = Par_Types(v.size(), 25, 1);
+   int i, j;
+
+   if (types < 0)
+      return false;
+   for (int bp=0; bp<6; bp++)
+   {
+      BP2_2(bp, i, j);
+      for (int x=0; x<4; x++)
+         for (int y=0; y<4; y++)
+            if (!Par_Value(v[TYPE_ROW(bp,types)*25 + 5*(x+1) + (y+1)], table[64*i+16*x+4*j+y]))
+               return false;
+   }
+   return true;
+}
+
+// dangle5 (offset 64 in single_base_stacking_energy) or dangle3 (offset 0)
+static bool Set_Dangle(int* table, const vector<string>& v)
+{
+   int types = Par_Types(v.size(), 5, 1);
+   int i, j;
+
+   if (types < 0)
+      return false;
+   for (int bp=0; bp<6; bp++)
+   {
+      BP2_2(bp, i, j);
+      for (int x=0; x<4; x++)
+         if (!Par_Value(v[TYPE_ROW(bp,types)*5 + (x+1)], table[16*j+4*i+x]))
+            return false;
+   }
+   return true;
+}
+
+static bool Set_Int11(int* table, const vector<string>& v)
+{
+   int types = Par_Types(v.size(), 25, 2);
+   int p, q, block;
+
+   if (types < 0)
+      return false;
+   for (int bp=0; bp<6; bp++)
+      for (int bp_in=0; bp_in<6; bp_in++)
+      {
+         BP2_2(bp_in, p, q);
+         block = 25*(TYPE_ROW(bp,types)*types + TYPE_ROW(BP2int(q,p),types));
+         for (int x=0; x<4; x++)
+            for (int y=0; y<4; y++)
+               if (!Par_Value(v[block + 5*(x+1) + (y+1)], table[96*bp+24*x+4*bp_in+y]))
+                  return false;
+      }
+   return true;
+}
+
+// x = i+1, y = j-1, z = j-2 (Vienna: int21[type][type_2][i+1][q+1][j-1])
+static bool Set_Int21(int* table, const vector<string>& v)
+{
+   int types = Par_Types(v.size(), 125, 2);
+   int p, q, block;
+
+   if (types < 0)
+      return false;
+   for (int bp=0; bp<6; bp++)
+      for (int bp_in=0; bp_in<6; bp_in++)
+      {
+         BP2_2(bp_in, p, q);
+         block = 125*(TYPE_ROW(bp,types)*types + TYPE_ROW(BP2int(q,p),types));
+         for (int x=0; x<4; x++)
+            for (int y=0; y<4; y++)
+               for (int z=0; z<4; z++)
+                  if (!Par_Value(v[block + 25*(x+1) + 5*(z+1) + (y+1)], table[384*bp+96*z+24*x+4*bp_in+y]))
+                     return false;
+      }
+   return true;
+}
+
+// x1 = i+1, y1 = i+2, x2 = j-1, y2 = j-2 (Vienna: int22[type][type_2][i+1][p-1][q+1][j-1]),
+// the blocks have 4^4 values (A..U) or 5^4 (N..U)
+static bool Set_Int22(int* table, const vector<string>& v)
+{
+   int nb = 4;
+   int types = Par_Types(v.size(), 256, 2);
+   int p, q, block;
+
+   if (types < 0)
+   {
+      nb = 5;
+      types = Par_Types(v.size(), 625, 2);
+      if (types < 0)
+         return false;
+   }
+   int n = nb-4;    // N in front of A
+   for (int bp=0; bp<6; bp++)
+      for (int bp_in=0; bp_in<6; bp_in++)
+      {
+         BP2_2(bp_in, p, q);
+         block = nb*nb*nb*nb*(TYPE_ROW(bp,types)*types + TYPE_ROW(BP2int(q,p),types));
+         for (int x1=0; x1<4; x1++)
+            for (int x2=0; x2<4; x2++)
+               for (int y1=0; y1<4; y1++)
+                  for (int y2=0; y2<4; y2++)
+                     if (!Par_Value(v[block + nb*nb*nb*(x1+n) + nb*nb*(y1+n) + nb*(y2+n) + (x2+n)],
+                                    table[1536*bp+256*bp_in+64*x1+16*x2+4*y1+y2]))
+                        return false;
+      }
+   return true;
+}
+
+// loop sizes 0..30, kind: 0 = interior, 1 = bulge, 2 = hairpin
+static bool Set_Loop(EnergyTables* E, const vector<string>& v, int kind)
+{
+   if (v.size() != 31)
+      return false;
+   for (int size=1; size<=30; size++)
+      if (!Par_Value(v[size], E->loop_destabilizing_energies[3*(size-1)+kind]))
+         return false;
+   return true;
+}
+
+// hexamers (closing BP included) with their boni, each followed by its enthalpy or not
+static bool Set_Tetraloops(EnergyTables* E, EnthalpyTables* H, const vector<string>& v)
+{
+   int b[6], index;
+   unsigned int k = 0;
+
+   memset(E->tetra_loop_table, 0, sizeof(E->tetra_loop_table));
+   memset(H->tetra_loop_table, 0, sizeof(H->tetra_loop_table));
+   while (k < v.size())
+   {
+      if ((v[k].size() != 6) || (k+1 == v.size()))
+         return false;
+      for (int l=0; l<6; l++)
+      {
+         const char* base = strchr("ACGU", toupper(v[k][l]));
+         if (base == NULL)
+            return false;
+         b[l] = (int)(base - "ACGU");
+      }
+      index = TETRA_INDEX(b[0],b[1],b[2],b[3],b[4],b[5]);
+      if (!Par_Value(v[k+1], E->tetra_loop_table[index]))
+         return false;
+      k += 2;
+      if ((k < v.size()) && !isalpha(v[k][0]))
+      {
+         if (!Par_Value(v[k], H->tetra_loop_table[index]))
+            return false;
+         k++;
+      }
+   }
+   return true;
+}
+
+// Vienna 1.x gives these values alone or each followed by its enthalpy (dH, NULL = not used)
+static bool Set_Values(const vector<string>& v, int n, int** values, int** dH)
+{
+   int step = 1;
+
+   if (v.size() == (unsigned int)(2*n))
+      step = 2;
+   else if (v.size() != (unsigned int)n)
+      return false;
+   for (int k=0; k<n; k++)
+   {
+      if ((values[k] != NULL) && !Par_Value(v[step*k], *values[k]))
+         return false;
+      if ((step == 2) && (dH != NULL) && (dH[k] != NULL) && !Par_Value(v[step*k+1], *dH[k]))
+         return false;
+   }
+   return true;
+}
+
+/*********************************************************
+ reads the free energies (37 C) into E and the enthalpies
+ into H, returns false if a section is not valid
+*********************************************************/
+
+static bool Read_Parameter_File(const char* file, EnergyTables* E, EnthalpyTables* H)
+{
+   vector<ParSection> sections;
+   bool ok = true;
+   unsigned int s;
+
+   if (!Read_Sections(file, sections))
+      return false;
+
+   for (s=0; ok && s<sections.size(); s++)
+   {
+      const string& name = sections[s].name;
+      const vector<string>& v = sections[s].values;
+
+      if (name == "stack_energies")
+         ok = Set_Stack(E->stacking_energies, v);
+      else if (name == "stack_enthalpies")
+         ok = Set_Stack(H->stacking_energies, v);
+      else if (name == "mismatch_hairpin")
+         ok = Set_Mismatch(E->mismatch_energies_hairpin, v);
+      else if (name == "mismatch_interior")
+         ok = Set_Mismatch(E->mismatch_energies_interior, v);
+      else if (name == "mismatch_enthalpies")    // the same for hairpins and interior loops
+         ok = Set_Mismatch(H->mismatch_energies_hairpin, v) && Set_Mismatch(H->mismatch_energies_interior, v);
+      else if (name == "dangle5")
+         ok = Set_Dangle(E->single_base_stacking_energy+64, v);
+      else if (name == "dangle3")
+         ok = Set_Dangle(E->single_base_stacking_energy, v);
+      else if (name == "dangle5_enthalpies")
+         ok = Set_Dangle(H->single_base_stacking_energy+64, v);
+      else if (name == "dangle3_enthalpies")
+         ok = Set_Dangle(H->single_base_stacking_energy, v);
+      else if (name == "int11_energies")
+         ok = Set_Int11(E->interior_loop_1_1_energy, v);
+      else if (name == "int11_enthalpies")
+         ok = Set_Int11(H->interior_loop_1_1_energy, v);
+      else if (name == "int21_energies")
+         ok = Set_Int21(E->interior_loop_1_2_energy, v);
+      else if (name == "int21_enthalpies")
+         ok = Set_Int21(H->interior_loop_1_2_energy, v);
+      else if (name == "int22_energies")
+         ok = Set_Int22(E->interior_loop_2_2_energy, v);
+      else if (name == "int22_enthalpies")
+         ok = Set_Int22(H->interior_loop_2_2_energy, v);
+      else if (name == "interior")
+         ok = Set_Loop(E, v, 0);
+      else if (name == "bulge")
+         ok = Set_Loop(E, v, 1);
+      else if (name == "hairpin")
+         ok = Set_Loop(E, v, 2);
+      else if (name == "Tetraloops")
+         ok = Set_Tetraloops(E, H, v);
+      else if (name == "ML_params")    // cu cc ci
+      {
+         int* values[3] = {&E->ML_base, &E->ML_closing, &E->ML_intern};
+         int* dH[3] = {&H->ML_base, &H->ML_closing, &H->ML_intern};
+         ok = Set_Values(v, 3, values, dH);
+      }
+      else if (name == "NINIO")        // m [m_dH] max
+      {
+         int* values[3] = {&E->ninio, NULL, &E->max_ninio};
+         int* values_no_dH[2] = {&E->ninio, &E->max_ninio};
+         int* dH[2] = {&H->ninio, NULL};
+         ok = (v.size() == 3)? Set_Values(v, 3, values, NULL) && Par_Value(v[1], H->ninio) : Set_Values(v, 2, values_no_dH, dH);
+      }
+      else if (name == "Misc")         // DuplexInit TerminalAU LXC
+      {
+         int step = (v.size() == 6)? 2 : 1;
+         ok = ((v.size() == 3) || (v.size() == 6)) && Par_Value(v[step], E->terminalAU) && Par_Value(v[2*step], E->lxc);
+         if (ok && (step == 2))
+            ok = Par_Value(v[3], H->terminalAU);
+      }
+      // other sections (triloops) are not used
+   }
+
+   if (!ok)
+      cerr << "Parameter file " << file << ": the values of the section " << sections[s-1].name << " are not valid!\n";
+   return ok;
+}
+
+/*********************************************************
+ the sections are read into copies of the tables, these
+ are changed if all of them are valid
+*********************************************************/
+
+static EnergyTables* Copy_Energies()
+{
+   EnergyTables* E = (EnergyTables*) aligned_alloc(64, sizeof(EnergyTables));
+   if (E == NULL)
+   {
+      cerr << "Not enough memory for the energy parameters!\n";
+      exit(1);
+   }
+   memcpy(E, &energy_tables, sizeof(EnergyTables));
+   return E;
+}
+
+static EnthalpyTables* Copy_Enthalpies()
+{
+   EnthalpyTables* H = (EnthalpyTables*) malloc(sizeof(EnthalpyTables));
+   if (H == NULL)
+   {
+      cerr << "Not enough memory for the energy parameters!\n";
+      exit(1);
+   }
+   memcpy(H, &energy_enthalpies, sizeof(EnthalpyTables));
+   return H;
+}
+
+/*********************************************************/
+
+int Load_Parameter_File(const char* file)
+{
+   // the sections missing in the file keep Vienna's enthalpies (its defaults, if no file was read before)
+   int have_H = energy_enthalpies_set || Load_Vienna_Enthalpies();
+   EnergyTables* E = Copy_Energies();
+   EnthalpyTables* H = Copy_Enthalpies();
+   int ok = Read_Parameter_File(file, E, H);
+
+   if (ok)
+   {
+      memcpy(&energy_tables, E, sizeof(EnergyTables));
+      if (have_H)
+         memcpy(&energy_enthalpies, H, sizeof(EnthalpyTables));
+   }
+   free(E);
+   free(H);
+   return ok;
+}
+
+/*********************************************************
+ the enthalpies of the parameters Vienna's fold uses,
+ written by write_parameter_file into a temporary file.
+ Only needed for its defaults: the enthalpies of a
+ parameter file are taken by Load_Parameter_File
+*********************************************************/
+
+int Load_Vienna_Enthalpies()
+{
+   char file[] = "/tmp/inforna_parXXXXXX";
+   int fd = mkstemp(file);
+   int ok;
+
+   if (fd < 0)
+   {
+      cerr << "Could not create a temporary file for the energy parameters of Vienna!\n";
+      return 0;
+   }
+   close(fd);
+
+   #pragma omp critical(vienna)
+   write_parameter_file(file);
+
+   EnergyTables* E = Copy_Energies();
+   EnthalpyTables* H = Copy_Enthalpies();
+   ok = Read_Parameter_File(file, E, H);
+   if (ok)
+   {
+      memcpy(&energy_enthalpies, H, sizeof(EnthalpyTables));
+      energy_enthalpies_set = 1;
+   }
+   free(E);
+   free(H);
+   unlink(file);
+   return ok;
+}
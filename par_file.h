@@ -0,0 +1,25 @@
+#ifndef _PAR_FILE__
+#define _PAR_FILE__
+
+#include <stdlib.h>
+#include "basics.h"
+
+using namespace std;
+
+/**********************************************************************************
+*  Reads an energy parameter file of the Vienna package (format of RNAfold -P in  *
+*  version 1.x) into the energy tables (energy.h). Sections that are not in the   *
+*  file keep their values, as well as single values given as DEF; INF forbids an  *
+*  entry (MAX_ENERGY). Triloops are not used. The enthalpies of the file go to    *
+*  energy_enthalpies, those it doesn't give keep Vienna's defaults                *
+*  (Load_Vienna_Enthalpies). Returns 0 (the tables are unchanged) if the file     *
+*  can't be read.                                                                 *
+**********************************************************************************/
+
+int Load_Parameter_File(const char* file);
+
+// enthalpies (energy_enthalpies) of the current parameters of Vienna, 0 if not available;
+// round trip through a temporary file, only used for its defaults
+int Load_Vienna_Enthalpies();
+
+#endif   // _PAR_FILE_
@@ -1,32 +1,84 @@
 
+#include <time.h>
 #include "search.h"
 
 #define MAXALPHA 20                    /* maximal length of alphabet */
 
-const int TIME_OUT_TIME = 3600;
-
-struct PosEnergy {
-   int pos;
-   double energy;
+struct Neighbor {            // neighbor of the current sequence that is folded during a parallel step
+   char* seq;
+   char* structure;
+   int pos;                  // index in mut_pos_list
+   int mismatches;           // change of the number of mismatches
+   int steps;                // number of steps after this neighbor
+   long filtered;            // number of candidates skipped by the energy filter before this neighbor
+   double ran;               // random number drawn for this neighbor
+   unsigned short rng[3];    // state of the random generator after this neighbor
+   int sym_list[MAXALPHA+1]; // order of the mutations at this position
+   int pair_list[2*MAXALPHA+1];
+   double cost;
+   double cost2;
 };
 
 
 int base = 4, npairs = 6;
 
-int*  BP_Precursors;   // precursor for each BP (ML,EL have more than one, this is not stored here, instead set to -1)
-int*   BP_Successors;  // successor for each BP
-double** Ediff;        // energy diffence that arises if a free base or a BP is changed
-double* av_Ediff;      // average energy difference if a free base or a BP is changed (average over all possible changes per pos.)
-double* max_Ediff;     // maximal energy difference if a free base or a BP is changed (max. over all possible changes per pos.)
 
-int time_out = 0;      // if the maximal running time is exceeded: set to 1
-long start_time;
-long zw_time;
+/*********************************************************
+ one instance of the folding backend per thread for the
+ local search
+*********************************************************/
+
+// the engines are kept for the next repeats (freed with the context), unless another backend is needed
+void alloc_Engines(DesignContext* ctx, int backend)
+{
+   if ((ctx->engines != NULL) && (ctx->engines[0]->backend == fold_backend(backend)))
+      return;
+   free_Engines(ctx);
+   ctx->engines = (FoldEngine**) malloc(sizeof(FoldEngine*)*ctx->num_threads);
+   for (int t=0; t<ctx->num_threads; t++)
+      ctx->engines[t] = fold_engine_alloc(backend, ctx->struct_len, ctx->fold_threads);
+}
 
 
-/*-------------------------------------------------------------------------*/
-int fold_type;
-double cost2;
+void free_Engines(DesignContext* ctx)
+{
+   if (ctx->engines == NULL)
+      return;
+   for (int t=0; t<ctx->num_threads; t++)
+      fold_engine_free(ctx->engines[t]);
+   free(ctx->engines);
+   ctx->engines = NULL;
+}
+
+
+/*********************************************************
+ folds seq completely with all engines of the local
+ search, seq becomes their current sequence (only the
+ incremental backends keep one)
+*********************************************************/
+
+void fold_engines_init(DesignContext* ctx, char* seq)
+{
+   if (!ctx->engines[0]->backend->incremental)
+      return;
+   #pragma omp parallel for num_threads(ctx->num_threads)
+   for (int t=0; t<ctx->num_threads; t++)
+      fold_engine_fold(ctx->engines[t], seq, NULL, ctx->backtrack_type);
+}
+
+
+/*********************************************************
+ makes seq the current sequence of all engines
+*********************************************************/
+
+void fold_engines_accept(DesignContext* ctx, char* seq)
+{
+   if (!ctx->engines[0]->backend->incremental)
+      return;
+   #pragma omp parallel for num_threads(ctx->num_threads)
+   for (int t=0; t<ctx->num_threads; t++)
+      fold_engine_accept(ctx->engines[t], seq);
+}
 
 
 
@@ -37,17 +89,17 @@ creates a vector in which for each pos. in brackets the
 pos. in BP_Order is stored, free bases are set to -1
 ***********************************************************/
 
-void Pos2BP_Pos()
+void Pos2BP_Pos(DesignContext* ctx)
 {
-   BP_Pos_Nr = (int*) malloc(sizeof(int)*struct_len);
+   ctx->BP_Pos_Nr = (int*) malloc(sizeof(int)*ctx->struct_len);
    int i, bp;
-   for (i=0; i<struct_len; i++)
-      BP_Pos_Nr[i] = -1;
+   for (i=0; i<ctx->struct_len; i++)
+      ctx->BP_Pos_Nr[i] = -1;
 
-   for (bp=0; bp<numBP; bp++)
+   for (bp=0; bp<ctx->numBP; bp++)
    {
-      BP_Pos_Nr[BP_Order[bp][0]] = bp;
-      BP_Pos_Nr[BP_Order[bp][1]] = bp;
+      ctx->BP_Pos_Nr[ctx->BP_Order[bp][0]] = bp;
+      ctx->BP_Pos_Nr[ctx->BP_Order[bp][1]] = bp;
    }
 }
 
@@ -62,59 +114,47 @@ void Pos2BP_Pos()
  all predecessors is stored addidionally (prec) )
 *********************************************************/
 
-int** GetPrecursors()
+int** GetPrecursors(DesignContext* ctx)
 {
    int i,j,vorg;
-   int* all_vorg;
    int** prec;
-   prec = (int**) malloc(sizeof(int*)*(numBP+1));
-   for (i=0; i<(numBP+1); i++)
+   prec = (int**) malloc(sizeof(int*)*(ctx->numBP+1));
+   for (i=0; i<(ctx->numBP+1); i++)
    {
       //allocate as much memory as many predecessors the BP has (at least one pos.)
-      vorg = Maximum(1, BP_Order[i][3]);
+      vorg = Maximum(1, ctx->BP_Order[i][3]);
       prec[i] = (int*) malloc(sizeof(int)*vorg);
       for (j=0; j<vorg; j++)
          prec[i][j] = -1;
    }
 
-   BP_Precursors = (int*) malloc(sizeof(int)*(numBP+1));
-   for (i=0; i<(numBP+1); i++)
-      BP_Precursors[i] = -1;
+   ctx->BP_Precursors = (int*) malloc(sizeof(int)*(ctx->numBP+1));
+   for (i=0; i<(ctx->numBP+1); i++)
+      ctx->BP_Precursors[i] = -1;
 
-   for (i=0; i<numBP; i++)
+   for (i=0; i<ctx->numBP; i++)
    {
       // one or no predecessor
-      if (BP_Order[i][3] == 0)
+      if (ctx->BP_Order[i][3] == 0)
       {
          if (i>0)
-            if ((BP_Order[i][0] < BP_Order[i-1][0]) && (BP_Order[i][1] > BP_Order[i-1][1]))
+            if ((ctx->BP_Order[i][0] < ctx->BP_Order[i-1][0]) && (ctx->BP_Order[i][1] > ctx->BP_Order[i-1][1]))
             {
                prec[i][0] = i-1;
-               BP_Precursors[i] = i-1;
+               ctx->BP_Precursors[i] = i-1;
             }
       }
       else
       {
-         all_vorg = FindStemEnds(i);
-         for (j=0; j<BP_Order[i][3]; j++)
-            prec[i][j] = all_vorg[j];
+         for (j=0; j<ctx->BP_Order[i][3]; j++)
+            prec[i][j] = LoopStemList(ctx->loops, i)[j];
          //for closingML -1 in BP_Precursors, also for dangling ends
       }
    }
 
    //external loop (dangling ends) extra
-   j=0;
-   i=0;
-   while (j < (int)strlen(brackets))
-   {
-      if (brackets[j] == '(')
-      {
-         prec[numBP][i++] = BP_Pos_Nr[j];
-         j = BP_Order[BP_Pos_Nr[j]][1] + 1;
-      }
-      else
-         j++;
-   }
+   for (j=0; j<ctx->BP_Order[ctx->numBP][3]; j++)
+      prec[ctx->numBP][j] = LoopStemList(ctx->loops, ctx->numBP)[j];
 
    return prec;
 }
@@ -125,18 +165,40 @@ int** GetPrecursors()
  finding all successsors of the BPs
 *********************************************************/
 
-void GetSuccessors(int** precs)
+void GetSuccessors(DesignContext* ctx, int** precs)
 {
    int i,j;
 
-   BP_Successors = (int*) malloc(sizeof(int)*(numBP+1));
-   for (i=0; i<(numBP+1); i++)
-      BP_Successors[i] = -1;
+   ctx->BP_Successors = (int*) malloc(sizeof(int)*(ctx->numBP+1));
+   for (i=0; i<(ctx->numBP+1); i++)
+      ctx->BP_Successors[i] = -1;
 
-   for (i=0; i<(numBP+1); i++)
-      for (j=0; j<Maximum(1,BP_Order[i][3]); j++)  //i has BP_Order[i][3] many predecessors
+   for (i=0; i<(ctx->numBP+1); i++)
+      for (j=0; j<Maximum(1,ctx->BP_Order[i][3]); j++)  //i has BP_Order[i][3] many predecessors
          if (precs[i][j] != -1)
-            BP_Successors[precs[i][j]] = i;
+            ctx->BP_Successors[precs[i][j]] = i;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*********************************************************
+ predecessors and successors of the BPs, they are found
+ only once per design (not in each repeat)
+*********************************************************/
+
+void GetPrecSucc(DesignContext* ctx)
+{
+   int i;
+   int** precs; //help for identifying the predecessors and successors
+
+   if (ctx->BP_Successors != NULL)
+      return;
+
+   precs = GetPrecursors(ctx);
+   GetSuccessors(ctx, precs);
+   for (i=0; i<ctx->numBP+1; i++)
+      free(precs[i]);
+   free(precs);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -144,51 +206,317 @@ void GetSuccessors(int** precs)
  allocates memory for Ediff
 ******************************************************/
 
-void alloc_Ediff()
+void alloc_Ediff(DesignContext* ctx)
 {
    int i, beleg;
-   Ediff = (double**) malloc(sizeof(double*)*struct_len);
-   av_Ediff = (double*) malloc(sizeof(double)*struct_len);
-   max_Ediff = (double*) malloc(sizeof(double)*struct_len);
 
-   for (i=0; i<struct_len; i++)
+   if (ctx->Ediff != NULL) // already allocated by a former repeat
+      return;
+
+   ctx->Ediff = (double**) malloc(sizeof(double*)*ctx->struct_len);
+   ctx->av_Ediff = (double*) malloc(sizeof(double)*ctx->struct_len);
+   ctx->max_Ediff = (double*) malloc(sizeof(double)*ctx->struct_len);
+
+   for (i=0; i<ctx->struct_len; i++)
    {
-      if (BP_Pos_Nr[i] == -1)
+      if (ctx->BP_Pos_Nr[i] == -1)
          beleg = 4;
-      else if (i == BP_Order[BP_Pos_Nr[i]][1]) //closing brackets
+      else if (i == ctx->BP_Order[ctx->BP_Pos_Nr[i]][1]) //closing brackets
          beleg = 6;
       else
          beleg = 0;
 
-      Ediff[i] = (double*) malloc(sizeof(double)*beleg);
+      ctx->Ediff[i] = (double*) malloc(sizeof(double)*beleg);
    }
+
+   ctx->Ediff_seq = (char*) malloc(sizeof(char)*(ctx->struct_len+1));
+   ctx->Ediff_valid = (bool*) malloc(sizeof(bool)*ctx->struct_len);
+   ctx->Ediff_mark = (bool*) calloc(ctx->struct_len, sizeof(bool));
+   ctx->Ediff_rank = (PosEnergy*) malloc(sizeof(PosEnergy)*ctx->struct_len);
+   make_Loops(ctx);
    //init_Ediff();
 }
 
+/*---------------------------------------------------------------------------*/
+/******************************************************
+ allocates the scratch arena: the work space of
+ inverse_fold and local_search
+******************************************************/
+
+void alloc_Scratch(DesignContext* ctx)
+{
+   int n = ctx->struct_len;
+   int cand = ctx->num_threads+npairs;   // neighbors of a parallel batch
+   size_t size;
+
+   if (ctx->scratch != NULL) // already allocated by a former repeat
+      return;
+
+   // inverse_fold: string, wstring, wstruct, pt, aux and its stack
+   size = 4*SCRATCH_BYTES(sizeof(char)*(n+1)) + SCRATCH_BYTES(sizeof(int)*(n+1)) + SCRATCH_BYTES(sizeof(short)*(n/2+1));
+   // local_search: 6 strings, 5 lists, int_seq, the marks of the deferred candidates, the neighbors and their strings
+   size += 6*SCRATCH_BYTES(sizeof(char)*(n+1)) + 6*SCRATCH_BYTES(sizeof(int)*n) + SCRATCH_BYTES(sizeof(char)*n*(base+npairs));
+   size += SCRATCH_BYTES(sizeof(Neighbor)*cand) + 2*cand*SCRATCH_BYTES(sizeof(char)*(n+1));
+
+   ctx->scratch = (char*) malloc(size);
+   if (ctx->scratch == NULL)
+   {
+      cerr << "Not enough memory for the scratch arena!\n";
+      exit(1);
+   }
+   ctx->scratch_size = size;
+   ctx->scratch_used = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+/***********************************************************
+ finds the loops of the structure: each free base belongs to
+ the loop of the innermost BP enclosing it, each BP to the
+ loop it closes and to the one enclosing it. Only the pos.
+ with a row in Ediff (free bases, closing brackets) are
+ stored as members, since only their rows are recomputed
+************************************************************/
+
+void make_Loops(DesignContext* ctx)
+{
+   int i, l, n = ctx->struct_len;
+   int *stack, *pt, *count, top = 0;
+
+   ctx->Enclosing = (int*) malloc(sizeof(int)*n);
+   ctx->Loop_Start = (int*) calloc(n+2, sizeof(int));
+   ctx->Loop_Members = (int*) malloc(sizeof(int)*2*n);
+   stack = (int*) malloc(sizeof(int)*(n+1));
+   pt = (int*) malloc(sizeof(int)*(n+1));
+   count = (int*) calloc(n+1, sizeof(int));
+   make_ptable(ctx->brackets, pt);
+
+   stack[0] = n;
+   for (i=0; i<n; i++)
+   {
+      if (ctx->brackets[i] == ')')
+         top--;
+      ctx->Enclosing[i] = stack[top];
+      if (ctx->brackets[i] == '(')
+         stack[++top] = i;
+   }
+
+   // number of members of each loop, afterwards the members
+   for (i=0; i<n; i++)
+      if (ctx->brackets[i] == '.')
+         ctx->Loop_Start[ctx->Enclosing[i]+1]++;
+      else if (ctx->brackets[i] == ')')
+      {
+         ctx->Loop_Start[ctx->Enclosing[i]+1]++;
+         ctx->Loop_Start[pt[i]+1]++;
+      }
+   for (l=0; l<=n; l++)
+      ctx->Loop_Start[l+1] += ctx->Loop_Start[l];
+
+   for (i=0; i<n; i++)
+      if (ctx->brackets[i] == '.')
+      {
+         l = ctx->Enclosing[i];
+         ctx->Loop_Members[ctx->Loop_Start[l]+count[l]++] = i;
+      }
+      else if (ctx->brackets[i] == ')')
+      {
+         l = ctx->Enclosing[i];
+         ctx->Loop_Members[ctx->Loop_Start[l]+count[l]++] = i;
+         l = pt[i];
+         ctx->Loop_Members[ctx->Loop_Start[l]+count[l]++] = i;
+      }
+
+   free(count);
+   free(pt);
+   free(stack);
+}
+
 /*---------------------------------------------------------------------------*/
 /***********************************************************
  initializing the Ediff array
 ************************************************************/
 
-void init_Ediff()
+void init_Ediff(DesignContext* ctx)
 {
    int i, j, beleg;
 
-   for (i=0; i<struct_len; i++)
+   for (i=0; i<ctx->struct_len; i++)
    {
-      av_Ediff[i] = MIN_INT;
-      max_Ediff[i] = MIN_INT;
+      ctx->av_Ediff[i] = MIN_INT;
+      ctx->max_Ediff[i] = MIN_INT;
 
-      if (BP_Pos_Nr[i] == -1)
+      if (ctx->BP_Pos_Nr[i] == -1)
          beleg = 4;
-      else if (i == BP_Order[BP_Pos_Nr[i]][1]) //closing bracket
+      else if (i == ctx->BP_Order[ctx->BP_Pos_Nr[i]][1]) //closing bracket
          beleg = 6;
       else
          beleg = 0;
 
       for (j=0; j<beleg; j++)
-         Ediff[i][j] = MIN_INT;
+         ctx->Ediff[i][j] = MIN_INT;
+      ctx->Ediff_valid[i] = false;
    }
+   ctx->Ediff_seq[0] = '\0';
+}
+
+/*---------------------------------------------------------------------------*/
+/***********************************************************
+ the rows of Ediff of all loops containing pos. are invalid
+************************************************************/
+
+void invalidate_Ediff(DesignContext* ctx, int pos)
+{
+   int loops[2], n_loops, l, k, m;
+
+   if (ctx->brackets[pos] == '.')
+   {
+      loops[0] = ctx->Enclosing[pos];
+      n_loops = 1;
+   }
+   else
+   {
+      if (ctx->brackets[pos] == ')')
+         pos = ctx->BP_Order[ctx->BP_Pos_Nr[pos]][0];
+      loops[0] = ctx->Enclosing[pos];
+      loops[1] = pos;
+      n_loops = 2;
+   }
+
+   for (l=0; l<n_loops; l++)
+      for (k=ctx->Loop_Start[loops[l]]; k<ctx->Loop_Start[loops[l]+1]; k++)
+      {
+         m = ctx->Loop_Members[k];
+         ctx->Ediff_valid[m] = false;
+      }
+}
+
+/*---------------------------------------------------------------------------*/
+/***********************************************************
+ Ediff has to refer to the whole sequence seq: the rows of
+ the loops where seq differs from Ediff_seq are invalid
+************************************************************/
+
+void update_Ediff(DesignContext* ctx, char* seq)
+{
+   int i;
+
+   if (ctx->Ediff_seq[0] == '\0') // no valid rows
+   {
+      strcpy(ctx->Ediff_seq, seq);
+      return;
+   }
+
+   for (i=0; i<ctx->struct_len; i++)
+      if (ctx->Ediff_seq[i] != seq[i])
+      {
+         invalidate_Ediff(ctx, i);
+         ctx->Ediff_seq[i] = seq[i];
+      }
+}
+
+/*---------------------------------------------------------------------------*/
+/***********************************************************
+ computes the row of pos. in Ediff and av_Ediff (int_seq is
+ Ediff_seq), if it is not valid
+************************************************************/
+
+void make_Ediff_Pos(DesignContext* ctx, int pos, int* int_seq)
+{
+   if (ctx->Ediff_valid[pos])
+      return;
+
+   EnergyDiff(ctx, pos, int_seq);
+   make_av_Ediff_Pos(ctx, pos);
+   ctx->Ediff_valid[pos] = true;
+}
+
+/*---------------------------------------------------------------------------*/
+/***********************************************************
+ order of the ranking: decreasing av_Ediff, ties by
+ increasing pos. (1, if a comes before b)
+************************************************************/
+
+int rank_Before(const PosEnergy* a, const PosEnergy* b)
+{
+   return (a->energy > b->energy) || ((a->energy == b->energy) && (a->pos < b->pos));
+}
+
+/*---------------------------------------------------------------------------*/
+/***********************************************************
+ sorts pe in the order of the ranking (heap sort: in place,
+ the order doesn't depend on the sort, since no two pos.
+ are equal)
+************************************************************/
+
+void sort_Ranking(PosEnergy* pe, int n)
+{
+   int i, j, k, end;
+   PosEnergy help;
+
+   // heap with the last pos. of the ranking at the root
+   for (end=n, k=n/2-1; end>1; )
+   {
+      if (k >= 0)
+         i = k--;
+      else
+      {
+         help = pe[0];
+         pe[0] = pe[--end];
+         pe[end] = help;
+         i = 0;
+      }
+      while ((j = 2*i+1) < end)
+      {
+         if ((j+1 < end) && rank_Before(&pe[j], &pe[j+1]))
+            j++;
+         if (!rank_Before(&pe[i], &pe[j]))
+            break;
+         help = pe[i];
+         pe[i] = pe[j];
+         pe[j] = help;
+         i = j;
+      }
+   }
+}
+
+/*---------------------------------------------------------------------------*/
+/***********************************************************
+ writes the candidate positions cand (shifted by offset)
+ with av_Ediff > MIN_INT to list, ordered by decreasing
+ av_Ediff, returns their number
+************************************************************/
+
+int rank_Positions(DesignContext* ctx, int* cand, int n_cand, int offset, int* list, int* int_seq)
+{
+   int i, pos, n = 0;
+   PosEnergy* rank = ctx->Ediff_rank;
+
+   // each candidate once
+   for (i=0; i<n_cand; i++)
+   {
+      pos = cand[i]+offset;
+      if (ctx->Ediff_mark[pos])
+         continue;
+      ctx->Ediff_mark[pos] = true;
+      make_Ediff_Pos(ctx, pos, int_seq);
+      if (ctx->av_Ediff[pos] > MIN_INT)
+      {
+         rank[n].pos = pos;
+         rank[n].energy = ctx->av_Ediff[pos];
+         n++;
+      }
+   }
+
+   sort_Ranking(rank, n);
+   for (i=0; i<n; i++)
+   {
+      list[i] = rank[i].pos - offset;
+      ctx->Ediff_mark[rank[i].pos] = false;
+   }
+   for (i=0; i<n_cand; i++)
+      ctx->Ediff_mark[cand[i]+offset] = false;
+
+   return n;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -196,23 +524,23 @@ void init_Ediff()
 printing the Ediff array
 ************************************************************/
 
-void print_Ediff()
+void print_Ediff(DesignContext* ctx)
 {
    int i, j, beleg;
 
    printf("Ediff: \n");
-   for (i=0; i<struct_len; i++)
+   for (i=0; i<ctx->struct_len; i++)
    {
-      if (BP_Pos_Nr[i] == -1)
+      if (ctx->BP_Pos_Nr[i] == -1)
          beleg = 4;
-      else if (i == BP_Order[BP_Pos_Nr[i]][1]) //closing bracket
+      else if (i == ctx->BP_Order[ctx->BP_Pos_Nr[i]][1]) //closing bracket
          beleg = 6;
       else
          beleg = 0;
 
       printf("%d ",i);
       for (j=0; j<beleg; j++)
-         printf("%f ",Ediff[i][j]);
+         printf("%f ",ctx->Ediff[i][j]);
       printf("\n");
    }
 }
@@ -221,14 +549,14 @@ void print_Ediff()
 printing the av_Ediff array
 ************************************************************/
 
-void print_av_Ediff()
+void print_av_Ediff(DesignContext* ctx)
 {
    int i;
    printf("av_Ediff: \n");
-   for (i=0; i<struct_len; i++)
+   for (i=0; i<ctx->struct_len; i++)
    {
       printf("%d ",i);
-      printf("%f \n",av_Ediff[i]);
+      printf("%f \n",ctx->av_Ediff[i]);
    }
 }
 /*---------------------------------------------------------------------------*/
@@ -236,44 +564,46 @@ void print_av_Ediff()
 calculating the av_Ediff array
 ************************************************************/
 
-void make_av_Ediff()
+void make_av_Ediff(DesignContext* ctx)
 {
-   int i, j, beleg;
-   double av;
+   for (int i=0; i<ctx->struct_len; i++)
+      make_av_Ediff_Pos(ctx, i);
+}
 
-   for (i=0; i<struct_len; i++)
-   {
-      av = 0.0;
-      if (BP_Pos_Nr[i] == -1)
-         beleg = 4;
-      else if (i == BP_Order[BP_Pos_Nr[i]][1]) //closing bracket
-         beleg = 6;
-      else
-         beleg = 0;
+void make_av_Ediff_Pos(DesignContext* ctx, int i)
+{
+   int j, beleg;
+   double av = 0.0;
 
-      for (j=0; j<beleg; j++)
-         //av = Sum_MinInt(av, Ediff[i][j]);
-	 av += Ediff[i][j];
+   if (ctx->BP_Pos_Nr[i] == -1)
+      beleg = 4;
+   else if (i == ctx->BP_Order[ctx->BP_Pos_Nr[i]][1]) //closing bracket
+      beleg = 6;
+   else
+      beleg = 0;
 
-      if ((beleg != 0) && ((int)av != MIN_INT))
-         av_Ediff[i] = av / beleg;
-      else
-         av_Ediff[i] = MIN_INT;
-   }
+   for (j=0; j<beleg; j++)
+      //av = Sum_MinInt(av, Ediff[i][j]);
+      av += ctx->Ediff[i][j];
+
+   if ((beleg != 0) && ((int)av != MIN_INT))
+      ctx->av_Ediff[i] = av / beleg;
+   else
+      ctx->av_Ediff[i] = MIN_INT;
 }
 /*---------------------------------------------------------------------------*/
 /***********************************************************
 printing the max_Ediff array
 ************************************************************/
 
-void print_max_Ediff()
+void print_max_Ediff(DesignContext* ctx)
 {
    int i;
    printf("max_Ediff: \n");
-   for (i=0; i<struct_len; i++)
+   for (i=0; i<ctx->struct_len; i++)
    {
       printf("%d ",i);
-      printf("%f \n",max_Ediff[i]);
+      printf("%f \n",ctx->max_Ediff[i]);
    }
 }
 /*---------------------------------------------------------------------------*/
@@ -281,78 +611,28 @@ void print_max_Ediff()
 calculation the max_Ediff array
 ************************************************************/
 
-void make_max_Ediff()
+void make_max_Ediff(DesignContext* ctx)
 {
    int i, beleg;
-   double* max;
+   double max[2];
 
-   for (i=0; i<struct_len; i++)
+   for (i=0; i<ctx->struct_len; i++)
    {
-      if (BP_Pos_Nr[i] == -1)
+      if (ctx->BP_Pos_Nr[i] == -1)
          beleg = 4;
-      else if (i == BP_Order[BP_Pos_Nr[i]][1]) //closing bracket
+      else if (i == ctx->BP_Order[ctx->BP_Pos_Nr[i]][1]) //closing bracket
          beleg = 6;
       else
          beleg = 0;
 
       if (beleg != 0)
       {
-         max = MaxiVec(Ediff[i], beleg);
-         max_Ediff[i] = max[1];
+         MaxiVec(ctx->Ediff[i], beleg, max);
+         ctx->max_Ediff[i] = max[1];
       }
       else
-         max_Ediff[i] = MIN_INT;
-   }
-}
-
-/*---------------------------------------------------------------------------*/
-
-
-/***********************************************************
- Positions are sorted according to the amount of Ediff
-************************************************************/
-
-int compare_Pos(const void *_a, const void *_b)
-{
-   //cast pointer types, since the compare function of qsort needs a function with void-pointers
-   const struct PosEnergy* a = (const struct PosEnergy*) _a;
-   const struct PosEnergy* b = (const struct PosEnergy*) _b;
-
-   if (a->energy > b->energy)
-      return -1;
-   else if (a->energy < b->energy)
-      return 1;
-   else
-      return 0;
-}
-
-
-/*---------------------------------------------------------------------------*/
-/***********************************************************
- fixes mut_pos_list (order of mutation)
-************************************************************/
-
-int* make_mut_pos_list()
-{
-   int* list;
-   list = (int*) malloc(sizeof(int)*struct_len);
-
-   //make an array of PosEnergy-structs from max_Ediff
-   struct PosEnergy* av_E;
-   av_E = (struct PosEnergy*) malloc(sizeof(struct PosEnergy)*struct_len);
-
-   for (int i=0; i<struct_len; i++)
-   {
-      av_E[i].pos = i;
-      av_E[i].energy = av_Ediff[i];
+         ctx->max_Ediff[i] = MIN_INT;
    }
-
-   qsort((void*)av_E, struct_len, sizeof(struct PosEnergy), compare_Pos);
-
-   for (int i=0; i<struct_len; i++)
-      list[i] = av_E[i].pos;
-
-   return list;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -360,15 +640,15 @@ int* make_mut_pos_list()
  determines the kind of the structural component and its energy
 ***********************************************************************/
 
-double getPartEnergy(int bp_pos, int bp_pos_before, int* int_seq)
+int getPartEnergy(DesignContext* ctx, int bp_pos, int bp_pos_before, int* int_seq)
 {
    int k, pos_i, pos_j, pos_before_i, pos_before_j, assign_i, assign_j, assign_before_i, assign_before_j, assign_bp, assign_bp_before;
-   double energy_help = 0.0;
+   int energy_help = 0;
 
-   pos_i = BP_Order[bp_pos][0];
-   pos_j = BP_Order[bp_pos][1];
-   pos_before_i = BP_Order[bp_pos_before][0];
-   pos_before_j = BP_Order[bp_pos_before][1];
+   pos_i = ctx->BP_Order[bp_pos][0];
+   pos_j = ctx->BP_Order[bp_pos][1];
+   pos_before_i = ctx->BP_Order[bp_pos_before][0];
+   pos_before_j = ctx->BP_Order[bp_pos_before][1];
 
    assign_i = int_seq[pos_i];
    assign_j = int_seq[pos_j];
@@ -383,8 +663,8 @@ double getPartEnergy(int bp_pos, int bp_pos_before, int* int_seq)
       assign_bp = BP2int(assign_i, assign_j);
       assign_bp_before = BP2int(assign_before_i,assign_before_j);
       //base pair penalty only for the second closing base pair
-      //return Sum_MaxDouble4(StackingEnergy(assign_i, assign_j, assign_bp_before), PairPenalty(pos_i,pos_j,assign_i,assign_j), PairPenalty(pos_before_i, pos_before_j, assign_before_i, assign_before_j), Zero_or_StemEndAU(bp_pos, assign_bp));
-      return Sum_MaxDouble3(StackingEnergy(assign_i, assign_j, assign_bp_before), PairPenalty(pos_i,pos_j,assign_i,assign_j), Zero_or_StemEndAU(bp_pos, assign_bp));
+      //return Sum_MaxEnergy4(StackingEnergy(assign_i, assign_j, assign_bp_before), PairPenalty(pos_i,pos_j,assign_i,assign_j), PairPenalty(pos_before_i, pos_before_j, assign_before_i, assign_before_j), Zero_or_StemEndAU(bp_pos, assign_bp));
+      return Sum_MaxEnergy3(StackingEnergy(assign_i, assign_j, assign_bp_before), PairPenalty(ctx, pos_i,pos_j,assign_i,assign_j), Zero_or_StemEndAU(ctx, bp_pos, assign_bp));
    }
 
    //***********************
@@ -395,14 +675,14 @@ double getPartEnergy(int bp_pos, int bp_pos_before, int* int_seq)
       assign_bp = BP2int(assign_i, assign_j);
       assign_bp_before = BP2int(assign_before_i,assign_before_j);
       //Penalties for all pos. in the bulge
-      energy_help = 0.0;
+      energy_help = 0;
       for (k=1; k<pos_j-pos_before_j; k++)
-         energy_help = Sum_MaxDouble(energy_help, BasePenalty(pos_before_j+k, int_seq[pos_before_j+k])); 
+         energy_help = Sum_MaxEnergy(energy_help, BasePenalty(ctx, pos_before_j+k, int_seq[pos_before_j+k])); 
       //base pair penalties
-      //energy_help = Sum_MaxDouble3(energy_help, PairPenalty(pos_i,pos_j,assign_i,assign_j), PairPenalty(pos_before_i, pos_before_j, assign_before_i, assign_before_j));
+      //energy_help = Sum_MaxEnergy3(energy_help, PairPenalty(pos_i,pos_j,assign_i,assign_j), PairPenalty(pos_before_i, pos_before_j, assign_before_i, assign_before_j));
       //base pair penalty only for the second closing base pair
-      energy_help = Sum_MaxDouble(energy_help, PairPenalty(pos_i,pos_j,assign_i,assign_j));
-      return Sum_MaxDouble3(energy_help,BulgeEnergy(pos_j-pos_before_j,assign_i, assign_j, assign_bp_before), Zero_or_StemEndAU(bp_pos, assign_bp));
+      energy_help = Sum_MaxEnergy(energy_help, PairPenalty(ctx, pos_i,pos_j,assign_i,assign_j));
+      return Sum_MaxEnergy3(energy_help,BulgeEnergy(pos_j-pos_before_j,assign_i, assign_j, assign_bp_before), Zero_or_StemEndAU(ctx, bp_pos, assign_bp));
    }
 
    //***********************
@@ -413,27 +693,27 @@ double getPartEnergy(int bp_pos, int bp_pos_before, int* int_seq)
       assign_bp = BP2int(assign_i, assign_j);
       assign_bp_before = BP2int(assign_before_i,assign_before_j);
       //Penalties for all pos. in the bulge
-      energy_help = 0.0;
+      energy_help = 0;
       for (k=1; k<pos_before_i-pos_i; k++)
-         energy_help = Sum_MaxDouble(energy_help, BasePenalty(pos_i+k, int_seq[pos_i+k])); 
+         energy_help = Sum_MaxEnergy(energy_help, BasePenalty(ctx, pos_i+k, int_seq[pos_i+k])); 
       //base pair penalties
-      //energy_help = Sum_MaxDouble3(energy_help, PairPenalty(pos_i,pos_j,assign_i,assign_j), PairPenalty(pos_before_i, pos_before_j, assign_before_i, assign_before_j));
+      //energy_help = Sum_MaxEnergy3(energy_help, PairPenalty(pos_i,pos_j,assign_i,assign_j), PairPenalty(pos_before_i, pos_before_j, assign_before_i, assign_before_j));
       //base pair penalty only for the second closing base pair
-      energy_help = Sum_MaxDouble(energy_help, PairPenalty(pos_i,pos_j,assign_i,assign_j));
-      return Sum_MaxDouble3(energy_help, BulgeEnergy(pos_before_i-pos_i,assign_i,assign_j,assign_bp_before),  Zero_or_StemEndAU(bp_pos, assign_bp));
+      energy_help = Sum_MaxEnergy(energy_help, PairPenalty(ctx, pos_i,pos_j,assign_i,assign_j));
+      return Sum_MaxEnergy3(energy_help, BulgeEnergy(pos_before_i-pos_i,assign_i,assign_j,assign_bp_before),  Zero_or_StemEndAU(ctx, bp_pos, assign_bp));
    }
 
    //***********************
    //ML or dangl end.
    //***********************
-   else if (BP_Order[bp_pos][3] != 0)
+   else if (ctx->BP_Order[bp_pos][3] != 0)
    {
       //ML
-      if (bp_pos != numBP)
-         return MLEnergy(bp_pos,int_seq);
+      if (bp_pos != ctx->numBP)
+         return MLEnergy(ctx, bp_pos,int_seq);
       //dangling end
       else
-         return externEnergy(int_seq);
+         return externEnergy(ctx, int_seq);
    }
 
    //***********************
@@ -444,16 +724,16 @@ double getPartEnergy(int bp_pos, int bp_pos_before, int* int_seq)
       assign_bp = BP2int(assign_i, assign_j);
       assign_bp_before = BP2int(assign_before_i,assign_before_j);
       //test all bases in the loop, add penalties
-      energy_help = 0.0;
+      energy_help = 0;
       for (k=1; k<pos_before_i-pos_i; k++)
-         energy_help = Sum_MaxDouble(energy_help, BasePenalty(pos_i+k, int_seq[pos_i+k]));
+         energy_help = Sum_MaxEnergy(energy_help, BasePenalty(ctx, pos_i+k, int_seq[pos_i+k]));
       for (k=1; k<pos_j-pos_before_j; k++)
-         energy_help = Sum_MaxDouble(energy_help, BasePenalty(pos_before_j+k, int_seq[pos_before_j+k])); 
+         energy_help = Sum_MaxEnergy(energy_help, BasePenalty(ctx, pos_before_j+k, int_seq[pos_before_j+k])); 
       //base pair penalties
-      //energy_help = Sum_MaxDouble3(energy_help, PairPenalty(pos_i,pos_j,assign_i,assign_j), PairPenalty(pos_before_i, pos_before_j, assign_before_i, assign_before_j));
+      //energy_help = Sum_MaxEnergy3(energy_help, PairPenalty(pos_i,pos_j,assign_i,assign_j), PairPenalty(pos_before_i, pos_before_j, assign_before_i, assign_before_j));
       //base pair penalty only for the second closing base pair
-      energy_help = Sum_MaxDouble(energy_help, PairPenalty(pos_i,pos_j,assign_i,assign_j));
-      return Sum_MaxDouble3(energy_help, InteriorLoopEnergy(pos_before_i-pos_i-1,pos_j-pos_before_j-1,int_seq,pos_i,pos_j), Zero_or_StemEndAU(bp_pos, assign_bp));
+      energy_help = Sum_MaxEnergy(energy_help, PairPenalty(ctx, pos_i,pos_j,assign_i,assign_j));
+      return Sum_MaxEnergy3(energy_help, InteriorLoopEnergy(pos_before_i-pos_i-1,pos_j-pos_before_j-1,int_seq,pos_i,pos_j), Zero_or_StemEndAU(ctx, bp_pos, assign_bp));
    }
 }
 
@@ -465,9 +745,9 @@ double getPartEnergy(int bp_pos, int bp_pos_before, int* int_seq)
  (even if in mfe-mode only parts of the structures are analyzed,
  the energy difference refers to the whole structure)
 *************************************************************/
-double get_BP_Energy(int pos_i, int* int_seq)
+int get_BP_Energy(DesignContext* ctx, int pos_i, int* int_seq)
 {
-   double energy = 0.0;
+   int energy = 0;
 
    int pos_BP;     //pos_i is the absolute pos. in the structure, pos_BP is the pos. of the BP in BP_Order (in pos_i is a BP)
    int pos_j;      //binding pos. of pos_i, if there is a BP in pos_i
@@ -477,24 +757,24 @@ double get_BP_Energy(int pos_i, int* int_seq)
    int pos_BP_vor, pos_BP_nach;                      // pos. of the previous and the following BP in BP_Order
    int bp_i_vor, bp_j_vor, bp_i_nach, bp_j_nach;     // assignments of the previous and the following BP
 
-   pos_j = BP_Order[BP_Pos_Nr[pos_i]][1];
+   pos_j = ctx->BP_Order[ctx->BP_Pos_Nr[pos_i]][1];
    bp_i = int_seq[pos_i];
    bp_j = int_seq[pos_j];
 
-   pos_BP = BP_Pos_Nr[pos_i];
-   pos_BP_vor = BP_Precursors[pos_BP];
+   pos_BP = ctx->BP_Pos_Nr[pos_i];
+   pos_BP_vor = ctx->BP_Precursors[pos_BP];
    if (pos_BP_vor != -1)
    {
-      pos_i_vor = BP_Order[pos_BP_vor][0];
-      pos_j_vor = BP_Order[pos_BP_vor][1];
+      pos_i_vor = ctx->BP_Order[pos_BP_vor][0];
+      pos_j_vor = ctx->BP_Order[pos_BP_vor][1];
       bp_i_vor = int_seq[pos_i_vor];
       bp_j_vor = int_seq[pos_j_vor];
    }
-   pos_BP_nach = BP_Successors[pos_BP];
+   pos_BP_nach = ctx->BP_Successors[pos_BP];
    if (pos_BP_nach != -1)
    {
-      pos_i_nach = BP_Order[pos_BP_nach][0];
-      pos_j_nach = BP_Order[pos_BP_nach][1];
+      pos_i_nach = ctx->BP_Order[pos_BP_nach][0];
+      pos_j_nach = ctx->BP_Order[pos_BP_nach][1];
       bp_i_nach = int_seq[pos_i_nach];
       bp_j_nach = int_seq[pos_j_nach];
    }
@@ -507,15 +787,15 @@ double get_BP_Energy(int pos_i, int* int_seq)
    {
       //CLOSING HL:
       //---------------
-      if (BP_Order[pos_BP][3] == 0) // no ML
+      if (ctx->BP_Order[pos_BP][3] == 0) // no ML
       {
-         size = BP_Order[pos_BP][1] - BP_Order[pos_BP][0] - 1;
-         energy = Sum_MaxDouble(energy, HairpinLoopEnergy(size,pos_i,int_seq));
+         size = ctx->BP_Order[pos_BP][1] - ctx->BP_Order[pos_BP][0] - 1;
+         energy = Sum_MaxEnergy(energy, HairpinLoopEnergy(ctx, size,pos_i,int_seq));
 
          //if pos_BP_nach == -1, pos_BP would already be the imaginary last BP ("closing"
          //the external loop) and no further structural element follows
          if (pos_BP_nach != -1)
-            energy = Sum_MaxDouble(energy, getPartEnergy(pos_BP_nach, pos_BP, int_seq));
+            energy = Sum_MaxEnergy(energy, getPartEnergy(ctx, pos_BP_nach, pos_BP, int_seq));
       }
 
       //CLOSING ML or dangling end:
@@ -524,12 +804,12 @@ double get_BP_Energy(int pos_i, int* int_seq)
       {
          if (pos_BP_nach != -1)
          {
-            energy = Sum_MaxDouble(energy, MLEnergy(pos_BP,int_seq));
-            energy = Sum_MaxDouble(energy, getPartEnergy(pos_BP_nach, pos_BP, int_seq));
+            energy = Sum_MaxEnergy(energy, MLEnergy(ctx, pos_BP,int_seq));
+            energy = Sum_MaxEnergy(energy, getPartEnergy(ctx, pos_BP_nach, pos_BP, int_seq));
          }
          else  //dangling has no predecessor and no successor
          {
-            energy = Sum_MaxDouble(energy, externEnergy(int_seq));
+            energy = Sum_MaxEnergy(energy, externEnergy(ctx, int_seq));
          }
       }
    }
@@ -538,9 +818,9 @@ double get_BP_Energy(int pos_i, int* int_seq)
    else
    {
       //has predecessor
-      energy = Sum_MaxDouble(energy, getPartEnergy(pos_BP, pos_BP_vor, int_seq));
+      energy = Sum_MaxEnergy(energy, getPartEnergy(ctx, pos_BP, pos_BP_vor, int_seq));
       //all that have a predecessor, have a successor as well
-      energy = Sum_MaxDouble(energy, getPartEnergy(pos_BP_nach, pos_BP, int_seq));
+      energy = Sum_MaxEnergy(energy, getPartEnergy(ctx, pos_BP_nach, pos_BP, int_seq));
    }
 
    return energy;
@@ -552,7 +832,7 @@ double get_BP_Energy(int pos_i, int* int_seq)
  (even if in mfe-mode only parts of the structures are analyzed,
  the energy difference refers to the whole structure)
 *************************************************************/
-double get_BasePart_Energy(int pos_i, int* int_seq)
+int get_BasePart_Energy(DesignContext* ctx, int pos_i, int* int_seq)
 {
    int bp_i;                    // assignment of the base
    int size;                    // loop size
@@ -568,67 +848,67 @@ double get_BasePart_Energy(int pos_i, int* int_seq)
    //finding the group of free bases
    //+++++++++++++++++++++++++++++++++++++++++++
    i = pos_i;
-   while ((0<=i) && (brackets[i] == '.'))
+   while ((0<=i) && (ctx->brackets[i] == '.'))
       i--;
    group_i = i+1;
 
    j = pos_i;
-   while ((j<struct_len) && (brackets[j] == '.'))
+   while ((j<ctx->struct_len) && (ctx->brackets[j] == '.'))
       j++;
    group_j = j-1;
 
    // if the free base is not adjacent to a stem, it has no influence on the energy
    // thus, return 0.0 + penalty
    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-   if ((pos_i == 0) && (brackets[pos_i+1] == '.'))
-      return Sum_MaxDouble(0.0,BasePenalty(pos_i, int_seq[pos_i]));
-   else if ((pos_i == struct_len-1) && (brackets[pos_i-1] == '.'))
-      return Sum_MaxDouble(0.0,BasePenalty(pos_i, int_seq[pos_i]));
-   else if ((brackets[pos_i-1] == '.') && (brackets[pos_i+1] == '.'))
-      return Sum_MaxDouble(0.0,BasePenalty(pos_i, int_seq[pos_i]));
+   if ((pos_i == 0) && (ctx->brackets[pos_i+1] == '.'))
+      return Sum_MaxEnergy(0,BasePenalty(ctx, pos_i, int_seq[pos_i]));
+   else if ((pos_i == ctx->struct_len-1) && (ctx->brackets[pos_i-1] == '.'))
+      return Sum_MaxEnergy(0,BasePenalty(ctx, pos_i, int_seq[pos_i]));
+   else if ((ctx->brackets[pos_i-1] == '.') && (ctx->brackets[pos_i+1] == '.'))
+      return Sum_MaxEnergy(0,BasePenalty(ctx, pos_i, int_seq[pos_i]));
 
    else
    {
       // EL (- G i) or (i G -)
-      if ((group_i == 0) || (group_j == struct_len-1))
+      if ((group_i == 0) || (group_j == ctx->struct_len-1))
       {
-         return externEnergy(int_seq);
+         return externEnergy(ctx, int_seq);
       }
 
-      pos_BP_vor = BP_Pos_Nr[group_i-1];
-      pos_BP_nach = BP_Pos_Nr[group_j+1];
+      pos_BP_vor = ctx->BP_Pos_Nr[group_i-1];
+      pos_BP_nach = ctx->BP_Pos_Nr[group_j+1];
 
       // in HairpinLoop
       if (pos_BP_vor == pos_BP_nach)
       {
-         size = BP_Order[pos_BP_vor][1] - BP_Order[pos_BP_vor][0] - 1;
-         return HairpinLoopEnergy(size,BP_Order[pos_BP_vor][0],int_seq);
+         size = ctx->BP_Order[pos_BP_vor][1] - ctx->BP_Order[pos_BP_vor][0] - 1;
+         return HairpinLoopEnergy(ctx, size,ctx->BP_Order[pos_BP_vor][0],int_seq);
       }
 
       // free base is right in a BL or IL or ML, pos_BP_nach = closingML
-      else if ((brackets[group_i-1] == ')') && (brackets[group_j+1] == ')'))
+      else if ((ctx->brackets[group_i-1] == ')') && (ctx->brackets[group_j+1] == ')'))
       {
-         return getPartEnergy(pos_BP_nach, pos_BP_vor, int_seq);
+         return getPartEnergy(ctx, pos_BP_nach, pos_BP_vor, int_seq);
       }
 
       // free base if left in a BL or IL or ML, pos_BP_vor = closingBP
-      else if ((brackets[group_i-1] == '(') && (brackets[group_j+1] == '('))
+      else if ((ctx->brackets[group_i-1] == '(') && (ctx->brackets[group_j+1] == '('))
       {
          //if (BP_Order[pos_BP_nach][3] == 0) ==> BL or IL (left);
          //else ==> ML, closingBP = pos_BP_nach
          // getPartEnergy can be used, since pos_BP_vor and pos_BP_nach are neighbors
 
          // HERE: pos_BP_nach is predecessor of pos_BP_vor
-         return getPartEnergy(pos_BP_vor, pos_BP_nach, int_seq);
+         return getPartEnergy(ctx, pos_BP_vor, pos_BP_nach, int_seq);
       }
-      else if (BP_Successors[pos_BP_vor] == BP_Successors[pos_BP_nach])
+      else if (ctx->BP_Successors[pos_BP_vor] == ctx->BP_Successors[pos_BP_nach])
       {
          //ML
-         if (BP_Successors[pos_BP_vor] != numBP)
-            return MLEnergy(BP_Successors[pos_BP_vor],int_seq);
+         if (ctx->BP_Successors[pos_BP_vor] != ctx->numBP)
+            return MLEnergy(ctx, ctx->BP_Successors[pos_BP_vor],int_seq);
          //EL
          else
-            return externEnergy(int_seq);
+            return externEnergy(ctx, int_seq);
       }
 
       //forgotten cases
@@ -644,59 +924,167 @@ double get_BasePart_Energy(int pos_i, int* int_seq)
 
 /*---------------------------------------------------------------------------*/
 /* identifies the energy difference that arises by the mutation of a free
-   base or a base pair (refers to the whole structure) */
+   base or a base pair (refers to the whole structure int_seq, which is
+   mutated during the calculation, but restored afterwards) */
 /*---------------------------------------------------------------------------*/
 
-void EnergyDiff(int pos_j, char* sequence)
+void EnergyDiff(DesignContext* ctx, int pos_j, int* int_seq)
 {
    int pos_i;               // binding pos. of pos. pos_j, if a BP is at pos. pos_j
    int bp_i_new, bp_j_new;  // mutated assignments of the bases of the BP
    int bp_assign_new, base_assign_new; //mutated assignment of the BP and the free base
-   double e_old, e_new, e_diff;
-   int *int_seq, *int_seq_new;         //mutated int_seq
-
-   int_seq = char2int(sequence);
-   int_seq_new = char2int(sequence);
+   int old_i, old_j;        // assignment of the current sequence
+   int e_old, e_new;
+   double e_diff;
 
    //free base
-   if (brackets[pos_j] == '.')
+   if (ctx->brackets[pos_j] == '.')
    {
+      old_j = int_seq[pos_j];
+      e_old = get_BasePart_Energy(ctx, pos_j, int_seq);
       //depending on the location of the base
       for (base_assign_new = 0; base_assign_new < 4; base_assign_new++)
       {
-         int_seq_new[pos_j] = base_assign_new;
-         e_old = get_BasePart_Energy(pos_j, int_seq);
-         e_new = get_BasePart_Energy(pos_j, int_seq_new);
+         int_seq[pos_j] = base_assign_new;
+         e_new = get_BasePart_Energy(ctx, pos_j, int_seq);
          e_diff = Sub_MinInt(e_old, e_new); // the higher, the better
          /*printf("pos: %d  --  assign_new: %d\n", pos_j, base_assign_new);
          printf("e_old: %f\n", e_old);
          printf("e_new: %f\n", e_new);
          printf("e_dif: %f\n\n", e_diff);*/
-         Ediff[pos_j][base_assign_new] = e_diff;
+         ctx->Ediff[pos_j][base_assign_new] = e_diff;
       }
+      int_seq[pos_j] = old_j;
    }
    //BP (only considered at the closing positions)
-   else if (brackets[pos_j] == ')')
+   else if (ctx->brackets[pos_j] == ')')
    {
-      pos_i = BP_Order[BP_Pos_Nr[pos_j]][0];
+      pos_i = ctx->BP_Order[ctx->BP_Pos_Nr[pos_j]][0];
+      old_i = int_seq[pos_i];
+      old_j = int_seq[pos_j];
+      e_old = get_BP_Energy(ctx, pos_i, int_seq);
       for (bp_assign_new = 0; bp_assign_new< 6; bp_assign_new++)
       {
          BP2_2(bp_assign_new, bp_i_new, bp_j_new);
-         int_seq_new[pos_i] = bp_i_new;
-         int_seq_new[pos_j] = bp_j_new;
-         e_old = get_BP_Energy(pos_i, int_seq);
-         e_new = get_BP_Energy(pos_i, int_seq_new);
+         int_seq[pos_i] = bp_i_new;
+         int_seq[pos_j] = bp_j_new;
+         e_new = get_BP_Energy(ctx, pos_i, int_seq);
          e_diff = Sub_MinInt(e_old, e_new); // the higher, the better
          /*printf("pos_i: %d  --  bp_i_new: %d\n", pos_i, bp_i_new);
          printf("e_old: %f\n", e_old);
          printf("e_new: %f\n", e_new);
          printf("e_dif: %f\n\n", e_diff);*/
 
-         Ediff[pos_j][bp_assign_new] = e_diff;
+         ctx->Ediff[pos_j][bp_assign_new] = e_diff;
       }//for (bp_assign)
+      int_seq[pos_i] = old_i;
+      int_seq[pos_j] = old_j;
    }//else if '('
 }
 
+/*---------------------------------------------------------------------------*/
+/* change of the energy of the target structure if base i of int_seq (the
+   whole sequence) is set to b_i and, if i is paired, its partner j to b_j
+   (j = -1 for a free base). A penalized new assignment gives MAX_DOUBLE   */
+/*---------------------------------------------------------------------------*/
+
+double MutationEnergyDelta(DesignContext* ctx, int* int_seq, int i, int b_i, int j, int b_j)
+{
+   int old_i = int_seq[i], old_j;
+   int e_old, e_new;
+
+   if (j < 0)
+   {
+      e_old = get_BasePart_Energy(ctx, i, int_seq);
+      int_seq[i] = b_i;
+      e_new = get_BasePart_Energy(ctx, i, int_seq);
+      int_seq[i] = old_i;
+   }
+   else
+   {
+      old_j = int_seq[j];
+      e_old = get_BP_Energy(ctx, Minimum(i,j), int_seq);
+      int_seq[i] = b_i;
+      int_seq[j] = b_j;
+      e_new = get_BP_Energy(ctx, Minimum(i,j), int_seq);
+      int_seq[i] = old_i;
+      int_seq[j] = old_j;
+   }
+
+   if (e_new == MAX_ENERGY)
+      return MAX_DOUBLE;
+   if (e_old == MAX_ENERGY)
+      return -MAX_DOUBLE;
+   return (e_new - e_old)/100.0;
+}
+
+/*---------------------------------------------------------------------------*/
+/* energy filter of the local search: 1, if the candidate is not folded.
+   screen 1: candidates raising the energy of the target structure by more
+   than energy_filter are deferred (marked in *deferred, counted in
+   filtered), screen 2: the pass after a screened pass without a step folds
+   only the deferred ones, they don't count as saved any more             */
+/*---------------------------------------------------------------------------*/
+
+int Filtered(DesignContext* ctx, int screen, char* deferred, int* int_seq, int i, int b_i, int j, int b_j)
+{
+   if (screen == 0)
+      return 0;
+   if (screen == 2)
+   {
+      if (*deferred == 0)   // folded in the screened pass (or not a neighbor there)
+         return 1;
+      *deferred = 0;
+      ctx->filtered--;
+      return 0;
+   }
+   if (MutationEnergyDelta(ctx, int_seq, i, b_i, j, b_j) <= ctx->energy_filter)
+      return 0;
+   *deferred = 1;
+   ctx->filtered++;
+   return 1;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/*********************************************************
+ budgets of one run of the local search: running time
+ (monotonic clock), folded candidates and accepted steps.
+ When one is exceeded, time_out is set and the search
+ stops with the best sequence found so far
+*********************************************************/
+
+double Monotonic_Time()
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+void Start_Budget(DesignContext* ctx)
+{
+   ctx->time_out = 0;
+   ctx->evaluations = 0;
+   ctx->accepted = 0;
+   ctx->filtered = 0;
+   ctx->start_time = Monotonic_Time();
+}
+
+// pending: neighbors of a parallel batch in front of the current one. They use up the evaluations
+// only if none of them is accepted, so the search is not stopped here (as in the serial search)
+int Budget_Exceeded(DesignContext* ctx, int pending)
+{
+   if (ctx->time_out == 0)
+      if (((ctx->max_evaluations > 0) && (ctx->evaluations >= ctx->max_evaluations)) ||
+          ((ctx->max_accepted > 0) && (ctx->accepted >= ctx->max_accepted)) ||
+          ((ctx->deadline > 0) && (Monotonic_Time() - ctx->start_time >= ctx->deadline)))
+         ctx->time_out = 1;
+   if ((ctx->max_evaluations > 0) && (ctx->evaluations + pending >= ctx->max_evaluations))
+      return 1;
+   return ctx->time_out;
+}
+
 /*-------------------------------------------------------------------------*/
 
                       /* THE LOCAL SEARCH */
@@ -705,17 +1093,22 @@ void EnergyDiff(int pos_j, char* sequence)
 
 /*-------------------------------------------------------------------------*/
 
-double local_search(char *start, char *target, int pos_i, int pos_j, char* whole_seq)
+double local_search(DesignContext* ctx, char *start, char *target, int pos_i, int pos_j, char* whole_seq)
 {
-   int i,j,bp_i,bp_j,tt,w1,w2, n_pos, len, flag, pos, n_pos2;
+   int i,j,bp_i,bp_j,tt,w1,w2, n_pos, len, flag, pos;
    long  walk_len;
    char *string, *string2, *cstring, *structure, *struct2, *beststring;
-   int *mut_pos_list, mut_sym_list[MAXALPHA+1], mut_pair_list[2*MAXALPHA+1], *help_mut_pos_list;
+   int *mut_pos_list, mut_sym_list[MAXALPHA+1], mut_pair_list[2*MAXALPHA+1];
    int *w1_list, *w2_list, mut_position, symbol, bp;
    int *target_table, *test_table;
    char cont;
    double cost, current_cost, ccost2, best_cost;
-   double (*cost_function)(char *, char *, char *);
+   double (*cost_function)(DesignContext*, char *, char *, char *);
+
+   //variabels for folding the neighbors in parallel
+   int par = 0;          // 1, if the neighbors are folded in parallel
+   int n_cand, k;
+   Neighbor* neighbors = NULL;
 
    //variabels for the stochastic local search
    int better;     // if = 1, improve step during the search
@@ -723,9 +1116,17 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
    int real_steps; // count the steps
    double ran;     // random number
 
+   //variabels for the energy filter of the candidates
+   int screen;          // 1: the candidates are screened by the energy change of the target structure,
+                        // 2: only the deferred ones are folded (see Filtered)
+   char* deferred;      // candidates deferred in the last screened pass, (base+npairs) per position
+   long pass_filtered;  // candidates skipped by the filter before the current pass
+   long pass_accepted;  // accepted steps before the current pass
+
    int* int_seq;
+   size_t mark;         // used part of the scratch arena before the work space of this run
    int mismatches = 0;  //local variable for reminding the current number of mismatches
-   int mis2, best_mis = num_mis;  //local variable for reminding the number of mismatches (anal. ccost2, best_cost)
+   int mis2, best_mis = ctx->num_mis;  //local variable for reminding the number of mismatches (anal. ccost2, best_cost)
 
    /*whole_seq is the whole sequence and not only the subsequence that is considered in the current run of local_search,
      whole_seq has to be updated during the run (if a mutation in the subsequence is accepted)
@@ -740,20 +1141,43 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
       fprintf(stderr, "%s\n%s\n", start, target);
       nrerror("local_search: start and target have unequal length");
    }
-   string    = (char *) space(sizeof(char)*(len+1));
-   cstring   = (char *) space(sizeof(char)*(len+1));
-   string2   = (char *) space(sizeof(char)*(len+1));
-   beststring= (char *) space(sizeof(char)*(len+1));
-   structure = (char *) space(sizeof(char)*(len+1));
-   struct2   = (char *) space(sizeof(char)*(len+1)); 
-   mut_pos_list = (int *) space(sizeof(int)*len);
-   w1_list = (int *) space(sizeof(int)*len);
-   w2_list = (int *) space(sizeof(int)*len);
-   target_table = (int *) space(sizeof(int)*len);
-   test_table = (int *) space(sizeof(int)*len);
+   //the work space is taken from the scratch arena and given back at the end
+   mark = ctx->scratch_used;
+   string    = (char *) Scratch_Alloc(ctx, sizeof(char)*(len+1));
+   cstring   = (char *) Scratch_Alloc(ctx, sizeof(char)*(len+1));
+   string2   = (char *) Scratch_Alloc(ctx, sizeof(char)*(len+1));
+   beststring= (char *) Scratch_Alloc(ctx, sizeof(char)*(len+1));
+   structure = (char *) Scratch_Alloc(ctx, sizeof(char)*(len+1));
+   struct2   = (char *) Scratch_Alloc(ctx, sizeof(char)*(len+1));
+   mut_pos_list = (int *) Scratch_Alloc(ctx, sizeof(int)*len);
+   w1_list = (int *) Scratch_Alloc(ctx, sizeof(int)*len);
+   w2_list = (int *) Scratch_Alloc(ctx, sizeof(int)*len);
+   target_table = (int *) Scratch_Alloc(ctx, sizeof(int)*len);
+   test_table = (int *) Scratch_Alloc(ctx, sizeof(int)*len);
+   int_seq = (int *) Scratch_Alloc(ctx, sizeof(int)*ctx->struct_len);
+   deferred = (char *) Scratch_Alloc(ctx, sizeof(char)*len*(base+npairs));
+   // the strings start empty as with space() (pf_fold doesn't write the structure without backtracking)
+   memset(string, 0, len+1);
+   memset(cstring, 0, len+1);
+   memset(string2, 0, len+1);
+   memset(beststring, 0, len+1);
+   memset(structure, 0, len+1);
+   memset(struct2, 0, len+1);
 
    make_ptable(target, target_table);
 
+   if ((ctx->num_threads > 1) && (ctx->fold_type == 0) && ctx->engines[0]->backend->thread_safe)
+   {
+      par = 1;
+      // a batch consists of at least num_threads neighbors (the neighbors of one position are added completely)
+      neighbors = (Neighbor*) Scratch_Alloc(ctx, sizeof(Neighbor)*(ctx->num_threads+npairs));
+      for (k=0; k<ctx->num_threads+npairs; k++)
+      {
+         neighbors[k].seq = (char *) Scratch_Alloc(ctx, sizeof(char)*(len+1));
+         neighbors[k].structure = (char *) Scratch_Alloc(ctx, sizeof(char)*(len+1));
+      }
+   }
+
    for (i=0; i<base; i++) mut_sym_list[i] = i;
    for (i=0; i<npairs; i++) mut_pair_list[i] = i;
 
@@ -763,19 +1187,23 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
 
    walk_len = 0;
 
-   if (fold_type==0)
+   if (ctx->fold_type==0)
+      fold_engines_init(ctx, string);
+
+   if (ctx->fold_type==0)
       cost_function = mfe_cost;
    else
       cost_function = pf_cost;
    
-   cost = cost_function(string, structure, target);
+   cost = cost_function(ctx, string, structure, target);
+   ctx->evaluations++;
 
-   if (fold_type==0)
-      ccost2=cost2;
+   if (ctx->fold_type==0)
+      ccost2=ctx->cost2;
    else
    {
       ccost2 = -1.;
-      cost2=0;
+      ctx->cost2=0;
    }
    
    strcpy(cstring, string);
@@ -783,7 +1211,8 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
    current_cost = cost;
    best_cost = cost;
 
-   int_seq = char2int(start);
+   char2int(start, int_seq);
+   screen = (ctx->energy_filter >= 0);
 
    /*********************************************************************
    *               Adaptive Walk / Stochastic Local Search              *
@@ -792,15 +1221,24 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
    better = 0;
    real_steps = 0;
    //max. number of steps depends on the length of the sequence:
-   max_steps = step_multiplier * len;
+   max_steps = ctx->step_multiplier * len;
 
-   if ((search_strategy == 1) || (search_strategy == 3))
+   if ((ctx->search_strategy == 1) || (ctx->search_strategy == 3))
    {
-      if ((cost>0) && (time_out == 0)) do
+      if ((cost>0) && (ctx->time_out == 0)) do
       {
          cont=0;
+         pass_filtered = ctx->filtered;
+         pass_accepted = ctx->accepted;
+         if (screen == 1)
+            memset(deferred, 0, sizeof(char)*len*(base+npairs));
+         if ((screen != 0) || (ctx->neighbour_choice == 2))
+         {
+            //the energy changes refer to the whole sequence
+            char2int(whole_seq, int_seq);
+         }
 
-         if (fold_type==0) /* min free energy fold */
+         if (ctx->fold_type==0) /* min free energy fold */
          {
             //mutate only the positions that are not paired correctly or adjacent to those
             make_ptable(structure, test_table);
@@ -827,10 +1265,10 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
                   flag = 0;
                }
 
-            if (neighbour_choice == 1)
+            if (ctx->neighbour_choice == 1)
             {
-                  shuffle(w1_list, w1);
-                  shuffle(w2_list, w2);
+                  shuffle(ctx, w1_list, w1);
+                  shuffle(ctx, w2_list, w2);
 
                   for (j=n_pos=0; j<w1; j++)
                      mut_pos_list[n_pos++] = w1_list[j];
@@ -839,77 +1277,36 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
             }
             else //neighbour_choice == 2
             {
-               /*Ediff contains the energy difference for each mutation at all candidate pos.*/
-               init_Ediff();
+               /*Ediff contains the energy difference for each mutation at all candidate pos., only the
+                 rows of the loops changed since the last iteration are recomputed*/
+               update_Ediff(ctx, whole_seq);
 
                // pos. that are not paired correctly are analyzed first, they are analyzed concerning
-               // the order given by av_Ediff
-               //-------------------------------------------------------------------------------------
-               for (i = 0; i<w1; i++)
-                  EnergyDiff(w1_list[i]+pos_i, whole_seq);
-
-               make_av_Ediff();
-
-               n_pos = 0;
-               mut_pos_list = make_mut_pos_list();
-
-               for (i=0; i<struct_len; i++)
-                  if (av_Ediff[mut_pos_list[i]] > MIN_INT)
-                     n_pos++;
-               //translate the pos.numbers to pos.numbers in the current substructure
-               for (i=0; i<n_pos; i++)
-                  mut_pos_list[i] = mut_pos_list[i] - pos_i;
-
-               //**************************************************************************************
-               //**************************************************************************************
-               init_Ediff();
-               //**************************************************************************************
-               //**************************************************************************************
-
-
-               // afterwards mutated the neighbors of the pos. that are not paired correctly, they are
-               // analyzed concerning the order given by av_Ediff
-               //---------------------------------------------------------------------------------------------
-               for (i = 0; i<w2; i++)
-                  EnergyDiff(w2_list[i]+pos_i, whole_seq);
-               make_av_Ediff();
-
-               n_pos2 = n_pos;
-               help_mut_pos_list = make_mut_pos_list();
-
-               for (i=0; i<struct_len-w1; i++)
-                  if (av_Ediff[help_mut_pos_list[i]] > MIN_INT)
-                  {
-                     mut_pos_list[i+n_pos2] = help_mut_pos_list[i] - pos_i;
-                     n_pos++;
-                  }
+               // the order given by av_Ediff, afterwards the neighbors of these pos.
+               n_pos = rank_Positions(ctx, w1_list, w1, pos_i, mut_pos_list, int_seq);
+               n_pos += rank_Positions(ctx, w2_list, w2, pos_i, mut_pos_list+n_pos, int_seq);
             }
          }
          else /* partition_function */
          {
-            if (neighbour_choice == 1)
+            if (ctx->neighbour_choice == 1)
             {
                for (j=n_pos=0; j<len; j++)
                   if (isupper(start[j]))
                      if (target_table[j]<=j)
                         mut_pos_list[n_pos++] = j;
-               shuffle(mut_pos_list, n_pos);
+               shuffle(ctx, mut_pos_list, n_pos);
             }
             else //neighbour_choice == 2
             {
 	       /*pf-mode (taking into account all positions)*/
-               for (j = 0; j<len; j++)
+               update_Ediff(ctx, whole_seq);
+               for (j=n_pos=0; j<len; j++)
                   if (isupper(start[j]))
                      if (target_table[j]<=j)
-                        EnergyDiff(j, whole_seq);
-
-               make_av_Ediff();
+                        w1_list[n_pos++] = j;
 
-               n_pos = 0;
-               mut_pos_list = make_mut_pos_list();
-               for (i=0; i<struct_len; i++)
-                  if (av_Ediff[mut_pos_list[i]] > MIN_INT)
-                     n_pos++;
+               n_pos = rank_Positions(ctx, w1_list, n_pos, 0, mut_pos_list, int_seq);
             }
          }
 
@@ -917,216 +1314,284 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
          mis2 = 0;
          for (mut_position=0; mut_position<n_pos; mut_position++)
          {
-            strcpy(string, cstring);
-            shuffle(mut_sym_list,  base);
-            shuffle(mut_pair_list, npairs);
-
-            i = mut_pos_list[mut_position];
-
-            if (target_table[i]<0) /* unpaired base */
-               for (symbol=0;symbol<base;symbol++)
+            if (par == 1)
+            {
+               /* the neighbors of the next positions are generated in the order of the serial search (including
+                  the random numbers), folded in parallel and checked in this order afterwards. so, the neighbor
+                  that is accepted and the state of the random generator are the same as in the serial search */
+               n_cand = 0;
+               for (flag=0; mut_position<n_pos; mut_position++)
                {
-                  if(cstring[i] == int2char(mut_sym_list[symbol]))
-                     continue;
+                  shuffle(ctx, mut_sym_list,  base);
+                  shuffle(ctx, mut_pair_list, npairs);
 
-                  /******************************************************/
-                  /*                 mismatch testing                   */
-                  /******************************************************/
+                  i = mut_pos_list[mut_position];
 
-                  mismatches = 0;
-                  // if in the current sequence is no mismatch at the considered position
-                  if (seq_constraints[pos_i+i][char2int_base(cstring[i])] == 1)
-                  {
-                     // if the assignment of the base is forbidden and maximal number of mismatches is reached or the base is located 
-                     // outside the mismatch interval, no further testing.
-                     if ((seq_constraints[pos_i+i][mut_sym_list[symbol]] == 0) && ((num_mis >= max_mis) || (mis_vec[pos_i+i] == 0)))
-                        continue;
+                  if (target_table[i]<0) /* unpaired base */
+                     for (symbol=0;symbol<base;symbol++)
+                     {
+                        if(cstring[i] == int2char(mut_sym_list[symbol]))
+                           continue;
+                        if (BaseMismatches(ctx, pos_i+i, char2int_base(cstring[i]), mut_sym_list[symbol], mismatches) == 0)
+                           continue;
+                        if (Filtered(ctx, screen, deferred+i*(base+npairs)+mut_sym_list[symbol], int_seq, pos_i+i, mut_sym_list[symbol], -1, 0))
+                           continue;
 
-                     // if the assignment of the base is forbidden, this mismatch should be added
-                     // if we are still in the for-loop, it is clear that the constrained base is located in the mismatch interval. 
-                     // thus, it is not necessary to test it again
-                     // if ((seq_constraints[pos_i+i][mut_sym_list[symbol]] == 0) && (PosInMisInterval(pos_i+i) == 1))
-                     if (seq_constraints[pos_i+i][mut_sym_list[symbol]] == 0)
-                        mismatches = 1;
-                  }
-                  // if in the current sequence the current position is already a mismatch: everything is possible, i.e. it can be mutated
-                  // to another mismatch or to a match
-                  else
-                     if (seq_constraints[pos_i+i][mut_sym_list[symbol]] == 1)
-                        mismatches = -1; //current base is a mismatch but the new one not => one mismatch less
+                        if (ctx->only_mutation_is_step == 0)
+                        {
+                           real_steps++;
+                           if ((ctx->search_strategy == 3) && (real_steps > max_steps))
+                           {
+                              flag = 1;
+                              break;
+                           }
+                        }
+                        if (Budget_Exceeded(ctx, n_cand))
+                        {
+                           flag = 2;
+                           break;
+                        }
+
+                        strcpy(neighbors[n_cand].seq, cstring);
+                        neighbors[n_cand].seq[i] = int2char(mut_sym_list[symbol]);
+                        neighbors[n_cand].pos = mut_position;
+                        neighbors[n_cand].mismatches = mismatches;
+                        neighbors[n_cand].steps = real_steps;
+                        neighbors[n_cand].filtered = ctx->filtered;
+                        neighbors[n_cand].ran = erand48(ctx->rng);
+                        memcpy(neighbors[n_cand].rng, ctx->rng, sizeof(neighbors[n_cand].rng));
+                        memcpy(neighbors[n_cand].sym_list, mut_sym_list, sizeof(mut_sym_list));
+                        memcpy(neighbors[n_cand].pair_list, mut_pair_list, sizeof(mut_pair_list));
+                        n_cand++;
+                     }
+                  else  /* paired base */
+                     for  (bp=0; bp<npairs; bp++)
+                     {
+                        j = target_table[i];
+                        BP2_2(mut_pair_list[bp], bp_i, bp_j);
 
-                  /******************************************************/
+                        if ((cstring[i] == int2char(bp_i)) && (cstring[j] == int2char(bp_j)))
+                           continue;
+                        if (PairMismatches(ctx, pos_i+i, pos_i+j, char2int_base(cstring[i]), char2int_base(cstring[j]), bp_i, bp_j, mismatches) == 0)
+                           continue;
+                        if (Filtered(ctx, screen, deferred+i*(base+npairs)+base+mut_pair_list[bp], int_seq, pos_i+i, bp_i, pos_i+j, bp_j))
+                           continue;
 
+                        if (ctx->only_mutation_is_step == 0)
+                        {
+                           real_steps++;
+                           if ((ctx->search_strategy == 3) && (real_steps > max_steps))
+                           {
+                              flag = 1;
+                              break;
+                           }
+                        }
+                        if (Budget_Exceeded(ctx, n_cand))
+                        {
+                           flag = 2;
+                           break;
+                        }
+
+                        strcpy(neighbors[n_cand].seq, cstring);
+                        neighbors[n_cand].seq[i] = int2char(bp_i);
+                        neighbors[n_cand].seq[j] = int2char(bp_j);
+                        neighbors[n_cand].pos = mut_position;
+                        neighbors[n_cand].mismatches = mismatches;
+                        neighbors[n_cand].steps = real_steps;
+                        neighbors[n_cand].filtered = ctx->filtered;
+                        neighbors[n_cand].ran = erand48(ctx->rng);
+                        memcpy(neighbors[n_cand].rng, ctx->rng, sizeof(neighbors[n_cand].rng));
+                        memcpy(neighbors[n_cand].sym_list, mut_sym_list, sizeof(mut_sym_list));
+                        memcpy(neighbors[n_cand].pair_list, mut_pair_list, sizeof(mut_pair_list));
+                        n_cand++;
+                     }
 
-                  string[i] = int2char(mut_sym_list[symbol]);
+                  if ((flag != 0) || ((ctx->search_strategy == 3) && (real_steps >= max_steps)) || (n_cand >= ctx->num_threads))
+                     break;
+               }
 
-                  if (only_mutation_is_step == 0)
-                  {
-                     real_steps++;
-                     if ((search_strategy == 3) && (real_steps > max_steps))
-                        break;
-                  }
+               #pragma omp parallel for num_threads(ctx->num_threads) schedule(dynamic,1)
+               for (k=0; k<n_cand; k++)
+                  neighbors[k].cost = engine_mfe_cost(ctx, ctx->engines[omp_get_thread_num()], neighbors[k].seq,
+                                                      neighbors[k].structure, target, &neighbors[k].cost2);
 
-                  cost = cost_function(string, structure, target);
-                  ran = urn();
+               for (k=0; k<n_cand; k++)
+               {
+                  ctx->evaluations++;    // the neighbors after the accepted one are not counted (as in the serial search)
+                  cost = neighbors[k].cost;
+                  ctx->cost2 = neighbors[k].cost2;
+                  strcpy(string, neighbors[k].seq);
+                  strcpy(structure, neighbors[k].structure);
+                  mismatches = neighbors[k].mismatches;
 
-                  if ( cost < current_cost )
-                  {
-                     better = 1;
-                     break;
-                  }
                   //during the SLS: even worse muatations are accepted with a small probability
-                  if ((search_strategy == 3) && (ran < p_accept))
+                  if (( cost < current_cost ) || ((ctx->search_strategy == 3) && (neighbors[k].ran < ctx->p_accept)))
                   {
+                     // continue as the serial search after this neighbor
                      better = 1;
+                     mut_position = neighbors[k].pos;
+                     real_steps = neighbors[k].steps;
+                     ctx->filtered = neighbors[k].filtered;
+                     memcpy(ctx->rng, neighbors[k].rng, sizeof(neighbors[k].rng));
+                     memcpy(mut_sym_list, neighbors[k].sym_list, sizeof(mut_sym_list));
+                     memcpy(mut_pair_list, neighbors[k].pair_list, sizeof(mut_pair_list));
                      break;
                   }
-
-                  if (( cost == current_cost)&&(cost2<ccost2))
+                  if (( cost == current_cost)&&(ctx->cost2<ccost2))
                   {
                      strcpy(string2, string);
                      strcpy(struct2, structure);
-                     ccost2 = cost2;
+                     ccost2 = ctx->cost2;
                      mis2 = mismatches;
                   }
-               } //for (symbol)
-            else  /* paired base */
-               for  (bp=0; bp<npairs; bp++)
-               {
-                  j = target_table[i]; //finging the binding base
-                  BP2_2(mut_pair_list[bp], bp_i, bp_j);
-
-                  if ((cstring[i] == int2char(bp_i)) && (cstring[j] == int2char(bp_j)))
-                     continue;
-
-                  /******************************************************/
-                  /*                 mismatch testing                   */
-                  /******************************************************/
-
-                  mismatches = 0;
+               }
+               // the batch was cut by the budget (flag 2) and no neighbor was accepted: the serial search
+               // stops at the next neighbor, so the search stops here (before the next shuffle)
+               if ((flag == 2) && (better == 0))
+                  Budget_Exceeded(ctx, 0);
+            }
+            else
+            {
+               strcpy(string, cstring);
+               shuffle(ctx, mut_sym_list,  base);
+               shuffle(ctx, mut_pair_list, npairs);
 
-                  // first testing whether the mismatches are allowed
-                  if (((mis_vec[pos_i+i] == 0) && (seq_constraints[pos_i+i][bp_i] == 0)) || ((mis_vec[pos_i+j] == 0) && (seq_constraints[pos_i+j][bp_j] == 0)))
-                     continue;
+               i = mut_pos_list[mut_position];
 
-                  // if in the current sequence are no mismatches at the considered positions
-                  if ((seq_constraints[pos_i+i][char2int_base(cstring[i])] == 1) && (seq_constraints[pos_i+j][char2int_base(cstring[j])] == 1))
+               if (target_table[i]<0) /* unpaired base */
+                  for (symbol=0;symbol<base;symbol++)
                   {
-                     // if the assignment of the bases is forbidden and maximal number of mismatches is reached, no further testing.
-                     // (that the mismatches are valid has already been tested)
-                     if ((seq_constraints[pos_i+i][bp_i] == 0) && (num_mis >= max_mis))
+                     if(cstring[i] == int2char(mut_sym_list[symbol]))
                         continue;
 
-                     if ((seq_constraints[pos_i+j][bp_j] == 0) && (num_mis >= max_mis))
+                     // mismatch testing
+                     if (BaseMismatches(ctx, pos_i+i, char2int_base(cstring[i]), mut_sym_list[symbol], mismatches) == 0)
                         continue;
-
-                     // if the assignment of both positions is forbidden and the maximal number of mismatches - 1 is reached, no further testing.
-                     if (((seq_constraints[pos_i+i][bp_i] == 0) && (seq_constraints[pos_i+j][bp_j] == 0)) && (num_mis >= max_mis-1))
+                     if (Filtered(ctx, screen, deferred+i*(base+npairs)+mut_sym_list[symbol], int_seq, pos_i+i, mut_sym_list[symbol], -1, 0))
                         continue;
 
-                     // if the assignment of the base is forbidden, this mismatch should be added
-                     // it is clear that the constrained bases are valid for mismatches
-                     if (seq_constraints[pos_i+i][bp_i] == 0)
-                        mismatches++;
-                     if (seq_constraints[pos_i+j][bp_j] == 0)
-                        mismatches++;
-                  }
-                  // if in the current sequence is already one mismatch at one of the two considered positions
-                  else if ((seq_constraints[pos_i+i][char2int_base(cstring[i])] == 1) || (seq_constraints[pos_i+j][char2int_base(cstring[j])] == 1))
-                  {
-                     // if there are one match and one mismatch currently and after the mutation two matches: allowed but the number of mismatches reduces
-                     if ((seq_constraints[pos_i+i][bp_i] == 1) && (seq_constraints[pos_i+j][bp_j] == 1))
-                        mismatches--;
-                     // if there are one match and one mismatch currently and after the mutation as well: the number of mismatches remains unchanged
-                     // (it is already clear that the mismatches are valid)
-                     //else if ((seq_constraints[pos_i+i][bp_i] == 0) && (seq_constraints[pos_i+j][bp_j] == 1))
-                     //else if ((seq_constraints[pos_i+i][bp_i] == 1) && (seq_constraints[pos_i+j][bp_j] == 0))
+                     string[i] = int2char(mut_sym_list[symbol]);
 
-                     // if there are one match and one mismatch currently and after the mutation two mismatches:
-                     // the number of mismatches has to be increased by one and we have to take care of the maximal number 
-                     // of allowed mismatches (max_mis)
-                     else if ((seq_constraints[pos_i+i][bp_i] == 0) && (seq_constraints[pos_i+j][bp_j] == 0))
+                     if (ctx->only_mutation_is_step == 0)
                      {
-                        if (num_mis >= max_mis)
-                           continue;
-                        else
-                           mismatches++;
+                        real_steps++;
+                        if ((ctx->search_strategy == 3) && (real_steps > max_steps))
+                           break;
                      }
-                  }
-                  // if both current positions are already mismatches, : everything is possible, i.e. it can be mutated
-                  // to another mismatch or to a match
-                  else
-                  {
-                     //current base is a mismatch but the new one not => one mismatch less
-                     if (seq_constraints[pos_i+i][bp_i] == 1)
-                        mismatches--;
-                     if (seq_constraints[pos_i+j][bp_j] == 1)
-                        mismatches--;
-                  }
 
-                  /******************************************************/
+                     if (Budget_Exceeded(ctx, 0))
+                        break;
 
-                  string[i] = int2char(bp_i);
-                  string[j] = int2char(bp_j);
+                     cost = cost_function(ctx, string, structure, target);
+                     ctx->evaluations++;
+                     ran = erand48(ctx->rng);
+
+                     if ( cost < current_cost )
+                     {
+                        better = 1;
+                        break;
+                     }
+                     //during the SLS: even worse muatations are accepted with a small probability
+                     if ((ctx->search_strategy == 3) && (ran < ctx->p_accept))
+                     {
+                        better = 1;
+                        break;
+                     }
 
-                  if (only_mutation_is_step == 0)
+                     if (( cost == current_cost)&&(ctx->cost2<ccost2))
+                     {
+                        strcpy(string2, string);
+                        strcpy(struct2, structure);
+                        ccost2 = ctx->cost2;
+                        mis2 = mismatches;
+                     }
+                  } //for (symbol)
+               else  /* paired base */
+                  for  (bp=0; bp<npairs; bp++)
                   {
-                     real_steps++;
-                     if ((search_strategy == 3) && (real_steps > max_steps))
+                     j = target_table[i]; //finging the binding base
+                     BP2_2(mut_pair_list[bp], bp_i, bp_j);
+
+                     if ((cstring[i] == int2char(bp_i)) && (cstring[j] == int2char(bp_j)))
+                        continue;
+
+                     // mismatch testing
+                     if (PairMismatches(ctx, pos_i+i, pos_i+j, char2int_base(cstring[i]), char2int_base(cstring[j]), bp_i, bp_j, mismatches) == 0)
+                        continue;
+                     if (Filtered(ctx, screen, deferred+i*(base+npairs)+base+mut_pair_list[bp], int_seq, pos_i+i, bp_i, pos_i+j, bp_j))
+                        continue;
+
+                     string[i] = int2char(bp_i);
+                     string[j] = int2char(bp_j);
+
+                     if (ctx->only_mutation_is_step == 0)
+                     {
+                        real_steps++;
+                        if ((ctx->search_strategy == 3) && (real_steps > max_steps))
+                           break;
+                     }
+
+                     if (Budget_Exceeded(ctx, 0))
                         break;
-                  }
 
-                  cost = cost_function(string, structure, target);
-                  ran = urn();
+                     cost = cost_function(ctx, string, structure, target);
+                     ctx->evaluations++;
+                     ran = erand48(ctx->rng);
 
-                  if ( cost < current_cost )
-                  {
-                     better = 1;
-                     break;
-                  }
-                  //during the SLS: even worse muatations are accepted with a small probability
-                  if ((search_strategy == 3) && (ran < p_accept))
-                  {
-                     better = 1;
-                     break;
-                  }
-                  if (( cost == current_cost)&&(cost2<ccost2))
-                  {
-                     strcpy(string2, string);
-                     strcpy(struct2, structure);
-                     ccost2 = cost2;
-                     mis2 = mismatches;
-                  }
-               } //for (bp)
+                     if ( cost < current_cost )
+                     {
+                        better = 1;
+                        break;
+                     }
+                     //during the SLS: even worse muatations are accepted with a small probability
+                     if ((ctx->search_strategy == 3) && (ran < ctx->p_accept))
+                     {
+                        better = 1;
+                        break;
+                     }
+                     if (( cost == current_cost)&&(ctx->cost2<ccost2))
+                     {
+                        strcpy(string2, string);
+                        strcpy(struct2, structure);
+                        ccost2 = ctx->cost2;
+                        mis2 = mismatches;
+                     }
+                  } //for (bp)
+            }
 
             if (better == 1)
             {
                better = 0;
                strcpy(cstring, string);
+               if (ctx->fold_type==0)
+                  fold_engines_accept(ctx, cstring);
                current_cost = cost;
-               num_mis += mismatches;
+               ctx->num_mis += mismatches;
 
                if (current_cost < best_cost)
                {
                   best_cost = current_cost;
                   strcpy(beststring, cstring);
-                  best_mis = num_mis;
+                  best_mis = ctx->num_mis;
                }
 
-               if (only_mutation_is_step == 1)
+               if (ctx->only_mutation_is_step == 1)
                {
                   real_steps++;
-                  if ((search_strategy == 3) && (real_steps > max_steps))
+                  if ((ctx->search_strategy == 3) && (real_steps > max_steps))
                      break;
                }
 
-               ccost2 = cost2;
+               ccost2 = ctx->cost2;
                walk_len++;
+               ctx->accepted++;
                if (cost > 0)
                   cont = 1;
                break;
             }
-            if ((search_strategy == 3) && (real_steps >= max_steps))
+            if ((ctx->search_strategy == 3) && (real_steps >= max_steps))
+               break;
+            if (ctx->time_out == 1)
                break;
          } //for (mut_position)
 
@@ -1137,17 +1602,30 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
               cost constant */
             strcpy(cstring, string2);
             strcpy(structure, struct2);
+            if (ctx->fold_type==0)
+               fold_engines_accept(ctx, cstring);
             //nc2++;
+            ctx->accepted++;
             cont=1;
-            num_mis += mis2;
+            ctx->num_mis += mis2;
          }
 
+         // no step in this pass, but candidates were deferred by the energy filter: the next pass folds them
+         // (and only them, the sequence is unchanged)
+         if ((screen == 1) && (ctx->accepted == pass_accepted) && (ctx->filtered > pass_filtered))
+         {
+            screen = 2;
+            cont = 1;
+         }
+         else
+            screen = (ctx->energy_filter >= 0);
+
          //cstring is the new sequence
          //the current subsequence has to be updated in whole_seq
          for (pos = pos_i; pos <=pos_j; pos++)
             whole_seq[pos] = cstring[pos-pos_i];
             
-         if (search_strategy == 3)
+         if (ctx->search_strategy == 3)
          {
             //stopp, if max. number of steps OR cost = 0 OR no allowed positions for mutation
             if ((real_steps >= max_steps) || (cost == 0) || (n_pos == 0))
@@ -1156,12 +1634,8 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
                cont = 1;
          }
 
-         time(&zw_time);
-         if (zw_time-start_time >= TIME_OUT_TIME)
-         {
-            time_out = 1;
+         if (Budget_Exceeded(ctx, 0))
             break;
-         }
          //printf("cstring:      %s ==> %d\n", cstring, num_mis);
 
       } while (cont);
@@ -1172,13 +1646,22 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
    /*********************************************************************
    *                 Full Local Search                                  *
    *********************************************************************/
-   else if (search_strategy == 2)
+   else if (ctx->search_strategy == 2)
    {
-      if ((cost>0) && (time_out == 0)) do
+      if ((cost>0) && (ctx->time_out == 0)) do
       {
          cont=0;
+         pass_filtered = ctx->filtered;
+         pass_accepted = ctx->accepted;
+         if (screen == 1)
+            memset(deferred, 0, sizeof(char)*len*(base+npairs));
+         if ((screen != 0) || (ctx->neighbour_choice == 2))
+         {
+            //the energy changes refer to the whole sequence
+            char2int(whole_seq, int_seq);
+         }
 
-         if (fold_type==0) /* min free energy fold */
+         if (ctx->fold_type==0) /* min free energy fold */
          {
             make_ptable(structure, test_table);
             for (j=w1=w2=flag=0; j<len; j++)
@@ -1202,8 +1685,8 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
                         w2_list[w2++] = j;                   /* adjacent to incorrect position */
                   flag = 0;
                }
-               shuffle(w1_list, w1);
-               shuffle(w2_list, w2);
+               shuffle(ctx, w1_list, w1);
+               shuffle(ctx, w2_list, w2);
 
                for (j=n_pos=0; j<w1; j++)
                   mut_pos_list[n_pos++] = w1_list[j];
@@ -1216,7 +1699,7 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
                if (isupper(start[j]))
                   if (target_table[j]<=j)
                      mut_pos_list[n_pos++] = j;
-            shuffle(mut_pos_list, n_pos);
+            shuffle(ctx, mut_pos_list, n_pos);
          }
 
          string2[0]='\0';
@@ -1224,11 +1707,13 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
          best_cost = current_cost;
          strcpy(beststring,cstring);
 
+         n_cand = 0;
+         flag = 0;
          for (mut_position=0; mut_position<n_pos; mut_position++)
          {
             strcpy(string, cstring);
-            shuffle(mut_sym_list,  base);
-            shuffle(mut_pair_list, npairs);
+            shuffle(ctx, mut_sym_list,  base);
+            shuffle(ctx, mut_pair_list, npairs);
 
             i = mut_pos_list[mut_position];
 
@@ -1244,45 +1729,61 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
 
                   mismatches = 0;
                   // if in the current sequence is no mismatch at the considered position
-                  if (seq_constraints[pos_i+i][char2int_base(cstring[i])] == 1)
+                  if (ctx->seq_constraints[pos_i+i][char2int_base(cstring[i])] == 1)
                   {
                      // if the assignment of the base is forbidden and maximal number of mismatches is reached or the base is located 
                      // outside the mismatch interval, no further testing.
-                     if ((seq_constraints[pos_i+i][mut_sym_list[symbol]] == 0) && ((num_mis >= max_mis) || (mis_vec[pos_i+i] == 0)))
+                     if ((ctx->seq_constraints[pos_i+i][mut_sym_list[symbol]] == 0) && ((ctx->num_mis >= ctx->max_mis) || (ctx->mis_vec[pos_i+i] == 0)))
                         continue;
 
                      // if the assignment of the base is forbidden, this mismatch should be added
                      // if we are still in the for-loop, it is clear that the constrained base is located in the mismatch interval. 
                      // thus, it is not necessary to test it again
                      // if ((seq_constraints[pos_i+i][mut_sym_list[symbol]] == 0) && (PosInMisInterval(pos_i+i) == 1))
-                     if (seq_constraints[pos_i+i][mut_sym_list[symbol]] == 0)
+                     if (ctx->seq_constraints[pos_i+i][mut_sym_list[symbol]] == 0)
                         mismatches = 1;
                   }
                   // if in the current sequence the current position is already a mismatch: everything is possible, i.e. it can be mutated
                   // to another mismatch or to a match
                   else
-                     if (seq_constraints[pos_i+i][mut_sym_list[symbol]] == 1)
+                     if (ctx->seq_constraints[pos_i+i][mut_sym_list[symbol]] == 1)
                         mismatches = -1; //current base is a mismatch but the new one not => one mismatch less
 
                   /******************************************************/
 
+                  if (Filtered(ctx, screen, deferred+i*(base+npairs)+mut_sym_list[symbol], int_seq, pos_i+i, mut_sym_list[symbol], -1, 0))
+                     continue;
+
                   string[i] = int2char(mut_sym_list[symbol]);
-                  cost = cost_function(string, structure, target);
+                  if (Budget_Exceeded(ctx, n_cand))
+                  {
+                     flag = 2;
+                     break;
+                  }
+                  if (par == 1)
+                  {
+                     // folded together with the neighbors of the next positions, compared afterwards
+                     strcpy(neighbors[n_cand].seq, string);
+                     neighbors[n_cand++].mismatches = mismatches;
+                     continue;
+                  }
+                  cost = cost_function(ctx, string, structure, target);
+                  ctx->evaluations++;
 
                   if ( cost < current_cost )
                   {
                      best_cost = cost;
                      strcpy(beststring,string);
-                     best_mis = num_mis + mismatches;
+                     best_mis = ctx->num_mis + mismatches;
                      //always compare to the best one found
-                     ccost2 = cost2;
+                     ccost2 = ctx->cost2;
                   }
-                  if (( cost == current_cost)&&(cost2<ccost2))
+                  if (( cost == current_cost)&&(ctx->cost2<ccost2))
                   {
                      //accept (without storing in string2), since all other will be tested as well
                      strcpy(beststring,string);
-                     ccost2 = cost2;
-                     best_mis = num_mis + mismatches;
+                     ccost2 = ctx->cost2;
+                     best_mis = ctx->num_mis + mismatches;
                   }
                }
             else  /* paired base */
@@ -1302,35 +1803,35 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
 
                   // first testing whether the mismatches are allowed
                   /**************************************************/
-                  if (((mis_vec[pos_i+i] == 0) && (seq_constraints[pos_i+i][bp_i] == 0)) || ((mis_vec[pos_i+j] == 0) && (seq_constraints[pos_i+j][bp_j] == 0)))
+                  if (((ctx->mis_vec[pos_i+i] == 0) && (ctx->seq_constraints[pos_i+i][bp_i] == 0)) || ((ctx->mis_vec[pos_i+j] == 0) && (ctx->seq_constraints[pos_i+j][bp_j] == 0)))
                      continue;
                   /**************************************************/
 
                   // if in the current sequence are no mismatches at the considered positions
-                  if ((seq_constraints[pos_i+i][char2int_base(cstring[i])] == 1) && (seq_constraints[pos_i+j][char2int_base(cstring[j])] == 1))
+                  if ((ctx->seq_constraints[pos_i+i][char2int_base(cstring[i])] == 1) && (ctx->seq_constraints[pos_i+j][char2int_base(cstring[j])] == 1))
                   {
                      // if the assignment of the bases is forbidden and maximal number of mismatches is reached, no further testing.
                      // (that the mismatches are valid has already been tested)
-                     if ((seq_constraints[pos_i+i][bp_i] == 0) && (num_mis >= max_mis))
+                     if ((ctx->seq_constraints[pos_i+i][bp_i] == 0) && (ctx->num_mis >= ctx->max_mis))
                         continue;
-                     if ((seq_constraints[pos_i+j][bp_j] == 0) && (num_mis >= max_mis))
+                     if ((ctx->seq_constraints[pos_i+j][bp_j] == 0) && (ctx->num_mis >= ctx->max_mis))
                         continue;
                      // if the assignment of both positions is forbidden and the maximal number of mismatches - 1 is reached, no further testing.
-                     if (((seq_constraints[pos_i+i][bp_i] == 0) && (seq_constraints[pos_i+j][bp_j] == 0)) && (num_mis >= max_mis-1))
+                     if (((ctx->seq_constraints[pos_i+i][bp_i] == 0) && (ctx->seq_constraints[pos_i+j][bp_j] == 0)) && (ctx->num_mis >= ctx->max_mis-1))
                         continue;
 
                      // if the assignment of the base is forbidden, this mismatch should be added
                      // it is clear that the constrained bases are valid for mismatches
-                     if (seq_constraints[pos_i+i][bp_i] == 0)
+                     if (ctx->seq_constraints[pos_i+i][bp_i] == 0)
                         mismatches++;
-                     if (seq_constraints[pos_i+j][bp_j] == 0)
+                     if (ctx->seq_constraints[pos_i+j][bp_j] == 0)
                         mismatches++;
                   }
                   // if in the current sequence is already one mismatch at one of the two considered positions
-                  else if ((seq_constraints[pos_i+i][char2int_base(cstring[i])] == 1) || (seq_constraints[pos_i+j][char2int_base(cstring[j])] == 1))
+                  else if ((ctx->seq_constraints[pos_i+i][char2int_base(cstring[i])] == 1) || (ctx->seq_constraints[pos_i+j][char2int_base(cstring[j])] == 1))
                   {
                      // if there are one match and one mismatch currently and after the mutation two matches: allowed but the number of mismatches reduces
-                     if ((seq_constraints[pos_i+i][bp_i] == 1) && (seq_constraints[pos_i+j][bp_j] == 1))
+                     if ((ctx->seq_constraints[pos_i+i][bp_i] == 1) && (ctx->seq_constraints[pos_i+j][bp_j] == 1))
                         mismatches--;
                      // if there are one match and one mismatch currently and after the mutation as well: the number of mismatches remains unchanged
                      // (it is already clear that the mismatches are valid)
@@ -1340,9 +1841,9 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
                      // if there are one match and one mismatch currently and after the mutation two mismatches:
                      // the number of mismatches has to be increased by one and we have to take care of the maximal number 
                      // of allowed mismatches (max_mis)
-                     else if ((seq_constraints[pos_i+i][bp_i] == 0) && (seq_constraints[pos_i+j][bp_j] == 0))
+                     else if ((ctx->seq_constraints[pos_i+i][bp_i] == 0) && (ctx->seq_constraints[pos_i+j][bp_j] == 0))
                      {
-                        if (num_mis >= max_mis)
+                        if (ctx->num_mis >= ctx->max_mis)
                            continue;
                         else
                            mismatches++;
@@ -1353,9 +1854,9 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
                   else
                   {
                      //current base is a mismatch but the new one not => one mismatch less
-                     if (seq_constraints[pos_i+i][bp_i] == 1)
+                     if (ctx->seq_constraints[pos_i+i][bp_i] == 1)
                         mismatches--;
-                     if (seq_constraints[pos_i+j][bp_j] == 1)
+                     if (ctx->seq_constraints[pos_i+j][bp_j] == 1)
                         mismatches--;
                   }
 
@@ -1428,34 +1929,92 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
 
                   /******************************************************/
 
+                  if (Filtered(ctx, screen, deferred+i*(base+npairs)+base+mut_pair_list[bp], int_seq, pos_i+i, bp_i, pos_i+j, bp_j))
+                     continue;
+
                   string[i] = int2char(bp_i);
                   string[j] = int2char(bp_j);
 
-                  cost = cost_function(string, structure, target);
+                  if (Budget_Exceeded(ctx, n_cand))
+                  {
+                     flag = 2;
+                     break;
+                  }
+                  if (par == 1)
+                  {
+                     strcpy(neighbors[n_cand].seq, string);
+                     neighbors[n_cand++].mismatches = mismatches;
+                     continue;
+                  }
+                  cost = cost_function(ctx, string, structure, target);
+                  ctx->evaluations++;
 
                   if ( cost < current_cost )
                   {
                      best_cost = cost;
                      strcpy(beststring,string);
                      //always compare to the best one found
-                     ccost2 = cost2;
-                     best_mis = num_mis + mismatches;
+                     ccost2 = ctx->cost2;
+                     best_mis = ctx->num_mis + mismatches;
                   }
-                  if (( cost == current_cost)&&(cost2<ccost2))
+                  if (( cost == current_cost)&&(ctx->cost2<ccost2))
                   {
                      strcpy(beststring,string);
-                     ccost2 = cost2;
-                     best_mis = num_mis + mismatches;
+                     ccost2 = ctx->cost2;
+                     best_mis = ctx->num_mis + mismatches;
                   }
                }
+
+            /* the neighbors of a batch (at least num_threads, the neighbors of one position completely) are
+               folded in parallel and compared in the order of the serial search, so the best neighbor is the same */
+            if ((par == 1) && ((n_cand >= ctx->num_threads) || (flag == 2) || (mut_position == n_pos-1)))
+            {
+               #pragma omp parallel for num_threads(ctx->num_threads) schedule(dynamic,1)
+               for (k=0; k<n_cand; k++)
+                  neighbors[k].cost = engine_mfe_cost(ctx, ctx->engines[omp_get_thread_num()], neighbors[k].seq,
+                                                      neighbors[k].structure, target, &neighbors[k].cost2);
+
+               for (k=0; k<n_cand; k++)
+               {
+                  ctx->evaluations++;
+                  cost = neighbors[k].cost;
+                  ctx->cost2 = neighbors[k].cost2;
+
+                  if ( cost < current_cost )
+                  {
+                     best_cost = cost;
+                     strcpy(beststring,neighbors[k].seq);
+                     ccost2 = ctx->cost2;
+                     best_mis = ctx->num_mis + neighbors[k].mismatches;
+                  }
+                  if (( cost == current_cost)&&(ctx->cost2<ccost2))
+                  {
+                     strcpy(beststring,neighbors[k].seq);
+                     ccost2 = ctx->cost2;
+                     best_mis = ctx->num_mis + neighbors[k].mismatches;
+                  }
+               }
+               // the next pass starts from the structure of the last folded neighbor (as in the serial search)
+               if (n_cand > 0)
+                  strcpy(structure, neighbors[n_cand-1].structure);
+               n_cand = 0;
+               // the batch was cut by the budget: the serial search stops at the next neighbor
+               if (flag == 2)
+                  Budget_Exceeded(ctx, 0);
+            }
+            if (ctx->time_out == 1)
+               break;
          } /*for mut_position*/
 
          if ((strcmp(cstring,beststring) != 0) && (best_cost <= current_cost))
          {
             strcpy(cstring, beststring);
             current_cost = best_cost;
+            if (ctx->fold_type==0)
+               fold_engines_accept(ctx, cstring);
             walk_len++;
-            num_mis = best_mis;
+            ctx->accepted++;
+            ctx->num_mis = best_mis;
 
             // pf-mode: cost always > 0, = probability
             // mfe-mode: cost > 0, until sructures are identical (BP-Dist)
@@ -1463,12 +2022,18 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
                cont = 1;
          }
 
-         time(&zw_time);
-         if (zw_time-start_time >= TIME_OUT_TIME)
+         // no step in this pass, but candidates were deferred by the energy filter: the next pass folds them
+         // (and only them, the sequence is unchanged)
+         if ((screen == 1) && (ctx->accepted == pass_accepted) && (ctx->filtered > pass_filtered))
          {
-            time_out = 1;
-            break;
+            screen = 2;
+            cont = 1;
          }
+         else
+            screen = (ctx->energy_filter >= 0);
+
+         if (Budget_Exceeded(ctx, 0))
+            break;
 
       } while (cont);
 
@@ -1481,19 +2046,9 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
       if (isupper(start[i]))
          start[i]=beststring[i];
 
-   free(test_table);
-   free(target_table);
-   free(mut_pos_list);
-   free(w2_list);
-   free(w1_list);
-   free(struct2);
-   free(structure);
-   free(string2);
-   free(cstring);
-   free(string);
-   free(beststring);
+   Scratch_Release(ctx, mark);
 
-   num_mis = best_mis;
+   ctx->num_mis = best_mis;
 
    return best_cost;
 }
@@ -1502,13 +2057,13 @@ double local_search(char *start, char *target, int pos_i, int pos_j, char* whole
 /*-------------------------------------------------------------------------*/
 
 /* shuffle produces a random list by doing len exchanges */
-void shuffle(int *list, int len)
+void shuffle(DesignContext* ctx, int *list, int len)
 {
    int i, rn;
 
    for (i=0;i<len;i++) {
      int temp;
-     rn = i + (int) (urn()*(len-i));   /* [i..len-1] */
+     rn = i + (int) (erand48(ctx->rng)*(len-i));   /* [i..len-1] */
      /* swap element i and rn */
      temp = list[i];
      list[i] = list[rn];
@@ -1520,96 +2075,100 @@ void shuffle(int *list, int len)
 
 void make_ptable(char *structure, int *table)
 {
-   int i,j,hx;
-   int *stack;
+   int i,j,top,len;
 
-   hx=0;
-   stack = (int *) malloc(sizeof(int)*(strlen(structure)+1));
+   /* the open brackets are kept as a stack linked through their entries
+      in table (top = last open bracket, -1 = empty), so no work space is needed */
+   top = -1;
+   len = (int)strlen(structure);
 
-   for (i=0; i<(int)strlen(structure); i++) {
+   for (i=0; i<len; i++) {
       switch (structure[i]) {
        case '.':
 	 table[i]= -1;
 	 break;
        case '(': 
-	 stack[hx++]=i;
+	 table[i]=top;
+	 top=i;
 	 break;
        case ')':
-	 j = stack[--hx];
-	 if (hx<0) {
+	 if (top<0) {
 	    fprintf(stderr, "%s\n", structure);
 	    nrerror("unbalanced brackets in make_ptable");
 	 }
+	 j = top;
+	 top = table[j];
 	 table[i]=j;
 	 table[j]=i;
 	 break;
       }
    }
 
-   if (hx!=0) {
+   if (top!=-1) {
       fprintf(stderr, "%s\n", structure);
       nrerror("unbalanced brackets in make_ptable");
    }
-   free(stack);
 }
  
 /*-------------------------------------------------------------------------*/
 
 #define WALK(i,j) \
-    strncpy(wstruct, brackets+i, j-i+1); \
+    strncpy(wstruct, ctx->brackets+i, j-i+1); \
     wstruct[j-i+1]='\0'; \
     strncpy(wstring, string+i, j-i+1); \
     wstring[j-i+1]='\0'; \
-    if (time_out == 0) dist=local_search(wstring, wstruct, i, j, string); \
+    if (ctx->time_out == 0) dist=local_search(ctx, wstring, wstruct, i, j, string); \
     strncpy(string+i, wstring, j-i+1); \
     if ((dist>0)&&(give_up)) goto adios
  
-float inverse_fold(char *start)
+float inverse_fold(DesignContext* ctx, char *start)
 {
    int i, j, jj, o;
    int *pt;
    char *string, *wstring, *wstruct, *aux;
    double dist=0;
-   int** precs; //help for identifying the predecessors and successors
-   int* int_seq;
+   size_t mark;
 
-   time(&start_time);
+   Start_Budget(ctx);
 
    //nc2 = 0;
-   j = o = fold_type = 0;
+   j = o = ctx->fold_type = 0;
 
-   if ((int)strlen(start)!=struct_len) {
-      fprintf(stderr, "%s\n%s\n", start, brackets);
+   if ((int)strlen(start)!=ctx->struct_len) {
+      fprintf(stderr, "%s\n%s\n", start, ctx->brackets);
       nrerror("inverse_fold: start and structure have unequal length");
    }
 
-   string = (char *) malloc(sizeof(char)*(struct_len+1));
-   wstring = (char *) malloc(sizeof(char)*(struct_len+1));
-   wstruct = (char *) malloc(sizeof(char)*(struct_len+1));
-   pt = (int *) malloc(sizeof(int)*(struct_len+1));
-   pt[struct_len] = struct_len+1;
+   GetPrecSucc(ctx);
+   alloc_Scratch(ctx);
+   alloc_Ediff(ctx);
+   init_Ediff(ctx);
+
+   mark = ctx->scratch_used;
+   string = (char *) Scratch_Alloc(ctx, sizeof(char)*(ctx->struct_len+1));
+   wstring = (char *) Scratch_Alloc(ctx, sizeof(char)*(ctx->struct_len+1));
+   wstruct = (char *) Scratch_Alloc(ctx, sizeof(char)*(ctx->struct_len+1));
+   pt = (int *) Scratch_Alloc(ctx, sizeof(int)*(ctx->struct_len+1));
+   pt[ctx->struct_len] = ctx->struct_len+1;
+   aux = (char *) Scratch_Alloc(ctx, sizeof(char)*(ctx->struct_len+1));
 
-   aux = aux_struct(brackets);
+   aux_struct(ctx->brackets, aux, (short *) Scratch_Alloc(ctx, sizeof(short)*(ctx->struct_len/2+1)));
    strcpy(string, start);
-   make_ptable(brackets, pt);
+   make_ptable(ctx->brackets, pt);
 
-   precs = GetPrecursors();
-   GetSuccessors(precs);
-   alloc_Ediff();
-   init_Ediff();
-   int_seq = char2int(start);
+   alloc_Engines(ctx, ctx->fold_engine);
 
-   while (j<struct_len) {
-      while ((j<struct_len)&&(brackets[j]!=')')) {
+   while (j<ctx->struct_len) {
+      while ((j<ctx->struct_len)&&(ctx->brackets[j]!=')')) {
 	 if (aux[j]=='[') o++;
 	 if (aux[j]==']') o--;
 	 j++;
       }
       i=j;
-      while (brackets[--i]!='(');  /* doesn't work for open structure */
+      while (ctx->brackets[--i]!='(');  /* doesn't work for open structure */
       if (aux[i]!='[') { i--; j++;}
       while (pt[j]==i) {
-	 backtrack_type='C';
+	 ctx->backtrack_type='C';
 	 if (aux[i]!='[') {
 	    while (aux[--i]!='[');
 	    while (aux[++j]!=']');
@@ -1621,7 +2180,7 @@ float inverse_fold(char *start)
 	 while (aux[++j]=='.');
 	 while ((i>=0)&&(aux[i]=='.')) i--;
 	 if (pt[j]!=i) {
-	    backtrack_type = (o==0)? 'F' : 'M';
+	    ctx->backtrack_type = (o==0)? 'F' : 'M';
 	    if (j-jj>8) { WALK((i+1),(jj)); }
 	    WALK((i+1), (j-1));
 	    while ((i>=0) &&(aux[i]==']')) {
@@ -1633,27 +2192,23 @@ float inverse_fold(char *start)
       }
    }
  adios:
-   backtrack_type='F';
+   ctx->backtrack_type='F';
    //if ((dist>0)&&(inv_verbose)) printf("%s\n%s\n", wstring, wstruct);
    /*if ((dist==0)||(give_up==0))*/ 
    strcpy(start, string);
-   free(wstring); free(wstruct);
-   free(string); free(aux);
-   free(pt);
+   Scratch_Release(ctx, mark);
 /*   if (dist>0) printf("%3d \n", nc2); */
-   time(&zw_time);
    return dist;
 }
 
 /*-------------------------------------------------------------------------*/
 
-float inverse_pf_fold(char *start)
+float inverse_pf_fold(DesignContext* ctx, char *start)
 {
    double dist;
    int dang;
-   int** precs; //help for identifying the predecessors and successors
 
-   time(&start_time);
+   Start_Budget(ctx);
 
    dang=dangles;
    //in the Vienna package dangles is set to 2, but then the energies (evaluated with -d1)
@@ -1663,15 +2218,17 @@ float inverse_pf_fold(char *start)
    if (dangles!=0) dangles=1;
    update_fold_params();    /* make sure there is a valid pair matrix */
 
-   precs = GetPrecursors();
-   GetSuccessors(precs);
-   alloc_Ediff();
-   init_Ediff();
+   GetPrecSucc(ctx);
+   alloc_Scratch(ctx);
+   alloc_Ediff(ctx);
+   init_Ediff(ctx);
 
-   fold_type=1;
+   ctx->fold_type=1;
    do_backtrack = 0;
+   // the backend of the mfe search, if it has a partition function
+   alloc_Engines(ctx, (fold_backend(ctx->fold_engine)->pf_fold != NULL)? ctx->fold_engine : FOLD_VIENNA);
 
-   dist = local_search(start, brackets, 0, struct_len, start);
+   dist = local_search(ctx, start, ctx->brackets, 0, ctx->struct_len, start);
 
    dangles=dang;
    return (dist+final_cost);
@@ -1679,18 +2236,26 @@ float inverse_pf_fold(char *start)
 
 /*---------------------------------------------------------------------------*/
 
-double mfe_cost(char *string, char *structure, char *target)
+double mfe_cost(DesignContext* ctx, char *string, char *structure, char *target)
 {
-   double energy, distance;
-
    if (strlen(string)!=strlen(target)) {
       fprintf(stderr, "%s\n%s\n", string, target);
       nrerror("unequal length in mfe_cost");
    }
-   energy = fold(string, structure);
-   distance = (double) bp_distance(target, structure);
+   return engine_mfe_cost(ctx, ctx->engines[0], string, structure, target, &ctx->cost2);
+}
+/*****************************************************************
+ mfe_cost with the engine fe (cost2 is written to *c2), the
+ candidate is a mutation of the current sequence of fe
+*****************************************************************/
+
+double engine_mfe_cost(DesignContext* ctx, FoldEngine* fe, char *string, char *structure, char *target, double *c2)
+{
+   double energy, distance;
 
-   cost2 = energy_of_struct(string, target) - energy;
+   energy = fold_engine_eval(fe, string, structure, ctx->backtrack_type);
+   distance = (double) fold_engine_distance(fe, target, structure);
+   *c2 = fold_engine_energy(fe, string, target) - energy;
    return (double) distance;
 }
 /*---------------------------------------------------------------------------*/
@@ -1698,12 +2263,12 @@ double mfe_cost(char *string, char *structure, char *target)
 *      return value is no probability but an energy difference   *
 *****************************************************************/
 
-double pf_cost(char *string, char *structure, char *target)
+double pf_cost(DesignContext* ctx, char *string, char *structure, char *target)
 {
    double  f, e;
 
-   f = pf_fold(string, structure);
-   e = energy_of_struct(string, target);
+   f = fold_engine_pf(ctx->engines[0], string, structure);
+   e = fold_engine_energy(ctx->engines[0], string, target);
    return (double) (e-f-final_cost);
 }
 
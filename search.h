@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <limits.h>
+#include <omp.h>
 #include "basics.h"
 #include "constraints.h"
 #include "struct.h"
@@ -11,45 +12,62 @@
 using namespace std;
 
 
-float inverse_fold(char *start);
+float inverse_fold(DesignContext* ctx, char *start);
 /* find sequences with predifined structure.
    the found sequence is written to start,
    return value is
       energy_of_struct(start, target) - fold(start, structure),
    i.e. 0. if search was successful; */
 
-float inverse_pf_fold(char *start);
+float inverse_pf_fold(DesignContext* ctx, char *start);
 /*  inverse folding maximising the frequency of target in the
     ensemble of structures, final sequence is written to start, returns
        energy_of_struct(start, target) - part_func(start, structure)
 */
 
 
-void Pos2BP_Pos();
-int** GetPrecursors();
-void GetSuccessors(int** precs);
-void alloc_Ediff();
-void init_Ediff();
-void print_Ediff();
-void print_av_Ediff();
-void make_av_Ediff();
-void print_max_Ediff();
-void make_max_Ediff();
-
-int compare_Pos(const void *a, const void *b);
-int* make_mut_pos_list();
-
-double getPartEnergy(int bp_pos, int bp_pos_before, int* int_seq);
-double get_BP_Energy(int pos_i, int* int_seq);
-double get_BasePart_Energy(int pos_i, int* int_seq);
-
-void EnergyDiff(int pos_i, char* sequence);
-
-double local_search(char *start, char *target, int pos_i, int pos_j, char* whole_seq);
-void   shuffle(int *list, int len);
+void Pos2BP_Pos(DesignContext* ctx);
+int** GetPrecursors(DesignContext* ctx);
+void GetSuccessors(DesignContext* ctx, int** precs);
+void GetPrecSucc(DesignContext* ctx);
+void alloc_Ediff(DesignContext* ctx);
+void alloc_Scratch(DesignContext* ctx);
+void make_Loops(DesignContext* ctx);
+void init_Ediff(DesignContext* ctx);
+void invalidate_Ediff(DesignContext* ctx, int pos);
+void update_Ediff(DesignContext* ctx, char* seq);
+void make_Ediff_Pos(DesignContext* ctx, int pos, int* int_seq);
+int rank_Before(const PosEnergy* a, const PosEnergy* b);
+void sort_Ranking(PosEnergy* pe, int n);
+int rank_Positions(DesignContext* ctx, int* cand, int n_cand, int offset, int* list, int* int_seq);
+void print_Ediff(DesignContext* ctx);
+void print_av_Ediff(DesignContext* ctx);
+void make_av_Ediff(DesignContext* ctx);
+void make_av_Ediff_Pos(DesignContext* ctx, int i);
+void print_max_Ediff(DesignContext* ctx);
+void make_max_Ediff(DesignContext* ctx);
+
+int getPartEnergy(DesignContext* ctx, int bp_pos, int bp_pos_before, int* int_seq);
+int get_BP_Energy(DesignContext* ctx, int pos_i, int* int_seq);
+int get_BasePart_Energy(DesignContext* ctx, int pos_i, int* int_seq);
+
+void EnergyDiff(DesignContext* ctx, int pos_i, int* int_seq);
+double MutationEnergyDelta(DesignContext* ctx, int* int_seq, int i, int b_i, int j, int b_j);
+int Filtered(DesignContext* ctx, int screen, char* deferred, int* int_seq, int i, int b_i, int j, int b_j);
+
+double local_search(DesignContext* ctx, char *start, char *target, int pos_i, int pos_j, char* whole_seq);
+double Monotonic_Time();
+void   Start_Budget(DesignContext* ctx);
+int    Budget_Exceeded(DesignContext* ctx, int pending);
+void   shuffle(DesignContext* ctx, int *list, int len);
 void   make_ptable(char *structure, int *table);
-double  mfe_cost(char *, char*, char *);
-double  pf_cost(char *, char *, char *);
+double  mfe_cost(DesignContext* ctx, char *, char*, char *);
+double  engine_mfe_cost(DesignContext* ctx, FoldEngine* fe, char *, char *, char *, double *);
+void   alloc_Engines(DesignContext* ctx, int backend);
+void   free_Engines(DesignContext* ctx);
+void   fold_engines_init(DesignContext* ctx, char* seq);
+void   fold_engines_accept(DesignContext* ctx, char* seq);
+double  pf_cost(DesignContext* ctx, char *, char *, char *);
 
 
 
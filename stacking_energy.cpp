@@ -1,9 +1,9 @@
 
 #include "stacking_energy.h"
 
-double StackingEnergy(int bp_i, int bp_j, int bp_before)
+int StackingEnergy(int bp_i, int bp_j, int bp_before)
 {
-   double energy = 0.0;
+   int energy = 0;
    int base_i_before, base_j_before;
 
    BP2_2(bp_before,base_i_before,base_j_before);
@@ -7,6 +7,6 @@
 
 using namespace std;
 
-double StackingEnergy(int bp_i, int bp_j, int bp_before);
+int StackingEnergy(int bp_i, int bp_j, int bp_before);
 
 #endif   // _STACKING_ENERGY_
@@ -115,12 +115,22 @@ copied from: Vienna Package
 char *aux_struct(const char* structure )
 {  
    short        *match_paren;
-   int          i, o, p;
    char         *string;
    
    string = (char *) malloc(sizeof(char)*(strlen(structure)+1));
    match_paren = (short *) malloc(sizeof(short)*(strlen(structure)/2+1));
+   aux_struct(structure, string, match_paren);
+   free(match_paren);
+   return(string);
+}
+
+/* the same into string, match_paren (strlen(structure)/2+1 shorts) is the work space */
+void aux_struct(const char* structure, char* string, short* match_paren)
+{
+   int          i, o, p;
+
    strcpy(string, structure);
+   match_paren[0] = 0;   // as Vienna's space() leaves it
 
    i = o = 0;
    while (string[i])
@@ -148,8 +158,6 @@ char *aux_struct(const char* structure )
       }
       i++;
    }
-   free(match_paren);
-   return(string);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -326,45 +334,5 @@ char* Element_Structure(char* right_structure)
 /*---------------------------------------------------------------------------*/
 
 
-/**********************************************************
-if there are more than one structure fragments connected by
-some free bases without a closing BP (= external loop)
-
-This external loop may contain dangling ends and its energy
-values are stored in the last row of D and Trace. Thus
-an equivalent position in BP_Order is needed and there,
-the number of free bases and stems is stored.
-***********************************************************/
-
-int* ClosingStructure(int* bpTable)
-{
-   int* stems_and_freeBases;
-   stems_and_freeBases = (int*) malloc(sizeof(int)*2);
-   int stems = 0;
-   int freeB = 0;
-   int i = 0;
-
-   while (i < (int)strlen(brackets))
-   {
-      if (brackets[i] == '.')
-      {
-         freeB++;
-         i++;
-      }
-      else if (brackets[i] == '(')
-      {
-         stems++;
-         i = bpTable[i] + 1;
-      }
-   }
-   stems_and_freeBases[0] = freeB;
-   stems_and_freeBases[1] = stems;
-   return stems_and_freeBases;
-}
-
-
-/*---------------------------------------------------------------------------*/
-
-
 
 
@@ -11,9 +11,9 @@ int check_brackets(char *line);
 int* make_BasePair_Table(char *structure);
 int NumOfBP(char* structure);
 char *aux_struct(const char* structure );
+void aux_struct(const char* structure, char* string, short* match_paren);
 char *right_Element_Structure(const char *structure );
 char* Element_Structure(char* right_structure);
-int* ClosingStructure(int* bpTable);
 
 
 #endif   // _STRUCT_